@@ -0,0 +1,80 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <vector>
+
+#include "benchmark.h"
+
+void run_audio_shm_benchmarks(BenchmarkRunner& runner) {
+    constexpr uint32_t num_samples = benchmark_num_samples;
+
+    for (const uint32_t num_channels : {1, 2, 8, 32, 128}) {
+        AudioShmBuffer buffers(make_audio_shm_config(
+            "audio-shm-" + std::to_string(num_channels), num_channels,
+            num_samples, sizeof(float)));
+
+        // The host's buffers, filled with something that's not silent
+        std::vector<std::vector<float>> host_buffers(
+            num_channels, std::vector<float>(num_samples));
+        for (auto& channel : host_buffers) {
+            for (uint32_t sample = 0; sample < num_samples; sample++) {
+                channel[sample] = static_cast<float>(sample % 64) / 64.0f;
+            }
+        }
+
+        const std::string suffix = "/" + std::to_string(num_channels) + "ch";
+        const size_t num_bytes = num_channels * num_samples * sizeof(float);
+
+        // This is what the native plugin does before sending a process request
+        runner.run(
+            "audio-shm/write-inputs" + suffix,
+            [&]() {
+                for (uint32_t channel = 0; channel < num_channels; channel++) {
+                    buffers.write_input_channel(
+                        0, channel, host_buffers[channel].data(), num_samples);
+                }
+                do_not_optimize(buffers.input_channel_ptr<float>(0, 0)[0]);
+            },
+            num_bytes);
+
+        // And this is what happens after receiving the response
+        runner.run(
+            "audio-shm/read-outputs" + suffix,
+            [&]() {
+                for (uint32_t channel = 0; channel < num_channels; channel++) {
+                    std::copy_n(buffers.output_channel_ptr<float>(0, channel),
+                                num_samples, host_buffers[channel].data());
+                }
+                do_not_optimize(host_buffers[0][0]);
+            },
+            num_bytes);
+
+        // Silent outputs need to be scanned entirely, so this is the worst case
+        for (uint32_t channel = 0; channel < num_channels; channel++) {
+            std::fill_n(buffers.output_channel_ptr<float>(0, channel),
+                        num_samples, 0.0f);
+        }
+        runner.run(
+            "audio-shm/update-silent-outputs" + suffix,
+            [&]() {
+                buffers.update_silent_outputs<float>(0, num_channels,
+                                                     num_samples);
+                do_not_optimize(buffers.output_channel_silent(0, 0));
+            },
+            num_bytes);
+    }
+}
@@ -0,0 +1,86 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "benchmark.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+#include <unistd.h>
+
+BenchmarkRunner::BenchmarkRunner(std::optional<std::string> filter)
+    : filter_(std::move(filter)) {}
+
+bool BenchmarkRunner::should_run(const std::string& name) const noexcept {
+    return !filter_ || name.find(*filter_) != std::string::npos;
+}
+
+AudioShmBuffer::Config make_audio_shm_config(const std::string& name,
+                                             uint32_t num_channels,
+                                             uint32_t num_samples,
+                                             uint32_t sample_size) {
+    uint32_t current_offset = 0;
+
+    std::vector<uint32_t> input_channel_offsets(num_channels);
+    for (auto& offset : input_channel_offsets) {
+        offset = current_offset;
+        current_offset += num_samples * sample_size;
+    }
+
+    std::vector<uint32_t> output_channel_offsets(num_channels);
+    for (auto& offset : output_channel_offsets) {
+        offset = current_offset;
+        current_offset += num_samples * sample_size;
+    }
+
+    return AudioShmBuffer::Config{
+        .name = "yabridge-benchmarks-" + name + "-" + std::to_string(getpid()),
+        .size = current_offset,
+        .input_offsets = {std::move(input_channel_offsets)},
+        .output_offsets = {std::move(output_channel_offsets)}};
+}
+
+void BenchmarkRunner::report(
+    const std::string& name,
+    size_t batch_size,
+    std::vector<std::chrono::steady_clock::duration>& batch_durations,
+    size_t bytes_per_iteration) {
+    std::sort(batch_durations.begin(), batch_durations.end());
+    const auto per_iteration = [&](std::chrono::steady_clock::duration
+                                       duration) {
+        return static_cast<double>(
+                   std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       duration)
+                       .count()) /
+               static_cast<double>(batch_size);
+    };
+
+    const double median_ns =
+        per_iteration(batch_durations[batch_durations.size() / 2]);
+    const double fastest_ns = per_iteration(batch_durations.front());
+
+    std::cout << std::left << std::setw(56) << name << std::right
+              << std::fixed << std::setprecision(1) << std::setw(12)
+              << median_ns << " ns/op (fastest " << fastest_ns << " ns/op)";
+    if (bytes_per_iteration > 0) {
+        // Bytes per nanosecond is the same as gigabytes per second
+        std::cout << ", " << std::setprecision(2)
+                  << (static_cast<double>(bytes_per_iteration) / median_ns)
+                  << " GB/s";
+    }
+    std::cout << std::endl;
+}
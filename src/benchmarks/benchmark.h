@@ -0,0 +1,166 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <chrono>
+#include <concepts>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "../common/audio-shm.h"
+#include "../common/communication/common.h"
+
+/**
+ * Prevent the compiler from optimizing away a computation whose result is
+ * otherwise unused.
+ */
+template <typename T>
+inline void do_not_optimize(const T& value) noexcept {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * The number of samples per audio buffer used throughout the benchmarks. This
+ * is a common buffer size for live use, where the bridging overhead matters
+ * the most.
+ */
+constexpr uint32_t benchmark_num_samples = 512;
+
+/**
+ * A minimal benchmark harness for timing yabridge's serialization and
+ * communication primitives. Every benchmark is run in batches that each take
+ * at least `min_batch_duration`, and we'll report the median and the fastest
+ * time per iteration across those batches. We don't pull in a benchmarking
+ * library for this since we only need the basics, and this way the benchmarks
+ * can be built with the same dependencies as the rest of yabridge.
+ */
+class BenchmarkRunner {
+   public:
+    /**
+     * @param filter If set, only run benchmarks whose names contain this
+     *   string.
+     */
+    BenchmarkRunner(std::optional<std::string> filter);
+
+    /**
+     * Whether a benchmark with this name should be run. This can be used to
+     * skip expensive setup for benchmarks that have been filtered out.
+     */
+    bool should_run(const std::string& name) const noexcept;
+
+    /**
+     * Time `iteration` and print the results. The function will be called
+     * repeatedly, so it should perform a single unit of work.
+     *
+     * @param name The name printed alongside the results. These are in the
+     *   form of `<group>/<operation>/<parameters>` so they can be filtered.
+     * @param iteration The function to benchmark.
+     * @param bytes_per_iteration If nonzero, also print the throughput based
+     *   on this number of bytes processed per iteration.
+     */
+    template <std::invocable F>
+    void run(const std::string& name,
+             F&& iteration,
+             size_t bytes_per_iteration = 0) {
+        if (!should_run(name)) {
+            return;
+        }
+
+        // We'll double the batch size until a single batch takes long enough
+        // to get a stable measurement. This also serves as a warmup.
+        size_t batch_size = 1;
+        while (time_batch(iteration, batch_size) < min_batch_duration) {
+            batch_size *= 2;
+        }
+
+        std::vector<std::chrono::steady_clock::duration> batch_durations(
+            num_batches);
+        for (auto& duration : batch_durations) {
+            duration = time_batch(iteration, batch_size);
+        }
+
+        report(name, batch_size, batch_durations, bytes_per_iteration);
+    }
+
+   private:
+    static constexpr std::chrono::milliseconds min_batch_duration{20};
+    static constexpr size_t num_batches = 15;
+
+    template <std::invocable F>
+    static std::chrono::steady_clock::duration time_batch(F& iteration,
+                                                          size_t batch_size) {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < batch_size; i++) {
+            iteration();
+        }
+
+        return std::chrono::steady_clock::now() - start;
+    }
+
+    /**
+     * Print the median and fastest time per iteration for a benchmark.
+     */
+    void report(
+        const std::string& name,
+        size_t batch_size,
+        std::vector<std::chrono::steady_clock::duration>& batch_durations,
+        size_t bytes_per_iteration);
+
+    std::optional<std::string> filter_;
+};
+
+/**
+ * Serialize `object` and then deserialize it into `target`, like what happens
+ * when an object gets sent from the native plugin to the Wine plugin host. The
+ * target object is reused between calls, just like the persistent objects
+ * yabridge deserializes into on the audio thread.
+ */
+template <typename T>
+inline void serialization_round_trip(const T& object,
+                                     SerializationBufferBase& buffer,
+                                     T& target) {
+    const size_t size =
+        bitsery::quickSerialization<OutputAdapter<SerializationBufferBase>>(
+            buffer, object);
+    bitsery::quickDeserialization<InputAdapter<SerializationBufferBase>>(
+        {buffer.begin(), size}, target);
+}
+
+/**
+ * Create the configuration for a shared memory audio buffer with a single bus
+ * containing `num_channels` input and output channels, laid out the same way
+ * the Wine plugin host would lay them out. The object's name includes the
+ * process ID so concurrent benchmark runs don't interfere with each other.
+ */
+AudioShmBuffer::Config make_audio_shm_config(const std::string& name,
+                                             uint32_t num_channels,
+                                             uint32_t num_samples,
+                                             uint32_t sample_size);
+
+// These are defined in their own translation units, and they're called from
+// `main()`
+
+void run_audio_shm_benchmarks(BenchmarkRunner& runner);
+void run_communication_benchmarks(BenchmarkRunner& runner);
+void run_loopback_benchmarks(BenchmarkRunner& runner);
+#ifdef WITH_CLAP
+void run_clap_benchmarks(BenchmarkRunner& runner);
+#endif
+#ifdef WITH_VST3
+void run_vst3_benchmarks(BenchmarkRunner& runner);
+#endif
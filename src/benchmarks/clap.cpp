@@ -0,0 +1,88 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "../common/serialization/clap/events.h"
+#include "benchmark.h"
+
+namespace {
+
+/**
+ * Fill an event list with `num_events` events, alternating between note on
+ * events and parameter value changes.
+ */
+void populate_events(clap::events::EventList& events, uint32_t num_events) {
+    events.clear();
+
+    const clap_output_events_t* out = events.output_events();
+    for (uint32_t i = 0; i < num_events; i++) {
+        if (i % 2 == 0) {
+            const clap_event_note_t event{
+                .header = {.size = sizeof(clap_event_note_t),
+                           .time = i % benchmark_num_samples,
+                           .space_id = CLAP_CORE_EVENT_SPACE_ID,
+                           .type = CLAP_EVENT_NOTE_ON,
+                           .flags = 0},
+                .note_id = -1,
+                .port_index = 0,
+                .channel = 0,
+                .key = static_cast<int16_t>(36 + (i / 2) % 48),
+                .velocity = 0.8};
+            out->try_push(out, &event.header);
+        } else {
+            const clap_event_param_value_t event{
+                .header = {.size = sizeof(clap_event_param_value_t),
+                           .time = i % benchmark_num_samples,
+                           .space_id = CLAP_CORE_EVENT_SPACE_ID,
+                           .type = CLAP_EVENT_PARAM_VALUE,
+                           .flags = 0},
+                .param_id = i % 128,
+                .cookie = nullptr,
+                .note_id = -1,
+                .port_index = -1,
+                .channel = -1,
+                .key = -1,
+                .value = static_cast<double>(i) / num_events};
+            out->try_push(out, &event.header);
+        }
+    }
+}
+
+}  // namespace
+
+void run_clap_benchmarks(BenchmarkRunner& runner) {
+    SerializationBuffer<256> buffer{};
+
+    for (const uint32_t num_events : {1, 64, 512}) {
+        // The host's events. `EventList` also implements the input events
+        // interface, so we can use it as a stand-in for the host's list.
+        clap::events::EventList host_events{};
+        populate_events(host_events, num_events);
+
+        const std::string suffix = "/" + std::to_string(num_events);
+
+        clap::events::EventList events{};
+        runner.run("clap/event-list/repopulate" + suffix, [&]() {
+            events.repopulate(*host_events.input_events());
+            do_not_optimize(events);
+        });
+
+        clap::events::EventList target{};
+        runner.run("clap/event-list/round-trip" + suffix, [&]() {
+            serialization_round_trip(events, buffer, target);
+            do_not_optimize(target);
+        });
+    }
+}
@@ -0,0 +1,94 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <thread>
+
+#include <asio/local/connect_pair.hpp>
+
+#include "../common/communication/common.h"
+#include "../common/serialization/vst2.h"
+#include "benchmark.h"
+
+namespace {
+
+/**
+ * Benchmark the round trip of sending an object over a socket and receiving it
+ * back from another thread, similar to how a processing request and its
+ * response are exchanged between the native plugin and the Wine plugin host.
+ * If `shm` is set, then the objects are passed through the shared memory
+ * object's control block like yabridge does on the audio thread.
+ */
+template <typename T>
+void run_round_trip_benchmark(BenchmarkRunner& runner,
+                              const std::string& name,
+                              const T& object,
+                              AudioShmBuffer* shm) {
+    asio::io_context io_context{};
+    asio::local::stream_protocol::socket native_socket(io_context);
+    asio::local::stream_protocol::socket wine_socket(io_context);
+    asio::local::connect_pair(native_socket, wine_socket);
+
+    // This plays the role of the Wine plugin host, echoing every object back
+    // until the socket gets closed
+    std::jthread echo_handler([&]() {
+        SerializationBuffer<256> buffer{};
+        T echoed_object{};
+        while (true) {
+            try {
+                read_object_via_shm(wine_socket, echoed_object, buffer, shm);
+                write_object_via_shm(wine_socket, echoed_object, buffer, shm);
+            } catch (const std::system_error&) {
+                break;
+            }
+        }
+    });
+
+    SerializationBuffer<256> buffer{};
+    T response{};
+    runner.run(name, [&]() {
+        write_object_via_shm(native_socket, object, buffer, shm);
+        read_object_via_shm(native_socket, response, buffer, shm);
+    });
+
+    native_socket.shutdown(asio::local::stream_protocol::socket::shutdown_both);
+    native_socket.close();
+}
+
+}  // namespace
+
+void run_communication_benchmarks(BenchmarkRunner& runner) {
+    AudioShmBuffer shm(make_audio_shm_config(
+        "communication", 2, benchmark_num_samples, sizeof(float)));
+
+    run_round_trip_benchmark(runner, "communication/round-trip/ack", Ack{},
+                             nullptr);
+
+    // A typical VST2 processing request with transport information, like the
+    // ones sent every processing cycle
+    Vst2ProcessRequest process_request{};
+    process_request.sample_frames = benchmark_num_samples;
+    process_request.current_time_info.emplace();
+    process_request.current_time_info->sampleRate = 48000.0;
+    process_request.current_time_info->tempo = 120.0;
+    process_request.current_process_level = 2;
+
+    run_round_trip_benchmark(runner,
+                             "communication/round-trip/vst2-process-request",
+                             process_request, nullptr);
+    run_round_trip_benchmark(
+        runner, "communication/round-trip/vst2-process-request/shm",
+        process_request, &shm);
+}
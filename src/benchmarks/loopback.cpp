@@ -0,0 +1,353 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <thread>
+
+#include "../common/communication/common.h"
+#include "../common/serialization/vst2.h"
+#include "benchmark.h"
+
+// This simulates a host driving the audio processing path of one or more
+// plugin instances, with both the native plugin and the Wine plugin host
+// running as threads in this process. The 'plugin' simply copies its inputs to
+// its outputs, so the results only contain yabridge's own overhead. This uses
+// the same sockets, shared memory objects, and messages as the actual bridges,
+// but without any Wine or actual plugins involved.
+
+namespace {
+
+/**
+ * The different ways audio processing requests can be exchanged between the
+ * native plugin and the Wine plugin host.
+ */
+enum class LoopbackMode {
+    /**
+     * A `SocketHandler` with the shared memory object's control block attached,
+     * like VST2 plugins use by default.
+     */
+    vst2_socket,
+    /**
+     * Requests and responses written to the control block, with both sides
+     * waking each other up using futexes. This is what VST2 plugins use when
+     * the `futex_audio_signalling` option is enabled.
+     */
+    vst2_futex,
+    /**
+     * A `TypedMessageHandler` with persistent buffers and the control block
+     * attached, like VST3 and CLAP plugins use for their audio threads.
+     */
+    typed_message_handler,
+};
+
+/**
+ * A stand-in for the loggers `TypedMessageHandler` expects. We never pass a
+ * logger to the message handlers here, but the template still needs to be
+ * instantiated with something that has these functions.
+ */
+struct LoopbackLogger {
+    template <typename T>
+    bool log_request(bool /*is_host_plugin*/, const T& /*object*/) {
+        return false;
+    }
+
+    template <typename T>
+    void log_response(bool /*is_host_plugin*/, const T& /*object*/) {}
+
+    Logger& logger_;
+};
+
+using LoopbackRequest = std::variant<Vst2ProcessRequest>;
+
+/**
+ * The sockets for a single simulated plugin instance. Only the sockets for the
+ * instance's mode are actually used. One instance of this is created for each
+ * side of the connection.
+ */
+class LoopbackSockets final : public Sockets {
+   public:
+    LoopbackSockets(asio::io_context& io_context,
+                    const ghc::filesystem::path& endpoint_base_dir,
+                    bool listen)
+        : Sockets(endpoint_base_dir),
+          host_plugin_process_replacing_(
+              io_context,
+              (base_dir_ / "host_plugin_process_replacing.sock").string(),
+              listen),
+          host_plugin_audio_thread_(
+              io_context,
+              (base_dir_ / "host_plugin_audio_thread.sock").string(),
+              listen) {}
+
+    ~LoopbackSockets() noexcept override { close(); }
+
+    void connect() override {
+        host_plugin_process_replacing_.connect();
+        host_plugin_audio_thread_.connect();
+    }
+
+    void close() override {
+        host_plugin_process_replacing_.close();
+        host_plugin_audio_thread_.close();
+    }
+
+    SocketHandler host_plugin_process_replacing_;
+    TypedMessageHandler<std::jthread, LoopbackLogger, LoopbackRequest>
+        host_plugin_audio_thread_;
+};
+
+/**
+ * A single simulated plugin instance. The constructor sets up both sides of
+ * the connection and starts the Wine plugin host's audio thread, and
+ * `process()` does a single processing cycle on the native plugin's side.
+ */
+class LoopbackInstance {
+   public:
+    LoopbackInstance(LoopbackMode mode,
+                     size_t instance_id,
+                     uint32_t num_channels,
+                     uint32_t num_samples)
+        : mode_(mode),
+          num_channels_(num_channels),
+          num_samples_(num_samples),
+          endpoint_base_dir_(generate_endpoint_base("loopback")),
+          buffers_(make_audio_shm_config(
+              "loopback-" + std::to_string(instance_id),
+              num_channels,
+              num_samples,
+              sizeof(float))),
+          native_sockets_(io_context_, endpoint_base_dir_, true),
+          wine_sockets_(io_context_, endpoint_base_dir_, false) {
+        // The listening side's acceptors have already been set up, so the
+        // connecting side won't block here
+        wine_sockets_.connect();
+        native_sockets_.connect();
+
+        request_.sample_frames = static_cast<int>(num_samples);
+        request_.double_precision = false;
+        request_.current_process_level = 2;
+
+        switch (mode_) {
+            case LoopbackMode::vst2_socket:
+                native_sockets_.host_plugin_process_replacing_.set_shm_buffer(
+                    &buffers_);
+                wine_sockets_.host_plugin_process_replacing_.set_shm_buffer(
+                    &buffers_);
+
+                audio_thread_ = std::jthread([&]() {
+                    pthread_setname_np(pthread_self(), "loopback");
+
+                    wine_sockets_.host_plugin_process_replacing_
+                        .receive_multi<Vst2ProcessRequest>(
+                            [&](Vst2ProcessRequest& request,
+                                SerializationBufferBase& buffer) {
+                                wine_sockets_.host_plugin_process_replacing_
+                                    .send(process_audio(request), buffer);
+                            });
+                });
+                break;
+            case LoopbackMode::vst2_futex: {
+                // See `Vst2Bridge::setup_shared_audio_buffers()` for why this
+                // has to be read before spawning the thread
+                const uint32_t last_request_id = buffers_.last_request_id();
+                buffers_.start_listening();
+                audio_thread_ = std::jthread([&, last_request_id]() {
+                    pthread_setname_np(pthread_self(), "loopback");
+
+                    SerializationBuffer<256> buffer{};
+                    Vst2ProcessRequest request{};
+                    uint32_t request_id = last_request_id;
+                    while (buffers_.wait_for_request(request_id)) {
+                        read_shm_object(buffers_, request);
+                        write_shm_object(buffers_, process_audio(request),
+                                         buffer);
+                        buffers_.signal_response(request_id);
+                    }
+                });
+            } break;
+            case LoopbackMode::typed_message_handler:
+                native_sockets_.host_plugin_audio_thread_.set_shm_buffer(
+                    &buffers_);
+                wine_sockets_.host_plugin_audio_thread_.set_shm_buffer(
+                    &buffers_);
+
+                audio_thread_ = std::jthread([&]() {
+                    pthread_setname_np(pthread_self(), "loopback");
+
+                    wine_sockets_.host_plugin_audio_thread_
+                        .receive_messages<true>(
+                            std::nullopt,
+                            [&](Vst2ProcessRequest& request)
+                                -> Vst2ProcessRequest::Response {
+                                return process_audio(request);
+                            });
+                });
+                break;
+        }
+    }
+
+    ~LoopbackInstance() noexcept {
+        if (mode_ == LoopbackMode::vst2_futex) {
+            buffers_.stop_listening();
+        }
+
+        // Closing the native side's sockets causes the Wine side's audio
+        // thread to exit
+        native_sockets_.close();
+        audio_thread_.join();
+        wine_sockets_.close();
+
+        native_sockets_.host_plugin_process_replacing_.set_shm_buffer(nullptr);
+        wine_sockets_.host_plugin_process_replacing_.set_shm_buffer(nullptr);
+        native_sockets_.host_plugin_audio_thread_.set_shm_buffer(nullptr);
+        wine_sockets_.host_plugin_audio_thread_.set_shm_buffer(nullptr);
+    }
+
+    LoopbackInstance(const LoopbackInstance&) = delete;
+    LoopbackInstance& operator=(const LoopbackInstance&) = delete;
+
+    /**
+     * Do a single processing cycle, like `Vst2PluginBridge::do_process()`
+     * does. The inputs are copied to the shared memory object, the request is
+     * sent to the Wine side, and the outputs are then copied back.
+     */
+    void process(const std::vector<std::vector<float>>& inputs,
+                 std::vector<std::vector<float>>& outputs) {
+        for (uint32_t channel = 0; channel < num_channels_; channel++) {
+            buffers_.write_input_channel(0, channel, inputs[channel].data(),
+                                         num_samples_);
+        }
+
+        switch (mode_) {
+            case LoopbackMode::vst2_socket:
+                native_sockets_.host_plugin_process_replacing_.send(request_,
+                                                                    buffer_);
+                native_sockets_.host_plugin_process_replacing_.receive_single(
+                    response_, buffer_);
+                break;
+            case LoopbackMode::vst2_futex: {
+                write_shm_object(buffers_, request_, buffer_);
+                const uint32_t request_id = buffers_.signal_request();
+                buffers_.wait_for_response(request_id, []() { return true; });
+                read_shm_object(buffers_, response_);
+            } break;
+            case LoopbackMode::typed_message_handler:
+                native_sockets_.host_plugin_audio_thread_.receive_into(
+                    request_, response_, std::nullopt, buffer_);
+                break;
+        }
+
+        for (uint32_t channel = 0; channel < num_channels_; channel++) {
+            if (buffers_.output_channel_silent(0, channel)) {
+                std::fill(outputs[channel].begin(), outputs[channel].end(),
+                          0.0f);
+            } else {
+                std::copy_n(buffers_.output_channel_ptr<float>(0, channel),
+                            num_samples_, outputs[channel].data());
+            }
+        }
+    }
+
+   private:
+    /**
+     * The Wine plugin host side of a processing cycle. Our 'plugin' copies its
+     * inputs to its outputs.
+     */
+    Vst2ProcessResponse process_audio(const Vst2ProcessRequest& request) {
+        const uint32_t num_samples =
+            static_cast<uint32_t>(request.sample_frames);
+        for (uint32_t channel = 0; channel < num_channels_; channel++) {
+            std::copy_n(buffers_.input_channel_ptr<float>(0, channel),
+                        num_samples,
+                        buffers_.output_channel_ptr<float>(0, channel));
+        }
+
+        buffers_.update_silent_outputs<float>(0, num_channels_, num_samples);
+
+        return Vst2ProcessResponse{};
+    }
+
+    const LoopbackMode mode_;
+    const uint32_t num_channels_;
+    const uint32_t num_samples_;
+
+    asio::io_context io_context_;
+    const ghc::filesystem::path endpoint_base_dir_;
+    AudioShmBuffer buffers_;
+
+    LoopbackSockets native_sockets_;
+    LoopbackSockets wine_sockets_;
+
+    /**
+     * The Wine plugin host's audio thread.
+     */
+    std::jthread audio_thread_;
+
+    // These are reused between processing cycles, like in the actual bridges
+    SerializationBuffer<256> buffer_{};
+    Vst2ProcessRequest request_{};
+    Vst2ProcessResponse response_{};
+};
+
+}  // namespace
+
+void run_loopback_benchmarks(BenchmarkRunner& runner) {
+    constexpr std::pair<LoopbackMode, const char*> modes[] = {
+        {LoopbackMode::vst2_socket, "vst2-socket"},
+        {LoopbackMode::vst2_futex, "vst2-futex"},
+        {LoopbackMode::typed_message_handler, "typed-message-handler"},
+    };
+
+    for (const auto& [mode, mode_name] : modes) {
+        for (const size_t num_instances : {1, 8}) {
+            for (const uint32_t num_channels : {2, 32}) {
+                for (const uint32_t num_samples : {64, 512, 2048}) {
+                    const std::string name =
+                        "loopback/" + std::string(mode_name) + "/" +
+                        std::to_string(num_instances) + "x" +
+                        std::to_string(num_channels) + "ch/" +
+                        std::to_string(num_samples);
+                    if (!runner.should_run(name)) {
+                        continue;
+                    }
+
+                    std::vector<std::unique_ptr<LoopbackInstance>> instances;
+                    for (size_t i = 0; i < num_instances; i++) {
+                        instances.push_back(std::make_unique<LoopbackInstance>(
+                            mode, i, num_channels, num_samples));
+                    }
+
+                    std::vector<std::vector<float>> inputs(
+                        num_channels, std::vector<float>(num_samples, 0.5f));
+                    std::vector<std::vector<float>> outputs(
+                        num_channels, std::vector<float>(num_samples));
+
+                    // Like a host processing a chain of plugins, we'll process
+                    // all instances one after the other on the same thread
+                    runner.run(
+                        name,
+                        [&]() {
+                            for (auto& instance : instances) {
+                                instance->process(inputs, outputs);
+                            }
+                            do_not_optimize(outputs[0][0]);
+                        },
+                        num_instances * num_channels * num_samples *
+                            sizeof(float));
+                }
+            }
+        }
+    }
+}
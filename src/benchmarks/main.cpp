@@ -0,0 +1,40 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "benchmark.h"
+
+/**
+ * Micro-benchmarks for yabridge's serialization and communication layers. These
+ * run natively without Wine, so they can be used to catch performance
+ * regressions in the audio processing path. An optional substring can be
+ * passed as the first argument to only run matching benchmarks.
+ */
+int main(int argc, char* argv[]) {
+    BenchmarkRunner runner(argc > 1 ? std::optional<std::string>(argv[1])
+                                    : std::nullopt);
+
+    run_communication_benchmarks(runner);
+    run_audio_shm_benchmarks(runner);
+    run_loopback_benchmarks(runner);
+#ifdef WITH_VST3
+    run_vst3_benchmarks(runner);
+#endif
+#ifdef WITH_CLAP
+    run_clap_benchmarks(runner);
+#endif
+
+    return 0;
+}
@@ -0,0 +1,177 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "../common/serialization/vst3/process-data.h"
+#include "benchmark.h"
+
+namespace {
+
+/**
+ * Fill a parameter changes object like a host would when automating
+ * `num_parameters` parameters with `num_points` points each.
+ */
+void populate_parameter_changes(YaParameterChanges& parameter_changes,
+                                int num_parameters,
+                                int num_points) {
+    parameter_changes.clear();
+    for (int parameter = 0; parameter < num_parameters; parameter++) {
+        int32 queue_index;
+        Steinberg::Vst::IParamValueQueue* queue =
+            parameter_changes.addParameterData(
+                static_cast<Steinberg::Vst::ParamID>(parameter), queue_index);
+        const int32 point_spacing =
+            static_cast<int32>(benchmark_num_samples) / num_points;
+        for (int point = 0; point < num_points; point++) {
+            int32 point_index;
+            queue->addPoint(point * point_spacing,
+                            static_cast<double>(point) / num_points,
+                            point_index);
+        }
+    }
+}
+
+/**
+ * Fill an event list with `num_events` alternating note on and note off
+ * events.
+ */
+void populate_events(YaEventList& events, int num_events) {
+    events.clear();
+    for (int i = 0; i < num_events; i++) {
+        Steinberg::Vst::Event event{};
+        event.sampleOffset = i % static_cast<int32>(benchmark_num_samples);
+        if (i % 2 == 0) {
+            event.type = Steinberg::Vst::Event::kNoteOnEvent;
+            event.noteOn.pitch = static_cast<int16>(36 + (i / 2) % 48);
+            event.noteOn.velocity = 0.8f;
+            event.noteOn.noteId = -1;
+        } else {
+            event.type = Steinberg::Vst::Event::kNoteOffEvent;
+            event.noteOff.pitch = static_cast<int16>(36 + (i / 2) % 48);
+            event.noteOff.velocity = 0.0f;
+            event.noteOff.noteId = -1;
+        }
+
+        events.addEvent(event);
+    }
+}
+
+}  // namespace
+
+void run_vst3_benchmarks(BenchmarkRunner& runner) {
+    SerializationBuffer<256> buffer{};
+
+    for (const auto& [num_parameters, num_points] :
+         {std::pair(1, 1), std::pair(16, 4), std::pair(128, 16)}) {
+        YaParameterChanges parameter_changes{};
+        populate_parameter_changes(parameter_changes, num_parameters,
+                                   num_points);
+
+        YaParameterChanges target{};
+        runner.run("vst3/parameter-changes/round-trip/" +
+                       std::to_string(num_parameters) + "x" +
+                       std::to_string(num_points),
+                   [&]() {
+                       serialization_round_trip(parameter_changes, buffer,
+                                                target);
+                       do_not_optimize(target);
+                   });
+    }
+
+    for (const int num_events : {1, 64, 512}) {
+        YaEventList events{};
+        populate_events(events, num_events);
+
+        YaEventList target{};
+        runner.run(
+            "vst3/event-list/round-trip/" + std::to_string(num_events),
+            [&]() {
+                serialization_round_trip(events, buffer, target);
+                do_not_optimize(target);
+            });
+    }
+
+    // A full processing cycle's worth of data as a host would pass it to the
+    // plugin, with some automation, MIDI, and transport information
+    for (const uint32_t num_channels : {2, 32}) {
+        AudioShmBuffer shared_audio_buffers(
+            make_audio_shm_config("vst3-" + std::to_string(num_channels),
+                                  num_channels, benchmark_num_samples,
+                                  sizeof(float)));
+
+        std::vector<std::vector<float>> input_channels(
+            num_channels, std::vector<float>(benchmark_num_samples, 0.5f));
+        std::vector<std::vector<float>> output_channels(
+            num_channels, std::vector<float>(benchmark_num_samples, 0.0f));
+        std::vector<float*> input_pointers;
+        std::vector<float*> output_pointers;
+        for (uint32_t channel = 0; channel < num_channels; channel++) {
+            input_pointers.push_back(input_channels[channel].data());
+            output_pointers.push_back(output_channels[channel].data());
+        }
+
+        Steinberg::Vst::AudioBusBuffers inputs{};
+        inputs.numChannels = static_cast<int32>(num_channels);
+        inputs.channelBuffers32 = input_pointers.data();
+        Steinberg::Vst::AudioBusBuffers outputs{};
+        outputs.numChannels = static_cast<int32>(num_channels);
+        outputs.channelBuffers32 = output_pointers.data();
+
+        YaParameterChanges input_parameter_changes{};
+        populate_parameter_changes(input_parameter_changes, 16, 4);
+        YaParameterChanges output_parameter_changes{};
+        YaEventList input_events{};
+        populate_events(input_events, 64);
+        YaEventList output_events{};
+
+        Steinberg::Vst::ProcessContext process_context{};
+        process_context.state = Steinberg::Vst::ProcessContext::kPlaying |
+                                Steinberg::Vst::ProcessContext::kTempoValid;
+        process_context.sampleRate = 48000.0;
+        process_context.tempo = 120.0;
+
+        Steinberg::Vst::ProcessData process_data{};
+        process_data.processMode = Steinberg::Vst::kRealtime;
+        process_data.symbolicSampleSize = Steinberg::Vst::kSample32;
+        process_data.numSamples = static_cast<int32>(benchmark_num_samples);
+        process_data.numInputs = 1;
+        process_data.numOutputs = 1;
+        process_data.inputs = &inputs;
+        process_data.outputs = &outputs;
+        process_data.inputParameterChanges = &input_parameter_changes;
+        process_data.outputParameterChanges = &output_parameter_changes;
+        process_data.inputEvents = &input_events;
+        process_data.outputEvents = &output_events;
+        process_data.processContext = &process_context;
+
+        const std::string suffix = "/" + std::to_string(num_channels) + "ch";
+
+        // This includes copying the input audio to the shared memory object
+        YaProcessData request{};
+        runner.run(
+            "vst3/process-data/repopulate" + suffix,
+            [&]() {
+                request.repopulate(process_data, shared_audio_buffers);
+                do_not_optimize(request);
+            },
+            num_channels * benchmark_num_samples * sizeof(float));
+
+        YaProcessData target{};
+        runner.run("vst3/process-data/round-trip" + suffix, [&]() {
+            serialization_round_trip(request, buffer, target);
+            do_not_optimize(target);
+        });
+    }
+}
@@ -0,0 +1,222 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "audio-kernels.h"
+
+#include <immintrin.h>
+
+namespace {
+
+/**
+ * Whether we can use the AVX versions of these kernels. This is checked only
+ * once.
+ */
+bool cpu_supports_avx() noexcept {
+    static const bool supports_avx = []() {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx") != 0;
+    }();
+
+    return supports_avx;
+}
+
+void accumulate_samples_sse2(const float* source,
+                             size_t num_samples,
+                             float* destination) noexcept {
+    size_t i = 0;
+    for (; i + 4 <= num_samples; i += 4) {
+        _mm_storeu_ps(destination + i,
+                      _mm_add_ps(_mm_loadu_ps(destination + i),
+                                 _mm_loadu_ps(source + i)));
+    }
+    for (; i < num_samples; i++) {
+        destination[i] += source[i];
+    }
+}
+
+void accumulate_samples_sse2(const double* source,
+                             size_t num_samples,
+                             double* destination) noexcept {
+    size_t i = 0;
+    for (; i + 2 <= num_samples; i += 2) {
+        _mm_storeu_pd(destination + i,
+                      _mm_add_pd(_mm_loadu_pd(destination + i),
+                                 _mm_loadu_pd(source + i)));
+    }
+    for (; i < num_samples; i++) {
+        destination[i] += source[i];
+    }
+}
+
+__attribute__((target("avx"))) void accumulate_samples_avx(
+    const float* source,
+    size_t num_samples,
+    float* destination) noexcept {
+    size_t i = 0;
+    for (; i + 8 <= num_samples; i += 8) {
+        _mm256_storeu_ps(destination + i,
+                         _mm256_add_ps(_mm256_loadu_ps(destination + i),
+                                       _mm256_loadu_ps(source + i)));
+    }
+    for (; i < num_samples; i++) {
+        destination[i] += source[i];
+    }
+}
+
+__attribute__((target("avx"))) void accumulate_samples_avx(
+    const double* source,
+    size_t num_samples,
+    double* destination) noexcept {
+    size_t i = 0;
+    for (; i + 4 <= num_samples; i += 4) {
+        _mm256_storeu_pd(destination + i,
+                         _mm256_add_pd(_mm256_loadu_pd(destination + i),
+                                       _mm256_loadu_pd(source + i)));
+    }
+    for (; i < num_samples; i++) {
+        destination[i] += source[i];
+    }
+}
+
+// For the silence checks we'll compare every sample against zero with an
+// unordered not-equal comparison, so negative zeroes count as silence and NaNs
+// don't. We'll check two vectors at a time to reduce the number of branches.
+
+bool is_silent_sse2(const float* samples, size_t num_samples) noexcept {
+    const __m128 zero = _mm_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 8 <= num_samples; i += 8) {
+        const __m128 nonzero =
+            _mm_or_ps(_mm_cmpneq_ps(_mm_loadu_ps(samples + i), zero),
+                      _mm_cmpneq_ps(_mm_loadu_ps(samples + i + 4), zero));
+        if (_mm_movemask_ps(nonzero) != 0) {
+            return false;
+        }
+    }
+    for (; i < num_samples; i++) {
+        if (samples[i] != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool is_silent_sse2(const double* samples, size_t num_samples) noexcept {
+    const __m128d zero = _mm_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 4 <= num_samples; i += 4) {
+        const __m128d nonzero =
+            _mm_or_pd(_mm_cmpneq_pd(_mm_loadu_pd(samples + i), zero),
+                      _mm_cmpneq_pd(_mm_loadu_pd(samples + i + 2), zero));
+        if (_mm_movemask_pd(nonzero) != 0) {
+            return false;
+        }
+    }
+    for (; i < num_samples; i++) {
+        if (samples[i] != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+__attribute__((target("avx"))) bool is_silent_avx(const float* samples,
+                                                  size_t num_samples) noexcept {
+    const __m256 zero = _mm256_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 16 <= num_samples; i += 16) {
+        const __m256 nonzero = _mm256_or_ps(
+            _mm256_cmp_ps(_mm256_loadu_ps(samples + i), zero, _CMP_NEQ_UQ),
+            _mm256_cmp_ps(_mm256_loadu_ps(samples + i + 8), zero,
+                          _CMP_NEQ_UQ));
+        if (_mm256_movemask_ps(nonzero) != 0) {
+            return false;
+        }
+    }
+    for (; i < num_samples; i++) {
+        if (samples[i] != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+__attribute__((target("avx"))) bool is_silent_avx(const double* samples,
+                                                  size_t num_samples) noexcept {
+    const __m256d zero = _mm256_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 8 <= num_samples; i += 8) {
+        const __m256d nonzero = _mm256_or_pd(
+            _mm256_cmp_pd(_mm256_loadu_pd(samples + i), zero, _CMP_NEQ_UQ),
+            _mm256_cmp_pd(_mm256_loadu_pd(samples + i + 4), zero,
+                          _CMP_NEQ_UQ));
+        if (_mm256_movemask_pd(nonzero) != 0) {
+            return false;
+        }
+    }
+    for (; i < num_samples; i++) {
+        if (samples[i] != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}  // namespace
+
+void accumulate_samples(const float* source,
+                        size_t num_samples,
+                        float* destination) noexcept {
+    if (cpu_supports_avx()) {
+        accumulate_samples_avx(source, num_samples, destination);
+    } else {
+        accumulate_samples_sse2(source, num_samples, destination);
+    }
+}
+
+void accumulate_samples(const double* source,
+                        size_t num_samples,
+                        double* destination) noexcept {
+    if (cpu_supports_avx()) {
+        accumulate_samples_avx(source, num_samples, destination);
+    } else {
+        accumulate_samples_sse2(source, num_samples, destination);
+    }
+}
+
+bool is_silent(const float* samples, size_t num_samples) noexcept {
+    if (cpu_supports_avx()) {
+        return is_silent_avx(samples, num_samples);
+    } else {
+        return is_silent_sse2(samples, num_samples);
+    }
+}
+
+bool is_silent(const double* samples, size_t num_samples) noexcept {
+    if (cpu_supports_avx()) {
+        return is_silent_avx(samples, num_samples);
+    } else {
+        return is_silent_sse2(samples, num_samples);
+    }
+}
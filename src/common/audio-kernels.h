@@ -0,0 +1,44 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+
+// Vectorized versions of the sample operations we perform on every audio
+// channel during every processing cycle. These use SSE2 by default since that's
+// always enabled for both the 32-bit and the 64-bit builds, and they'll switch
+// to AVX at runtime when the CPU supports it. Plain copies don't need to be in
+// here since `std::copy_n()` already compiles down to a `memmove()`.
+
+/**
+ * Add `num_samples` samples from `source` to the samples in `destination`. Used
+ * for VST2's old accumulating `process()` function.
+ */
+void accumulate_samples(const float* source,
+                        size_t num_samples,
+                        float* destination) noexcept;
+void accumulate_samples(const double* source,
+                        size_t num_samples,
+                        double* destination) noexcept;
+
+/**
+ * Check whether all of the `num_samples` samples in `samples` are zero. This
+ * stops at the first nonzero sample, so this is cheap for buffers that do
+ * contain audio. Negative zeroes also count as zero, NaNs don't.
+ */
+bool is_silent(const float* samples, size_t num_samples) noexcept;
+bool is_silent(const double* samples, size_t num_samples) noexcept;
@@ -18,10 +18,20 @@
 
 #include <iostream>
 
+#include <unistd.h>
+
+#include "futex.h"
 #include "logging/common.h"
+#include "probes.h"
 
 using namespace std::literals::string_literals;
 
+/**
+ * How long the native plugin will block on a futex while waiting for a response
+ * before checking whether the Wine plugin host is still alive.
+ */
+constexpr time_t response_timeout_seconds = 1;
+
 AudioShmBuffer::AudioShmBuffer(const Config& config)
     : config_(config),
       shm_fd_(shm_open(config.name.c_str(), O_RDWR | O_CREAT, 0600)) {
@@ -39,7 +49,7 @@ AudioShmBuffer::~AudioShmBuffer() noexcept {
     // removed, so we'll do it on both sides to reduce the chance that we leak
     // shared memory
     if (!is_moved_) {
-        munmap(shm_bytes_, config_.size);
+        munmap(shm_bytes_, shm_size_);
         close(shm_fd_);
         shm_unlink(config_.name.c_str());
     }
@@ -49,7 +59,8 @@ AudioShmBuffer::AudioShmBuffer(AudioShmBuffer&& o) noexcept
     : config_(std::move(o.config_)),
       shm_fd_(std::move(o.shm_fd_)),
       shm_bytes_(std::move(o.shm_bytes_)),
-      shm_size_(std::move(o.shm_size_)) {
+      shm_size_(std::move(o.shm_size_)),
+      output_flag_offsets_(std::move(o.output_flag_offsets_)) {
     o.is_moved_ = true;
 }
 
@@ -58,6 +69,7 @@ AudioShmBuffer& AudioShmBuffer::operator=(AudioShmBuffer&& o) noexcept {
     shm_fd_ = std::move(o.shm_fd_);
     shm_bytes_ = std::move(o.shm_bytes_);
     shm_size_ = std::move(o.shm_size_);
+    output_flag_offsets_ = std::move(o.output_flag_offsets_);
     o.is_moved_ = true;
 
     return *this;
@@ -74,48 +86,229 @@ void AudioShmBuffer::resize(const Config& new_config) {
     setup_mapping();
 }
 
+uint8_t* AudioShmBuffer::control_payload() noexcept {
+    return shm_bytes_ + control_payload_offset;
+}
+
+const uint8_t* AudioShmBuffer::control_payload() const noexcept {
+    return shm_bytes_ + control_payload_offset;
+}
+
+size_t AudioShmBuffer::control_payload_capacity() noexcept {
+    return control_block_size - control_payload_offset;
+}
+
+uint32_t AudioShmBuffer::control_payload_size() const noexcept {
+    return control().payload_size;
+}
+
+void AudioShmBuffer::set_control_payload_size(uint32_t size) noexcept {
+    control().payload_size = size;
+}
+
+uint32_t AudioShmBuffer::signal_request() noexcept {
+    // The release ordering makes sure the payload written before this is
+    // visible to the Wine plugin host when it sees the new request ID
+    const uint32_t request_id =
+        control().request_id.fetch_add(1, std::memory_order_release) + 1;
+    futex_wake(control().request_id);
+
+    return request_id;
+}
+
+bool AudioShmBuffer::wait_for_response_for(uint32_t request_id) noexcept {
+    const timespec timeout{.tv_sec = response_timeout_seconds, .tv_nsec = 0};
+
+    // When rendering offline the response will likely arrive within a few
+    // microseconds, so we can avoid the futex syscalls entirely
+    if (spin_until([&]() {
+            return control().response_id.load(std::memory_order_acquire) ==
+                   request_id;
+        })) {
+        return true;
+    }
+
+    uint32_t current_id;
+    while ((current_id = control().response_id.load(
+                std::memory_order_acquire)) != request_id) {
+        // Spurious wakeups are fine, we'll just check the word again
+        if (futex_wait(control().response_id, current_id, &timeout)) {
+            return control().response_id.load(std::memory_order_acquire) ==
+                   request_id;
+        }
+    }
+
+    return true;
+}
+
+bool AudioShmBuffer::wait_for_request(uint32_t& request_id) noexcept {
+    spin_until([&]() {
+        return control().request_id.load(std::memory_order_acquire) !=
+               request_id;
+    });
+
+    uint32_t current_id;
+    while ((current_id = control().request_id.load(
+                std::memory_order_acquire)) == request_id) {
+        futex_wait(control().request_id, current_id, nullptr);
+    }
+
+    // `stop_listening()` also bumps the request ID so we can't miss the wakeup
+    if (control().stop.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    request_id = current_id;
+
+    return true;
+}
+
+uint32_t AudioShmBuffer::last_request_id() const noexcept {
+    return control().request_id.load(std::memory_order_acquire);
+}
+
+void AudioShmBuffer::signal_response(uint32_t request_id) noexcept {
+    control().response_id.store(request_id, std::memory_order_release);
+    futex_wake(control().response_id);
+}
+
+void AudioShmBuffer::set_offline_processing(bool offline) noexcept {
+    control().offline.store(offline, std::memory_order_relaxed);
+}
+
+bool AudioShmBuffer::offline_processing() const noexcept {
+    return control().offline.load(std::memory_order_relaxed);
+}
+
+void AudioShmBuffer::start_listening() noexcept {
+    control().stop.store(0, std::memory_order_release);
+}
+
+void AudioShmBuffer::stop_listening() noexcept {
+    control().stop.store(1, std::memory_order_release);
+    control().request_id.fetch_add(1, std::memory_order_release);
+    futex_wake(control().request_id);
+}
+
 void AudioShmBuffer::setup_mapping() {
-    // Apparently you get a `Resource temporarily unavailable` when calling
-    // `ftruncate()` with a size of 0 on shared memory
-    if (config_.size > 0) {
-        // I don't think this can fail
-        assert(ftruncate(shm_fd_, config_.size) == 0);
-
-        // But this can, if the user does not have permissions to use (enough)
-        // locked emmory, we'll try it without locking memory and show a big
-        // obnoxious warning and try again without locking the memory.
-        uint8_t* old_shm_bytes = shm_bytes_;
-        shm_bytes_ = static_cast<uint8_t*>(
-            old_shm_bytes
-                ? mremap(old_shm_bytes, shm_size_, config_.size, MREMAP_MAYMOVE)
-                : mmap(nullptr, config_.size, PROT_READ | PROT_WRITE,
-                       MAP_SHARED | MAP_LOCKED, shm_fd_, 0));
+    // The output silence flags are stored after the audio buffers, with one
+    // byte per output channel. Both sides compute this same layout from the
+    // configuration.
+    uint32_t num_output_channels = 0;
+    output_flag_offsets_.resize(config_.output_offsets.size());
+    for (size_t bus = 0; bus < config_.output_offsets.size(); bus++) {
+        output_flag_offsets_[bus] = num_output_channels;
+        num_output_channels +=
+            static_cast<uint32_t>(config_.output_offsets[bus].size());
+    }
+
+    // The control block is always stored before the audio buffers, so this
+    // size will never be zero. Apparently you'd get a `Resource temporarily
+    // unavailable` when calling `ftruncate()` with a size of 0 on shared
+    // memory.
+    const size_t new_size =
+        control_block_size + config_.size + num_output_channels;
+
+    // I don't think this can fail
+    assert(ftruncate(shm_fd_, new_size) == 0);
+
+    // But this can, if the user does not have permissions to use (enough)
+    // locked emmory, we'll try it without locking memory and show a big
+    // obnoxious warning and try again without locking the memory.
+    uint8_t* old_shm_bytes = shm_bytes_;
+    shm_bytes_ = static_cast<uint8_t*>(
+        old_shm_bytes
+            ? mremap(old_shm_bytes, shm_size_, new_size, MREMAP_MAYMOVE)
+            : mmap(nullptr, new_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_LOCKED, shm_fd_, 0));
+    if (shm_bytes_ == MAP_FAILED) {
+        Logger logger = Logger::create_exception_logger();
+
+        logger.log("");
+        logger.log("ERROR: Could not map shared memory. This means that");
+        logger.log("       your user's memory locking limit has been");
+        logger.log("       reached. Check your distro's documentation or");
+        logger.log("       wiki for instructions on how to set up");
+        logger.log("       realtime privileges and memlock limits.");
+        logger.log("");
+
+        // Growing into a size that we cannot lock sounds like a super rare
+        // edge case, but let's handle it anyways
+        if (old_shm_bytes) {
+            assert(munmap(old_shm_bytes, shm_size_) == 0);
+        }
+        shm_bytes_ = static_cast<uint8_t*>(mmap(
+            nullptr, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd_, 0));
         if (shm_bytes_ == MAP_FAILED) {
-            Logger logger = Logger::create_exception_logger();
-
-            logger.log("");
-            logger.log("ERROR: Could not map shared memory. This means that");
-            logger.log("       your user's memory locking limit has been");
-            logger.log("       reached. Check your distro's documentation or");
-            logger.log("       wiki for instructions on how to set up");
-            logger.log("       realtime privileges and memlock limits.");
-            logger.log("");
-
-            // Growing into a size that we cannot lock sounds like a super rare
-            // edge case, but let's handle it anyways
-            if (old_shm_bytes) {
-                assert(munmap(old_shm_bytes, shm_size_) == 0);
-            }
-            shm_bytes_ = static_cast<uint8_t*>(mmap(nullptr, config_.size,
-                                                    PROT_READ | PROT_WRITE,
-                                                    MAP_SHARED, shm_fd_, 0));
-            if (shm_bytes_ == MAP_FAILED) {
-                throw std::system_error(
-                    std::error_code(errno, std::system_category()),
-                    "Could not map shared memory");
-            }
+            throw std::system_error(
+                std::error_code(errno, std::system_category()),
+                "Could not map shared memory");
         }
     }
 
-    shm_size_ = config_.size;
+    shm_size_ = new_size;
+    YABRIDGE_PROBE(setup_mapping, config_.name.c_str(), shm_size_,
+                   old_shm_bytes != nullptr);
+}
+
+void AudioChannelAliasDetector::add_input(uint32_t bus,
+                                          uint32_t channel,
+                                          const void* buffer) {
+    current_inputs_.push_back(
+        Channel{.bus = bus, .channel = channel, .buffer = buffer});
+}
+
+void AudioChannelAliasDetector::add_output(uint32_t bus,
+                                           uint32_t channel,
+                                           const void* buffer) {
+    current_outputs_.push_back(
+        Channel{.bus = bus, .channel = channel, .buffer = buffer});
+}
+
+const AudioChannelAliases& AudioChannelAliasDetector::update() {
+    // This is the hot path, since hosts don't often change their buffers
+    if (current_inputs_ != previous_inputs_) {
+        find_aliases(current_inputs_, aliases_.inputs, input_is_alias_);
+        previous_inputs_.swap(current_inputs_);
+    }
+    if (current_outputs_ != previous_outputs_) {
+        find_aliases(current_outputs_, aliases_.outputs, output_is_alias_);
+        previous_outputs_.swap(current_outputs_);
+    }
+
+    current_inputs_.clear();
+    current_outputs_.clear();
+
+    return aliases_;
+}
+
+void AudioChannelAliasDetector::find_aliases(
+    const std::vector<Channel>& channels,
+    std::vector<AudioChannelAliases::Alias>& aliases,
+    std::vector<uint8_t>& is_alias) {
+    aliases.clear();
+    is_alias.assign(channels.size(), false);
+
+    // Even with lots of channels this is cheap enough, and this only runs when
+    // the host changes its buffers, so the quadratic search is fine here. The
+    // first channel using a buffer is never an alias, so it will always be the
+    // source for the other channels using that same buffer.
+    for (size_t i = 1; i < channels.size(); i++) {
+        if (!channels[i].buffer) {
+            continue;
+        }
+
+        for (size_t j = 0; j < i; j++) {
+            if (channels[j].buffer == channels[i].buffer) {
+                aliases.push_back(AudioChannelAliases::Alias{
+                    .bus = channels[i].bus,
+                    .channel = channels[i].channel,
+                    .source_bus = channels[j].bus,
+                    .source_channel = channels[j].channel});
+                is_alias[i] = true;
+
+                break;
+            }
+        }
+    }
 }
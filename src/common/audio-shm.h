@@ -16,11 +16,20 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 #include <sys/mman.h>
 
+#include "audio-kernels.h"
+#include "utils.h"
+
 /**
  * A shared memory object that allows audio buffers to be shared between the
  * native plugin and the Wine plugin host. This is intended as an optimization,
@@ -44,9 +53,25 @@
  * for audio processing. The configuration (e.g. name, and dimensions) for this
  * shared memory object are then sent back to the plugin so the plugin can map
  * the same shared memory region.
+ *
+ * The first `AudioShmBuffer::control_block_size` bytes of the shared memory
+ * object are reserved for a small control block. When the
+ * `futex_audio_signalling` option is enabled, the audio processing requests
+ * and their responses are written to this control block instead of to a
+ * socket, and the native plugin and the Wine plugin host will wake each other
+ * up using futexes stored in that same block. The audio channel offsets in
+ * `Config` are relative to the end of this control block.
  */
 class AudioShmBuffer {
    public:
+    /**
+     * The number of bytes reserved at the start of the shared memory object for
+     * the control block. This is a couple of pages, which is plenty for a
+     * serialized audio processing request. Requests and responses that don't
+     * fit in here will have to be sent over a socket instead.
+     */
+    static constexpr uint32_t control_block_size = 16 * 1024;
+
     /**
      * The parameters needed for creating, configuring and connecting to a
      * shared audio buffer object. This is done on the Wine plugin host. For
@@ -67,10 +92,11 @@ class AudioShmBuffer {
         std::string name;
 
         /**
-         * The size of the shared memory object **in bytes** (so not samples).
-         * This should be large enough to hold all input and output buffers, and
-         * it depends on whether the host is going to pass 32-bit single
-         * precision or 64-bit double precision audio to the plugin.
+         * The size of the shared memory object's audio buffers **in bytes** (so
+         * not samples). This should be large enough to hold all input and
+         * output buffers, and it depends on whether the host is going to pass
+         * 32-bit single precision or 64-bit double precision audio to the
+         * plugin. This does not include the control block.
          */
         uint32_t size;
 
@@ -156,7 +182,7 @@ class AudioShmBuffer {
     template <typename T>
     // NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
     T* input_channel_ptr(const uint32_t bus, const uint32_t channel) noexcept {
-        return reinterpret_cast<T*>(shm_bytes_ +
+        return reinterpret_cast<T*>(audio_bytes() +
                                     config_.input_offsets[bus][channel]);
     }
 
@@ -164,7 +190,7 @@ class AudioShmBuffer {
     // NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
     const T* input_channel_ptr(const uint32_t bus,
                                const uint32_t channel) const noexcept {
-        return reinterpret_cast<const T*>(shm_bytes_ +
+        return reinterpret_cast<const T*>(audio_bytes() +
                                           config_.input_offsets[bus][channel]);
     }
 
@@ -176,7 +202,7 @@ class AudioShmBuffer {
     template <typename T>
     // NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
     T* output_channel_ptr(const uint32_t bus, const uint32_t channel) noexcept {
-        return reinterpret_cast<T*>(shm_bytes_ +
+        return reinterpret_cast<T*>(audio_bytes() +
                                     config_.output_offsets[bus][channel]);
     }
 
@@ -184,13 +210,286 @@ class AudioShmBuffer {
     // NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
     const T* output_channel_ptr(const uint32_t bus,
                                 const uint32_t channel) const noexcept {
-        return reinterpret_cast<const T*>(shm_bytes_ +
+        return reinterpret_cast<const T*>(audio_bytes() +
                                           config_.output_offsets[bus][channel]);
     }
 
+    /**
+     * Copy `num_samples` samples from the host's buffer to an input channel.
+     * Used on the native plugin side.
+     */
+    template <typename T>
+    void write_input_channel(const uint32_t bus,
+                             const uint32_t channel,
+                             const T* samples,
+                             const size_t num_samples) noexcept {
+        std::copy_n(samples, num_samples, input_channel_ptr<T>(bus, channel));
+    }
+
+    /**
+     * Fill the first `num_samples` samples of an input channel with `value`.
+     * This is used instead of `write_input_channel()` when the host told us
+     * that a channel is silent or constant, so we don't need to read the
+     * host's buffer. Used on the native plugin side.
+     *
+     * NOTE: We can't skip this for channels that were already cleared during
+     *       an earlier processing cycle, since some plugins use their input
+     *       buffers as scratch space.
+     */
+    template <typename T>
+    void fill_input_channel(const uint32_t bus,
+                            const uint32_t channel,
+                            const T value,
+                            const size_t num_samples) noexcept {
+        std::fill_n(input_channel_ptr<T>(bus, channel), num_samples, value);
+    }
+
+    /**
+     * Check which of the first `num_channels` output channels on this bus
+     * contain only zeroes after the plugin has processed `num_samples` samples,
+     * and store that information in this object. The native plugin can then
+     * write zeroes to the host's buffers for those channels instead of copying
+     * them from this object. This stops at the first nonzero sample, so it's
+     * cheap for channels that do contain audio. Used on the Wine plugin host
+     * side after the plugin has finished processing.
+     */
+    template <typename T>
+    void update_silent_outputs(const uint32_t bus,
+                               const uint32_t num_channels,
+                               const size_t num_samples) noexcept {
+        uint8_t* flags = output_flags() + output_flag_offsets_[bus];
+        for (uint32_t channel = 0; channel < num_channels; channel++) {
+            flags[channel] =
+                is_silent(output_channel_ptr<T>(bus, channel), num_samples);
+        }
+    }
+
+    /**
+     * Whether an output channel contained only zeroes the last time
+     * `update_silent_outputs()` was called for its bus. Used on the native
+     * plugin side.
+     */
+    inline bool output_channel_silent(const uint32_t bus,
+                                      const uint32_t channel) const noexcept {
+        return output_flags()[output_flag_offsets_[bus] + channel];
+    }
+
+    /**
+     * A pointer to the part of the control block that's used for serialized
+     * requests and responses. This can hold up to `control_payload_capacity()`
+     * bytes. The size of the object currently stored there can be set and
+     * retrieved using `set_control_payload_size()` and
+     * `control_payload_size()`.
+     */
+    uint8_t* control_payload() noexcept;
+    const uint8_t* control_payload() const noexcept;
+
+    /**
+     * The maximum size of a request or response stored in the control block.
+     */
+    static size_t control_payload_capacity() noexcept;
+
+    uint32_t control_payload_size() const noexcept;
+    void set_control_payload_size(uint32_t size) noexcept;
+
+    /**
+     * Signal the other side that a new request has been written to the control
+     * block. Used on the native plugin side. The returned request ID should be
+     * passed to `wait_for_response()`.
+     */
+    uint32_t signal_request() noexcept;
+
+    /**
+     * Wait until the Wine plugin host has responded to the request with the
+     * given ID. This uses a futex, so this doesn't involve any polling. To
+     * avoid hanging indefinitely when the Wine plugin host crashes, we'll
+     * periodically call `is_alive` to check whether we should keep waiting.
+     *
+     * @param request_id The ID returned by `signal_request()`.
+     * @param is_alive A function that should return `false` if the other side
+     *   has died.
+     *
+     * @throw std::runtime_error If `is_alive()` returned false.
+     */
+    template <invocable_returning<bool> F>
+    void wait_for_response(uint32_t request_id, F&& is_alive) {
+        while (!wait_for_response_for(request_id)) {
+            if (!is_alive()) [[unlikely]] {
+                throw std::runtime_error(
+                    "The Wine plugin host stopped responding while waiting "
+                    "for an audio processing response");
+            }
+        }
+    }
+
+    /**
+     * Wait until the native plugin has sent a new request. Used on the Wine
+     * plugin host side. This should be called in a loop, and this returns
+     * `false` when `stop_listening()` has been called.
+     *
+     * @param request_id The ID of the last handled request. This will be set to
+     *   the new request's ID. Should be initialized with
+     *   `last_request_id()`.
+     */
+    bool wait_for_request(uint32_t& request_id) noexcept;
+
+    /**
+     * The ID of the last request sent by the native plugin. Used to initialize
+     * the counter passed to `wait_for_request()`.
+     */
+    uint32_t last_request_id() const noexcept;
+
+    /**
+     * Signal the native plugin that we've finished handling the request with
+     * the given ID. Any response data should have already been written to the
+     * control block at this point.
+     */
+    void signal_response(uint32_t request_id) noexcept;
+
+    /**
+     * Mark whether the plugin is currently rendering offline. This is set by
+     * the Wine plugin host at the start of every processing call based on the
+     * plugin's process mode or level. While rendering offline there are no
+     * real time deadlines and the host will immediately send the next block
+     * after a response has arrived, so both sides will briefly spin in
+     * `spin_until()` before going to sleep to avoid paying for a context
+     * switch on every round trip.
+     */
+    void set_offline_processing(bool offline) noexcept;
+
+    /**
+     * Whether `set_offline_processing()` was last called with `true`.
+     */
+    bool offline_processing() const noexcept;
+
+    /**
+     * If the plugin is rendering offline, then call `ready` in a loop for up to
+     * `offline_spin_duration` until it returns true. When not rendering
+     * offline this returns `false` immediately. The caller should still do a
+     * regular blocking wait afterwards, this only gives the other side a head
+     * start.
+     *
+     * @return Whether `ready()` returned true before we ran out of time.
+     */
+    template <invocable_returning<bool> F>
+    bool spin_until(F&& ready) const noexcept {
+        if (!offline_processing()) {
+            return false;
+        }
+
+        const auto deadline =
+            std::chrono::steady_clock::now() + offline_spin_duration;
+        do {
+            for (int i = 0; i < 64; i++) {
+                if (ready()) {
+                    return true;
+                }
+
+#if defined(__x86_64__) || defined(__i386__)
+                __builtin_ia32_pause();
+#endif
+            }
+        } while (std::chrono::steady_clock::now() < deadline);
+
+        return ready();
+    }
+
+    /**
+     * How long `spin_until()` spins before giving up. This is long enough to
+     * cover the host's turnaround between offline blocks and the processing
+     * time of most lightweight plugins, while still being short enough to not
+     * waste a noticeable amount of CPU time on heavy plugins.
+     */
+    static constexpr std::chrono::microseconds offline_spin_duration{200};
+
+    /**
+     * Reset the stop flag set by `stop_listening()`. This should be called
+     * before spawning a thread that calls `wait_for_request()`.
+     */
+    void start_listening() noexcept;
+
+    /**
+     * Wake up any thread currently blocked in `wait_for_request()` and make it
+     * return `false`.
+     */
+    void stop_listening() noexcept;
+
     Config config_;
 
    private:
+    /**
+     * The layout of the control block stored at the start of the shared memory
+     * object. The two futex words live on their own cache lines since they're
+     * written to by different processes.
+     */
+    struct ControlBlock {
+        /**
+         * Incremented by the native plugin for every new request.
+         */
+        alignas(64) std::atomic<uint32_t> request_id;
+        /**
+         * Set by the Wine plugin host to the ID of the request it has just
+         * finished handling.
+         */
+        alignas(64) std::atomic<uint32_t> response_id;
+        /**
+         * Set to 1 by `stop_listening()` to terminate the listening thread.
+         */
+        std::atomic<uint32_t> stop;
+        /**
+         * The size of the serialized object stored in the payload area.
+         */
+        uint32_t payload_size;
+        /**
+         * Set through `set_offline_processing()`.
+         */
+        std::atomic<uint32_t> offline;
+    };
+
+    static_assert(std::atomic<uint32_t>::is_always_lock_free);
+    static_assert(sizeof(ControlBlock) < control_block_size);
+
+    /**
+     * The offset of the payload area within the control block.
+     */
+    static constexpr size_t control_payload_offset = 128;
+    static_assert(sizeof(ControlBlock) <= control_payload_offset);
+
+    inline ControlBlock& control() noexcept {
+        return *reinterpret_cast<ControlBlock*>(shm_bytes_);
+    }
+    inline const ControlBlock& control() const noexcept {
+        return *reinterpret_cast<const ControlBlock*>(shm_bytes_);
+    }
+
+    /**
+     * The start of the audio buffers, right after the control block.
+     */
+    inline uint8_t* audio_bytes() noexcept {
+        return shm_bytes_ + control_block_size;
+    }
+    inline const uint8_t* audio_bytes() const noexcept {
+        return shm_bytes_ + control_block_size;
+    }
+
+    /**
+     * The output silence flags set in `update_silent_outputs()`. These are
+     * stored right after the audio buffers, one byte per output channel.
+     */
+    inline uint8_t* output_flags() noexcept {
+        return audio_bytes() + config_.size;
+    }
+    inline const uint8_t* output_flags() const noexcept {
+        return audio_bytes() + config_.size;
+    }
+
+    /**
+     * Wait for the response to a request for a bounded amount of time.
+     *
+     * @return Whether the response has arrived.
+     */
+    bool wait_for_response_for(uint32_t request_id) noexcept;
+
     /**
      * Resize the shared memory object, and set up the memory mapping.
      *
@@ -211,5 +510,218 @@ class AudioShmBuffer {
      */
     size_t shm_size_ = 0;
 
+    /**
+     * The index of the first channel of every output bus when all output
+     * channels are numbered sequentially. Used to index `output_flags()`.
+     */
+    std::vector<uint32_t> output_flag_offsets_;
+
     bool is_moved_ = false;
 };
+
+/**
+ * Hosts will sometimes pass the same buffer for more than one audio channel.
+ * Common examples are a single silent buffer for all unconnected (sidechain)
+ * inputs, or a single scratch buffer for all outputs the host is not interested
+ * in. When that happens we only need to copy that buffer to or from the shared
+ * memory object once. On the Wine side the other channels will then point to
+ * the same region in the shared memory object, so the Windows plugin sees the
+ * exact same aliasing it would have seen when it was hosted natively. This is
+ * sent along with every audio processing request, and it will be empty almost
+ * all of the time.
+ *
+ * @see AudioChannelAliasDetector
+ * @see ScopedAudioChannelAliases
+ */
+struct AudioChannelAliases {
+    /**
+     * A channel that should use another channel's buffer. The source channel
+     * always comes before the aliased channel, it has the same direction, and
+     * it's never an alias itself.
+     */
+    struct Alias {
+        uint32_t bus;
+        uint32_t channel;
+        uint32_t source_bus;
+        uint32_t source_channel;
+
+        bool operator==(const Alias&) const noexcept = default;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.value4b(bus);
+            s.value4b(channel);
+            s.value4b(source_bus);
+            s.value4b(source_channel);
+        }
+    };
+
+    std::vector<Alias> inputs;
+    std::vector<Alias> outputs;
+
+    template <typename S>
+    void serialize(S& s) {
+        s.container(inputs, 1 << 16);
+        s.container(outputs, 1 << 16);
+    }
+};
+
+/**
+ * Finds the channels that share a host buffer on the native plugin side. Hosts
+ * will pass the same buffer pointers for every processing cycle, so we'll only
+ * redo the pairwise comparisons when those pointers change. To use this, call
+ * `add_input()` and `add_output()` for every channel in the same order you'll
+ * later copy them in, then call `update()`, and then use `is_input_alias()` and
+ * `is_output_alias()` to skip the copies for aliased channels.
+ *
+ * This should only be used from a single audio thread. The vectors in here
+ * will only ever grow, so after the first couple of processing cycles this
+ * won't allocate anymore.
+ */
+class AudioChannelAliasDetector {
+   public:
+    /**
+     * Add the host's buffer for the next input channel. Null pointers are never
+     * considered to be aliases.
+     */
+    void add_input(uint32_t bus, uint32_t channel, const void* buffer);
+
+    /**
+     * Add the host's buffer for the next output channel. Null pointers are
+     * never considered to be aliases.
+     */
+    void add_output(uint32_t bus, uint32_t channel, const void* buffer);
+
+    /**
+     * Finish adding channels for this processing cycle. If the channels and
+     * their buffers are the same as during the last cycle then the previous
+     * results are reused, otherwise they'll be recomputed.
+     *
+     * @return The aliases for this processing cycle. This should be sent to the
+     *   Wine plugin host along with the processing request.
+     */
+    const AudioChannelAliases& update();
+
+    /**
+     * Whether the `index`th input channel added during this cycle uses the
+     * same buffer as an earlier input channel. The audio for these channels
+     * doesn't have to be copied to the shared memory object. Only valid after
+     * calling `update()`.
+     */
+    inline bool is_input_alias(size_t index) const noexcept {
+        return index < input_is_alias_.size() && input_is_alias_[index];
+    }
+
+    /**
+     * Whether the `index`th output channel added during this cycle uses the
+     * same buffer as an earlier output channel. These channels don't have to be
+     * copied back to the host. Only valid after calling `update()`.
+     */
+    inline bool is_output_alias(size_t index) const noexcept {
+        return index < output_is_alias_.size() && output_is_alias_[index];
+    }
+
+   private:
+    struct Channel {
+        uint32_t bus;
+        uint32_t channel;
+        const void* buffer;
+
+        bool operator==(const Channel&) const noexcept = default;
+    };
+
+    /**
+     * Find the aliases within `channels`, and write them to `aliases` and
+     * `is_alias`.
+     */
+    static void find_aliases(const std::vector<Channel>& channels,
+                             std::vector<AudioChannelAliases::Alias>& aliases,
+                             std::vector<uint8_t>& is_alias);
+
+    /**
+     * The channels added since the last call to `update()`.
+     */
+    std::vector<Channel> current_inputs_;
+    std::vector<Channel> current_outputs_;
+    /**
+     * The channels from the last processing cycle, used to check whether we
+     * need to recompute the aliases.
+     */
+    std::vector<Channel> previous_inputs_;
+    std::vector<Channel> previous_outputs_;
+
+    // These are `uint8_t`s rather than `bool`s to avoid `std::vector<bool>`
+    std::vector<uint8_t> input_is_alias_;
+    std::vector<uint8_t> output_is_alias_;
+
+    AudioChannelAliases aliases_;
+};
+
+/**
+ * Temporarily point the aliased channels from an `AudioChannelAliases` object
+ * at their source channel's region in the shared memory object. This is used
+ * on the Wine side around the plugin's process function. When this object gets
+ * dropped, those channels will point to their own regions again.
+ *
+ * @tparam Pointers Either `std::vector<void*>` for VST2 plugins, which only
+ *   have a single bus, or `std::vector<std::vector<void*>>` indexed by
+ *   `[bus][channel]` for VST3 and CLAP plugins.
+ */
+template <typename Pointers>
+class ScopedAudioChannelAliases {
+   public:
+    ScopedAudioChannelAliases(const AudioChannelAliases& aliases,
+                              AudioShmBuffer& buffers,
+                              Pointers& input_pointers,
+                              Pointers& output_pointers) noexcept
+        : aliases_(aliases),
+          buffers_(buffers),
+          input_pointers_(input_pointers),
+          output_pointers_(output_pointers) {
+        for (const auto& alias : aliases_.inputs) {
+            channel_pointer(input_pointers_, alias.bus, alias.channel) =
+                buffers_.input_channel_ptr<void>(alias.source_bus,
+                                                 alias.source_channel);
+        }
+        for (const auto& alias : aliases_.outputs) {
+            channel_pointer(output_pointers_, alias.bus, alias.channel) =
+                buffers_.output_channel_ptr<void>(alias.source_bus,
+                                                  alias.source_channel);
+        }
+    }
+
+    ~ScopedAudioChannelAliases() noexcept {
+        for (const auto& alias : aliases_.inputs) {
+            channel_pointer(input_pointers_, alias.bus, alias.channel) =
+                buffers_.input_channel_ptr<void>(alias.bus, alias.channel);
+        }
+        for (const auto& alias : aliases_.outputs) {
+            channel_pointer(output_pointers_, alias.bus, alias.channel) =
+                buffers_.output_channel_ptr<void>(alias.bus, alias.channel);
+        }
+    }
+
+    ScopedAudioChannelAliases(const ScopedAudioChannelAliases&) = delete;
+    ScopedAudioChannelAliases& operator=(const ScopedAudioChannelAliases&) =
+        delete;
+
+   private:
+    static void*& channel_pointer(std::vector<void*>& pointers,
+                                  [[maybe_unused]] uint32_t bus,
+                                  uint32_t channel) noexcept {
+        assert(bus == 0 && channel < pointers.size());
+        return pointers[channel];
+    }
+
+    static void*& channel_pointer(std::vector<std::vector<void*>>& pointers,
+                                  uint32_t bus,
+                                  uint32_t channel) noexcept {
+        assert(bus < pointers.size() && channel < pointers[bus].size());
+        return pointers[bus][channel];
+    }
+
+    const AudioChannelAliases& aliases_;
+    AudioShmBuffer& buffers_;
+    Pointers& input_pointers_;
+    Pointers& output_pointers_;
+};
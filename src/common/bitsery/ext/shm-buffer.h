@@ -0,0 +1,271 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+#include <mutex>
+#include <random>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <bitsery/details/serialization_common.h>
+#include <bitsery/traits/core/traits.h>
+
+namespace bitsery {
+namespace ext {
+
+/**
+ * Buffers of at least this many bytes will be transferred through a shared
+ * memory object when serialized with `bitsery::ext::ShmBuffer`. Below this size
+ * the overhead of creating and mapping the object outweighs the cost of sending
+ * the data over the socket.
+ */
+constexpr size_t shm_buffer_threshold = 1 << 20;
+
+/**
+ * Shared memory objects created by `ShmBuffer` that have not been read by the
+ * other side after this long are unlinked by the side that created them. The
+ * other side reads these objects as soon as the message containing them
+ * arrives, so this only happens when that side crashed, or when sending the
+ * message failed.
+ */
+constexpr std::chrono::minutes shm_buffer_timeout(5);
+
+/**
+ * Keeps track of the shared memory objects created by `ShmBuffer` in this
+ * process, so they can be unlinked if the other side never reads them. Objects
+ * older than `shm_buffer_timeout` are unlinked whenever a new object gets
+ * created, and any remaining objects are unlinked when the library gets
+ * unloaded. Unlinking an object the other side already read and unlinked does
+ * nothing since the names are random.
+ */
+class PendingShmObjects {
+   public:
+    static PendingShmObjects& instance() {
+        static PendingShmObjects pending_objects;
+        return pending_objects;
+    }
+
+    ~PendingShmObjects() noexcept {
+        std::lock_guard lock(mutex_);
+        for (const auto& [name, created_at] : objects_) {
+            shm_unlink(name.c_str());
+        }
+    }
+
+    /**
+     * Start tracking a newly created object, and unlink any objects that have
+     * timed out.
+     */
+    void add(std::string name) {
+        const auto now = std::chrono::steady_clock::now();
+
+        std::lock_guard lock(mutex_);
+        std::erase_if(objects_, [&](const auto& object) {
+            const auto& [name, created_at] = object;
+            if (now - created_at > shm_buffer_timeout) {
+                shm_unlink(name.c_str());
+                return true;
+            } else {
+                return false;
+            }
+        });
+
+        objects_.emplace_back(std::move(name), now);
+    }
+
+   private:
+    PendingShmObjects() = default;
+
+    std::mutex mutex_;
+    std::vector<
+        std::pair<std::string, std::chrono::steady_clock::time_point>>
+        objects_;
+};
+
+/**
+ * An adapter for serializing large binary buffers, such as plugin state. The
+ * buffer is written to a new POSIX shared memory object and only that object's
+ * name and size are serialized. The receiving side then copies the data
+ * straight from the shared memory object into the target buffer, after which
+ * the object is unlinked again. This avoids copying hundreds of megabytes of
+ * preset data into the serialization buffers on both sides and then pushing all
+ * of that through the socket, and it also means that these buffers are not
+ * bound by the maximum size used for regular serialization. Buffers smaller
+ * than `shm_buffer_threshold` are serialized normally.
+ *
+ * If the receiving side never reads the object, for instance because it
+ * crashed, then the sending side will unlink it after `shm_buffer_timeout`. See
+ * `PendingShmObjects`. The names are prefixed with `yabridge-state-` so they're
+ * easy to identify.
+ */
+class ShmBuffer {
+   public:
+    /**
+     * @param max_size The maximum size for buffers that are serialized
+     *   normally. Buffers transferred through shared memory don't have this
+     *   limit.
+     */
+    explicit ShmBuffer(size_t max_size) : max_size_(max_size) {}
+
+    template <typename Ser, typename Fnc>
+    void serialize(Ser& ser,
+                   const std::vector<uint8_t>& buffer,
+                   Fnc&&) const {
+        // If we cannot create the shared memory object for whatever reason,
+        // then we'll still try to send the buffer over the socket
+        std::string shm_name;
+        const bool use_shm = buffer.size() >= shm_buffer_threshold &&
+                             write_shm_object(buffer, shm_name);
+
+        ser.boolValue(use_shm);
+        if (use_shm) {
+            ser.text1b(shm_name, 1024);
+            ser.value8b(static_cast<uint64_t>(buffer.size()));
+        } else {
+            ser.container1b(buffer, max_size_);
+        }
+    }
+
+    template <typename Des, typename Fnc>
+    void deserialize(Des& des, std::vector<uint8_t>& buffer, Fnc&&) const {
+        bool use_shm{};
+        des.boolValue(use_shm);
+        if (use_shm) {
+            std::string shm_name;
+            uint64_t size;
+            des.text1b(shm_name, 1024);
+            des.value8b(size);
+
+            read_shm_object(shm_name, size, buffer);
+        } else {
+            des.container1b(buffer, max_size_);
+        }
+    }
+
+   private:
+    /**
+     * Create a new uniquely named shared memory object and copy `buffer` to
+     * it. Returns false and leaves nothing behind if this failed.
+     *
+     * The names contain a random suffix rather than a counter, since every
+     * yabridge library loaded into the same process would otherwise use the
+     * same names.
+     */
+    static bool write_shm_object(const std::vector<uint8_t>& buffer,
+                                 std::string& shm_name) {
+        constexpr char alphanumeric_characters[] =
+            "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+        constexpr int max_attempts = 8;
+
+        thread_local std::mt19937 rng(std::random_device{}());
+        int fd = -1;
+        for (int attempt = 0; attempt < max_attempts && fd == -1; attempt++) {
+            std::string random_id;
+            std::sample(alphanumeric_characters,
+                        alphanumeric_characters +
+                            sizeof(alphanumeric_characters) - 1,
+                        std::back_inserter(random_id), 16, rng);
+            shm_name = "/yabridge-state-" + std::to_string(getpid()) + "-" +
+                       random_id;
+
+            fd = shm_open(shm_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+            if (fd == -1 && errno != EEXIST) {
+                return false;
+            }
+        }
+        if (fd == -1) {
+            return false;
+        }
+
+        void* data = MAP_FAILED;
+        if (ftruncate(fd, static_cast<off_t>(buffer.size())) == 0) {
+            data = mmap(nullptr, buffer.size(), PROT_READ | PROT_WRITE,
+                        MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (data == MAP_FAILED) {
+            shm_unlink(shm_name.c_str());
+            return false;
+        }
+
+        std::memcpy(data, buffer.data(), buffer.size());
+        munmap(data, buffer.size());
+
+        PendingShmObjects::instance().add(shm_name);
+
+        return true;
+    }
+
+    /**
+     * Copy the contents of a shared memory object created by
+     * `write_shm_object()` into `buffer`, and then unlink the object.
+     *
+     * @throw std::system_error If the object could not be opened or mapped.
+     */
+    static void read_shm_object(const std::string& shm_name,
+                                size_t size,
+                                std::vector<uint8_t>& buffer) {
+        const int fd = shm_open(shm_name.c_str(), O_RDONLY, 0);
+        if (fd == -1) {
+            throw std::system_error(
+                std::error_code(errno, std::system_category()),
+                "Could not open shared memory object " + shm_name);
+        }
+
+        // Nothing else will open this object, so it can be unlinked right away
+        shm_unlink(shm_name.c_str());
+
+        void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED) {
+            throw std::system_error(
+                std::error_code(errno, std::system_category()),
+                "Could not map shared memory object " + shm_name);
+        }
+
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        buffer.assign(bytes, bytes + size);
+        munmap(data, size);
+    }
+
+    size_t max_size_;
+};
+
+}  // namespace ext
+
+namespace traits {
+
+template <>
+struct ExtensionTraits<ext::ShmBuffer, std::vector<uint8_t>> {
+    using TValue = void;
+    static constexpr bool SupportValueOverload = false;
+    static constexpr bool SupportObjectOverload = true;
+    static constexpr bool SupportLambdaOverload = false;
+};
+
+}  // namespace traits
+}  // namespace bitsery
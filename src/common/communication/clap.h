@@ -283,6 +283,26 @@ class ClapSockets final : public Sockets {
         }
     }
 
+    /**
+     * Let the messages sent over the primary audio thread control socket for an
+     * instance use the control block of that instance's shared memory audio
+     * buffers. Both sides should call this after setting up the audio buffers
+     * in `clap_plugin::activate()`, and the Wine plugin host side needs to do
+     * this first.
+     *
+     * @param instance_id The object instance identifier of the socket.
+     * @param shm The instance's audio buffers, or a null pointer to stop using
+     *   them.
+     *
+     * @see AdHocSocketHandler::set_shm_buffer
+     */
+    void set_audio_thread_shm_buffer(size_t instance_id, AudioShmBuffer* shm) {
+        std::lock_guard lock(audio_thread_sockets_mutex_);
+        if (audio_thread_sockets_.contains(instance_id)) {
+            audio_thread_sockets_.at(instance_id).control_.set_shm_buffer(shm);
+        }
+    }
+
     /**
      * Send a message from the native plugin to the Wine plugin host to handle
      * an audio thread function call. Since those functions are called from a
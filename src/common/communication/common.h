@@ -19,6 +19,7 @@
 #include <iostream>
 #include <mutex>
 #include <variant>
+#include <vector>
 
 #include <bitsery/adapter/buffer.h>
 #include <bitsery/bitsery.h>
@@ -34,9 +35,13 @@
 #include <asio/write.hpp>
 #include <ghc/filesystem.hpp>
 
+#include "../audio-shm.h"
 #include "../bitsery/traits/small-vector.h"
 #include "../logging/common.h"
+#include "../logging/trace.h"
+#include "../probes.h"
 #include "../utils.h"
+#include "stats.h"
 
 // Our input and output adapters for binary serialization always expect the data
 // to be encoded in little endian format. This should not make any difference
@@ -117,27 +122,136 @@ inline ASIO_MUTABLE_BUFFER buffer(llvm::SmallVectorImpl<PodType>& data,
 }  // namespace asio
 
 /**
- * Serialize an object using bitsery and write it to a socket. This will write
- * both the size of the serialized object and the object itself over the socket.
+ * Serialize an object using bitsery and write it to the control block of an
+ * `AudioShmBuffer`. This is used as an alternative to `write_object()` for
+ * audio processing requests and their responses when the
+ * `futex_audio_signalling` option is enabled. The other side should be
+ * signalled separately.
+ *
+ * @param shm The shared memory object to write to.
+ * @param object The object to write to the control block.
+ * @param buffer The buffer to serialize into before the object gets copied to
+ *   the control block.
+ *
+ * @return Whether the object fit in the control block. If this returns false,
+ *   then the object should be sent over a socket instead.
+ *
+ * @relates read_shm_object
+ */
+template <typename T>
+inline bool write_shm_object(AudioShmBuffer& shm,
+                             const T& object,
+                             SerializationBufferBase& buffer) {
+    const size_t size =
+        bitsery::quickSerialization<OutputAdapter<SerializationBufferBase>>(
+            buffer, object);
+    if (size > AudioShmBuffer::control_payload_capacity()) [[unlikely]] {
+        return false;
+    }
+
+    std::copy_n(buffer.begin(), size, shm.control_payload());
+    shm.set_control_payload_size(static_cast<uint32_t>(size));
+
+    return true;
+}
+
+/**
+ * Deserialize an object written to an `AudioShmBuffer`'s control block using
+ * `write_shm_object()`. The object is read directly from shared memory.
+ *
+ * @param shm The shared memory object to read from.
+ * @param object The object to deserialize into.
+ *
+ * @return The deserialized object.
+ *
+ * @throw std::runtime_error If the conversion to an object was not successful.
+ *
+ * @relates write_shm_object
+ */
+template <typename T>
+inline T& read_shm_object(const AudioShmBuffer& shm, T& object) {
+    // `SerializationBufferBase`'s iterators are plain pointers, so we can use
+    // the same adapter to read directly from the shared memory region
+    auto [_, success] =
+        bitsery::quickDeserialization<InputAdapter<SerializationBufferBase>>(
+            {shm.control_payload(), shm.control_payload_size()}, object);
+
+    if (!success) [[unlikely]] {
+        throw std::runtime_error("Deserialization failure in call: " +
+                                 std::string(__PRETTY_FUNCTION__));
+    }
+
+    return object;
+}
+
+/**
+ * When this bit is set in the length prefix written by
+ * `write_object_via_shm()`, then the serialized object was written to the
+ * control block of an `AudioShmBuffer` instead of being sent over the socket.
+ * The other bits still contain the object's size. Objects are never anywhere
+ * near large enough for this to clash with a real size.
+ */
+constexpr uint64_t shm_message_flag = 1ull << 63;
+
+/**
+ * Serialize an object using bitsery and write it to a socket, or to the control
+ * block of an `AudioShmBuffer`. If `shm` is set and the serialized object fits
+ * in its control block, then we'll copy the object there and only send the
+ * length prefix with `shm_message_flag` set over the socket. That prefix acts
+ * as a doorbell for the other side, who can then deserialize the object
+ * directly from shared memory. This saves the kernel from having to copy the
+ * object into and out of the socket buffer, which adds up when done several
+ * times per processing cycle for every plugin instance. Objects that don't fit
+ * are sent over the socket like normal.
  *
  * @param socket The Asio socket to write to.
  * @param object The object to write to the stream.
  * @param buffer The buffer to write to. This is useful for sending audio and
  *   chunk data since that can vary in size by a lot.
+ * @param shm The shared memory object whose control block we may use, or a null
+ *   pointer if the object should always be sent over the socket. The other
+ *   side must read the object using the same shared memory object, and only a
+ *   single message may be in flight using the same control block.
+ * @param message_size If set, the size of the serialized object is written
+ *   here. Used for the statistics enabled with `YABRIDGE_STATS`.
+ *
+ * @return Whether the object was written to the control block.
  *
  * @warning This operation is not atomic, and calling this function with the
  *   same socket from multiple threads at once will cause issues with the
  *   packets arriving out of order.
  *
- * @relates read_object
+ * @relates read_object_via_shm
  */
 template <typename T, typename Socket>
-inline void write_object(Socket& socket,
-                         const T& object,
-                         SerializationBufferBase& buffer) {
+inline bool write_object_via_shm(Socket& socket,
+                                 const T& object,
+                                 SerializationBufferBase& buffer,
+                                 AudioShmBuffer* shm,
+                                 size_t* message_size = nullptr) {
     const size_t size =
         bitsery::quickSerialization<OutputAdapter<SerializationBufferBase>>(
             buffer, object);
+    if (message_size) {
+        *message_size = size;
+    }
+
+    // NOTE: Bitsery's adapters for fixed size buffers don't do any bounds
+    //       checking when `CheckAdapterErrors` is disabled, so we can't
+    //       serialize directly into the control block. The resulting copy is
+    //       much cheaper than the two copies the kernel would have to make
+    //       otherwise though.
+    if (shm && size <= AudioShmBuffer::control_payload_capacity()) {
+        std::copy_n(buffer.begin(), size, shm->control_payload());
+        shm->set_control_payload_size(static_cast<uint32_t>(size));
+        std::atomic_thread_fence(std::memory_order_release);
+
+        asio::write(socket, asio::buffer(std::array<uint64_t, 1>{
+                                size | shm_message_flag}));
+        YABRIDGE_PROBE(write_object, size, 1);
+
+        return true;
+    }
 
     // Tell the other side how large the object is so it can prepare a buffer
     // large enough before sending the data
@@ -150,49 +264,87 @@ inline void write_object(Socket& socket,
     const size_t bytes_written =
         asio::write(socket, asio::buffer(buffer, size));
     assert(bytes_written == size);
-}
+    YABRIDGE_PROBE(write_object, size, 0);
 
-/**
- * `write_object()` with a small default buffer for convenience.
- *
- * @overload
- */
-template <typename T, typename Socket>
-inline void write_object(Socket& socket, const T& object) {
-    SerializationBuffer<256> buffer{};
-    write_object(socket, object, buffer);
+    return false;
 }
 
 /**
- * Deserialize an object by reading it from a socket. This should be used
- * together with `write_object`. This will block until the object is available.
+ * Deserialize an object sent using `write_object_via_shm()`. If the length
+ * prefix indicates that the object was written to the control block of `shm`,
+ * then we'll deserialize the object directly from shared memory. Otherwise the
+ * object is read from the socket. This will block until the object is
+ * available. If the plugin is rendering offline, then we'll briefly poll the
+ * socket before blocking. See `AudioShmBuffer::spin_until()`.
  *
  * @param socket The Asio socket to read from.
- * @param object The object to serialize into. There are also overrides that
- *   create a new default initialized `T`
+ * @param object The object to serialize into.
  * @param buffer The buffer to read into. This is useful for sending audio and
  *   chunk data since that can vary in size by a lot.
+ * @param shm The shared memory object the other side may have written the
+ *   object to, or a null pointer if no shared memory object is available.
+ * @param message_size If set, the size of the serialized object is written
+ *   here. Used for the statistics enabled with `YABRIDGE_STATS`.
  *
- * @return The deserialized object.
+ * @return Whether the object was read from the control block. When responding
+ *   to a request, this can be used to only write the response to the control
+ *   block when the other side also used it for the request. At that point we
+ *   know that the other side will be able to read it.
  *
- * @throw std::runtime_error If the conversion to an object was not successful.
+ * @throw std::runtime_error If the conversion to an object was not successful,
+ *   or if the object was written to a control block while `shm` is a null
+ *   pointer.
  * @throw std::system_error If the socket is closed or gets closed
  *   while reading.
  *
- * @relates write_object
+ * @relates write_object_via_shm
  */
 template <typename T, typename Socket>
-inline T& read_object(Socket& socket,
-                      T& object,
-                      SerializationBufferBase& buffer) {
+inline bool read_object_via_shm(Socket& socket,
+                                T& object,
+                                SerializationBufferBase& buffer,
+                                const AudioShmBuffer* shm,
+                                size_t* message_size = nullptr) {
+    // While rendering offline the other side will likely respond within a few
+    // microseconds, so we'll poll the socket for a bit before blocking on it
+    if (shm) {
+        shm->spin_until([&]() {
+            asio::error_code err;
+            return socket.available(err) > 0 || err;
+        });
+    }
+
     // See the note above on the use of `uint64_t` instead of `size_t`
     std::array<uint64_t, 1> message_length;
     asio::read(socket, asio::buffer(message_length),
                asio::transfer_exactly(sizeof(message_length)));
 
+    if (message_length[0] & shm_message_flag) {
+        if (!shm) [[unlikely]] {
+            throw std::runtime_error(
+                "Received a shared memory message without a shared memory "
+                "object in call: " +
+                std::string(__PRETTY_FUNCTION__));
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        assert(shm->control_payload_size() ==
+               (message_length[0] & ~shm_message_flag));
+        read_shm_object(*shm, object);
+        if (message_size) {
+            *message_size = message_length[0] & ~shm_message_flag;
+        }
+        YABRIDGE_PROBE(read_object, message_length[0] & ~shm_message_flag, 1);
+
+        return true;
+    }
+
     // Make sure the buffer is large enough
     const size_t size = message_length[0];
     buffer.resize(size);
+    if (message_size) {
+        *message_size = size;
+    }
 
     // `asio::read/write` will handle all the packet splitting and
     // merging for us, since local domain sockets have packet limits somewhere
@@ -207,6 +359,67 @@ inline T& read_object(Socket& socket,
         throw std::runtime_error("Deserialization failure in call: " +
                                  std::string(__PRETTY_FUNCTION__));
     }
+    YABRIDGE_PROBE(read_object, size, 0);
+
+    return false;
+}
+
+/**
+ * Serialize an object using bitsery and write it to a socket. This will write
+ * both the size of the serialized object and the object itself over the socket.
+ *
+ * @param socket The Asio socket to write to.
+ * @param object The object to write to the stream.
+ * @param buffer The buffer to write to. This is useful for sending audio and
+ *   chunk data since that can vary in size by a lot.
+ *
+ * @warning This operation is not atomic, and calling this function with the
+ *   same socket from multiple threads at once will cause issues with the
+ *   packets arriving out of order.
+ *
+ * @relates read_object
+ */
+template <typename T, typename Socket>
+inline void write_object(Socket& socket,
+                         const T& object,
+                         SerializationBufferBase& buffer) {
+    write_object_via_shm(socket, object, buffer, nullptr);
+}
+
+/**
+ * `write_object()` with a small default buffer for convenience.
+ *
+ * @overload
+ */
+template <typename T, typename Socket>
+inline void write_object(Socket& socket, const T& object) {
+    SerializationBuffer<256> buffer{};
+    write_object(socket, object, buffer);
+}
+
+/**
+ * Deserialize an object by reading it from a socket. This should be used
+ * together with `write_object`. This will block until the object is available.
+ *
+ * @param socket The Asio socket to read from.
+ * @param object The object to serialize into. There are also overrides that
+ *   create a new default initialized `T`
+ * @param buffer The buffer to read into. This is useful for sending audio and
+ *   chunk data since that can vary in size by a lot.
+ *
+ * @return The deserialized object.
+ *
+ * @throw std::runtime_error If the conversion to an object was not successful.
+ * @throw std::system_error If the socket is closed or gets closed
+ *   while reading.
+ *
+ * @relates write_object
+ */
+template <typename T, typename Socket>
+inline T& read_object(Socket& socket,
+                      T& object,
+                      SerializationBufferBase& buffer) {
+    read_object_via_shm(socket, object, buffer, nullptr);
 
     return object;
 }
@@ -403,11 +616,37 @@ class SocketHandler {
     }
 
     /**
-     * Serialize an object and send it over the socket.
+     * The socket's underlying file descriptor. Used to check whether the other
+     * side is still alive when we're not blocking on the socket itself.
+     */
+    int native_handle() { return socket_.native_handle(); }
+
+    /**
+     * Let `send()` and `receive_single()` calls that pass an explicit buffer
+     * use the control block of this shared memory object instead of sending
+     * the serialized object over the socket. See `write_object_via_shm()` for
+     * more information. Both sides of the socket need to attach the same
+     * shared memory object before it gets used. Unless this socket handler gets
+     * destroyed first, the object needs to be detached by passing a null
+     * pointer before the object itself is destroyed.
+     *
+     * @param shm The shared memory object to use, or a null pointer to always
+     *   send objects over the socket.
+     */
+    void set_shm_buffer(AudioShmBuffer* shm) noexcept {
+        shm_buffer_.store(shm, std::memory_order_release);
+    }
+
+    /**
+     * Serialize an object and send it over the socket. If a shared memory
+     * object has been attached using `set_shm_buffer()`, then the object may be
+     * written there instead.
      *
      * @param object The object to send.
      * @param buffer The buffer to use for the serialization. This is used to
      *   prevent excess allocations when sending audio.
+     * @param message_size If set, the size of the serialized object is written
+     *   here.
      *
      * @throw std::system_error If the socket is closed or gets closed
      *   during sending.
@@ -422,8 +661,12 @@ class SocketHandler {
      * @see SocketHandler::receive_multi
      */
     template <typename T>
-    inline void send(const T& object, SerializationBufferBase& buffer) {
-        write_object(socket_, object, buffer);
+    inline void send(const T& object,
+                     SerializationBufferBase& buffer,
+                     size_t* message_size = nullptr) {
+        write_object_via_shm(socket_, object, buffer,
+                             shm_buffer_.load(std::memory_order_acquire),
+                             message_size);
     }
 
     /**
@@ -444,6 +687,8 @@ class SocketHandler {
      *   create a new default initialized `T`
      * @param buffer The buffer to read into. This is useful for sending audio
      *   and chunk data since that can vary in size by a lot.
+     * @param message_size If set, the size of the serialized object is written
+     *   here.
      *
      * @return The deserialized object.
      *
@@ -466,8 +711,14 @@ class SocketHandler {
      * @see SocketHandler::receive_multi
      */
     template <typename T>
-    inline T& receive_single(T& object, SerializationBufferBase& buffer) {
-        return read_object<T>(socket_, object, buffer);
+    inline T& receive_single(T& object,
+                             SerializationBufferBase& buffer,
+                             size_t* message_size = nullptr) {
+        read_object_via_shm(socket_, object, buffer,
+                            shm_buffer_.load(std::memory_order_acquire),
+                            message_size);
+
+        return object;
     }
 
     /**
@@ -525,8 +776,40 @@ class SocketHandler {
      * connection.
      */
     std::optional<asio::local::stream_protocol::acceptor> acceptor_;
+
+    /**
+     * The shared memory object set through `set_shm_buffer()`, if any.
+     */
+    std::atomic<AudioShmBuffer*> shm_buffer_ = nullptr;
 };
 
+/**
+ * Counters for how often `AdHocSocketHandler::send()` had to fall back to a
+ * secondary socket, summed over every socket handler in this process. When
+ * `new_connections` keeps increasing then there are regularly more concurrent
+ * requests than there are idle secondary connections, and the pool has been
+ * exhausted. These are reported together with the process timings when
+ * `YABRIDGE_DEBUG_LEVEL` contains `+timing`.
+ */
+struct AdHocSocketPoolStats {
+    /**
+     * The number of requests sent over an idle connection from the pool.
+     */
+    std::atomic_uint64_t reused_connections = 0;
+    /**
+     * The number of new connections that had to be made because there were no
+     * idle connections left.
+     */
+    std::atomic_uint64_t new_connections = 0;
+    /**
+     * The number of connections that were closed after use because the pool
+     * was already full.
+     */
+    std::atomic_uint64_t discarded_connections = 0;
+};
+
+inline AdHocSocketPoolStats adhoc_socket_pool_stats;
+
 /**
  * There are situations where we can not know in advance how many sockets we
  * need. The main example of this are VST2 `dispatcher()` and `audioMaster()`
@@ -546,6 +829,14 @@ class SocketHandler {
  *   socket instead. On the listening side the new connection will be accepted,
  *   and a newly spawned thread will handle incoming connection just like it
  *   would for the primary socket.
+ * - Since connecting to the socket and spawning a thread for every one of these
+ *   requests adds up when for instance the host and the plugin are both making
+ *   lots of calls from different threads, the sending side will keep up to
+ *   `max_idle_secondary_sockets` of those additional connections around after
+ *   they have been used. These idle connections will be reused for the next
+ *   requests that can't use the primary socket. The listening side's thread
+ *   for that connection will keep handling requests until the connection gets
+ *   closed. Usage of this pool is tracked in `adhoc_socket_pool_stats`.
  *
  * @tparam Thread The thread implementation to use. On the Linux side this
  *   should be `std::jthread` and on the Wine side this should be `Win32Thread`.
@@ -570,7 +861,12 @@ class AdHocSocketHandler {
     AdHocSocketHandler(asio::io_context& io_context,
                        asio::local::stream_protocol::endpoint endpoint,
                        bool listen)
-        : io_context_(io_context), endpoint_(endpoint), socket_(io_context) {
+        : trace_category_(
+              ghc::filesystem::path(endpoint.path()).stem().string()),
+          stats_(SocketStats::for_endpoint(endpoint.path())),
+          io_context_(io_context),
+          endpoint_(endpoint),
+          socket_(io_context) {
         if (listen) {
             ghc::filesystem::create_directories(
                 ghc::filesystem::path(endpoint.path()).parent_path());
@@ -610,6 +906,13 @@ class AdHocSocketHandler {
                          err);
         socket_.close();
 
+        // This will also terminate the threads handling these connections on
+        // the other side
+        {
+            std::lock_guard lock(idle_secondary_sockets_mutex_);
+            idle_secondary_sockets_.clear();
+        }
+
         while (currently_listening_) {
             // If another thread is currently calling `receive_multi()`, we'll
             // spinlock until that function has exited. We would otherwise get a
@@ -617,7 +920,57 @@ class AdHocSocketHandler {
         }
     }
 
+    /**
+     * Let messages sent over the primary socket use the control block of this
+     * shared memory object instead of sending the serialized objects over the
+     * socket. See `write_object_via_shm()` for more information. Since only a
+     * single message can be in flight on the primary socket at any given time,
+     * the control block will never be used concurrently. Messages sent over
+     * secondary sockets will always be sent over those sockets. Both sides of
+     * the socket need to attach the same shared memory object. Unless this
+     * socket handler gets destroyed first, the object needs to be detached by
+     * passing a null pointer before the object itself is destroyed.
+     *
+     * @param shm The shared memory object to use, or a null pointer to always
+     *   send objects over the socket.
+     */
+    void set_shm_buffer(AudioShmBuffer* shm) noexcept {
+        shm_buffer_.store(shm, std::memory_order_release);
+    }
+
    protected:
+    /**
+     * Get the shared memory object that may be used for messages sent over
+     * `socket`. This returns a null pointer for secondary sockets, and for the
+     * primary socket if no shared memory object has been attached.
+     *
+     * @see AdHocSocketHandler::set_shm_buffer
+     */
+    AudioShmBuffer* shm_buffer_for(
+        const asio::local::stream_protocol::socket& socket) const noexcept {
+        return &socket == &socket_
+                   ? shm_buffer_.load(std::memory_order_acquire)
+                   : nullptr;
+    }
+
+    /**
+     * The name of this socket's endpoint without the extension, e.g.
+     * `host_plugin_dispatch`. This is used as the category for the events
+     * recorded when `YABRIDGE_TRACE_FILE` is set.
+     *
+     * @see TraceRecorder
+     */
+    const std::string trace_category_;
+
+    /**
+     * Live statistics for this socket, served by the native plugin when
+     * `YABRIDGE_STATS` is set. This is a null pointer if statistics are not
+     * enabled, and it's always a null pointer on the Wine side.
+     *
+     * @see BridgeStats
+     */
+    const std::shared_ptr<SocketStats> stats_;
+
     /**
      * Serialize and send an event over a socket. This is used for both the host
      * -> plugin 'dispatch' events and the plugin -> host 'audioMaster' host
@@ -625,11 +978,11 @@ class AdHocSocketHandler {
      * for details on the parameters and return value of this function.
      *
      * As described above, if this function is currently being called from
-     * another thread, then this will create a new socket connection and send
-     * the event there instead.
+     * another thread, then this will send the event over an idle secondary
+     * socket connection, or over a new connection if there are none.
      *
      * @param callback A function that will be called with a reference to a
-     *   socket. This is either the primary `socket`, or a new ad hock socket if
+     *   socket. This is either the primary `socket`, or a secondary socket if
      *   this function is currently being called from another thread.
      */
     template <std::invocable<asio::local::stream_protocol::socket&> F>
@@ -642,10 +995,6 @@ class AdHocSocketHandler {
         constexpr bool returns_void = std::is_void_v<
             std::invoke_result_t<F, asio::local::stream_protocol::socket&>>;
 
-        // XXX: Maybe at some point we should benchmark how often this
-        //      ad hoc socket spawning mechanism gets used. If some hosts
-        //      for instance consistently and repeatedly trigger this then
-        //      we might be able to do some optimizations there.
         std::unique_lock lock(write_mutex_, std::try_to_lock);
         if (lock.owns_lock()) {
             // This was used to always block when sending the first message,
@@ -662,11 +1011,20 @@ class AdHocSocketHandler {
             }
         } else {
             try {
-                asio::local::stream_protocol::socket secondary_socket(
-                    io_context_);
-                secondary_socket.connect(endpoint_);
+                // If the callback throws then the connection will be in an
+                // unknown state, so it will be closed instead of being
+                // returned to the pool
+                asio::local::stream_protocol::socket secondary_socket =
+                    acquire_secondary_socket();
+                if constexpr (returns_void) {
+                    callback(secondary_socket);
+                    release_secondary_socket(std::move(secondary_socket));
+                } else {
+                    auto result = callback(secondary_socket);
+                    release_secondary_socket(std::move(secondary_socket));
 
-                return callback(secondary_socket);
+                    return result;
+                }
             } catch (const std::system_error&) {
                 // So, what do we do when noone is listening on the endpoint
                 // yet? This can happen with plugin groups when the Wine
@@ -740,36 +1098,54 @@ class AdHocSocketHandler {
         acceptor_.emplace(secondary_context, endpoint_);
 
         // This works the exact same was as `active_plugins` and
-        // `next_plugin_id` in `GroupBridge`
-        std::unordered_map<size_t, Thread> active_secondary_requests{};
+        // `next_plugin_id` in `GroupBridge`. The sockets are stored alongside
+        // the threads so we can shut them down when the primary socket closes.
+        // NOTE: The thread has to be declared after the socket so it gets
+        //       joined before the socket is destroyed
+        struct SecondaryConnection {
+            std::optional<asio::local::stream_protocol::socket> socket;
+            Thread thread;
+        };
+        std::unordered_map<size_t, SecondaryConnection>
+            active_secondary_requests{};
         std::atomic_size_t next_request_id{};
         std::mutex active_secondary_requests_mutex{};
         accept_requests(
             *acceptor_, logger,
             [&](asio::local::stream_protocol::socket secondary_socket) {
                 const size_t request_id = next_request_id.fetch_add(1);
+                if (stats_) {
+                    stats_->record_secondary_socket();
+                }
 
-                // We have to make sure to keep moving these sockets into the
-                // threads that will handle them
                 std::lock_guard lock(active_secondary_requests_mutex);
-                active_secondary_requests[request_id] = Thread(
-                    [&, request_id](
-                        asio::local::stream_protocol::socket secondary_socket) {
-                        secondary_callback(secondary_socket);
-
-                        // When we have processed this request, we'll join the
-                        // thread again with the thread that's handling
-                        // `secondary_context`
-                        asio::post(secondary_context, [&, request_id]() {
-                            std::lock_guard lock(
-                                active_secondary_requests_mutex);
-
-                            // The join is implicit because we're using
-                            // `std::jthread`/`Win32Thread`
-                            active_secondary_requests.erase(request_id);
-                        });
-                    },
-                    std::move(secondary_socket));
+                SecondaryConnection& connection =
+                    active_secondary_requests[request_id];
+                connection.socket.emplace(std::move(secondary_socket));
+                connection.thread = Thread([&, request_id,
+                                            &socket = *connection.socket]() {
+                    // The other side keeps idle connections around to reuse
+                    // them for later requests, so we'll keep handling requests
+                    // until the connection gets closed
+                    while (true) {
+                        try {
+                            secondary_callback(socket);
+                        } catch (const std::system_error&) {
+                            break;
+                        }
+                    }
+
+                    // When the connection has been closed, we'll join the
+                    // thread again with the thread that's handling
+                    // `secondary_context`
+                    asio::post(secondary_context, [&, request_id]() {
+                        std::lock_guard lock(active_secondary_requests_mutex);
+
+                        // The join is implicit because we're using
+                        // `std::jthread`/`Win32Thread`
+                        active_secondary_requests.erase(request_id);
+                    });
+                });
             });
 
         Thread secondary_requests_handler([&]() {
@@ -800,6 +1176,14 @@ class AdHocSocketHandler {
         secondary_context.stop();
         acceptor_.reset();
 
+        // Idle connections from the other side's pool would otherwise keep
+        // their threads alive
+        for (auto& [_, connection] : active_secondary_requests) {
+            std::error_code err;
+            connection.socket->shutdown(
+                asio::local::stream_protocol::socket::shutdown_both, err);
+        }
+
         currently_listening_ = false;
     }
 
@@ -816,6 +1200,53 @@ class AdHocSocketHandler {
     }
 
    private:
+    /**
+     * Take an idle secondary socket connection from the pool, or connect a new
+     * one if the pool is empty.
+     *
+     * @throw std::system_error If nobody is listening on the endpoint.
+     */
+    asio::local::stream_protocol::socket acquire_secondary_socket() {
+        {
+            std::lock_guard lock(idle_secondary_sockets_mutex_);
+            if (!idle_secondary_sockets_.empty()) {
+                asio::local::stream_protocol::socket secondary_socket =
+                    std::move(idle_secondary_sockets_.back());
+                idle_secondary_sockets_.pop_back();
+                adhoc_socket_pool_stats.reused_connections.fetch_add(
+                    1, std::memory_order_relaxed);
+
+                return secondary_socket;
+            }
+        }
+
+        asio::local::stream_protocol::socket secondary_socket(io_context_);
+        secondary_socket.connect(endpoint_);
+        adhoc_socket_pool_stats.new_connections.fetch_add(
+            1, std::memory_order_relaxed);
+        if (stats_) {
+            stats_->record_secondary_socket();
+        }
+
+        return secondary_socket;
+    }
+
+    /**
+     * Return a secondary socket connection after it has been used so it can be
+     * reused by the next request. If the pool is already full, then the
+     * connection will be closed instead.
+     */
+    void release_secondary_socket(
+        asio::local::stream_protocol::socket secondary_socket) {
+        std::lock_guard lock(idle_secondary_sockets_mutex_);
+        if (idle_secondary_sockets_.size() < max_idle_secondary_sockets) {
+            idle_secondary_sockets_.push_back(std::move(secondary_socket));
+        } else {
+            adhoc_socket_pool_stats.discarded_connections.fetch_add(
+                1, std::memory_order_relaxed);
+        }
+    }
+
     /**
      * Used in `receive_multi()` to asynchronously listen for secondary socket
      * connections. After `callback()` returns this function will continue to be
@@ -843,6 +1274,7 @@ class AdHocSocketHandler {
                         logger->get().log(
                             "Failure while accepting connections: " +
                             error.message());
+                        logger->get().flush();
                     }
 
                     return;
@@ -900,6 +1332,28 @@ class AdHocSocketHandler {
      * this fallback behaviour should only happen during initialization.
      */
     std::atomic_bool sent_first_event_ = false;
+
+    /**
+     * The maximum number of idle secondary socket connections we'll keep
+     * around. Each of these also has a thread on the listening side. This is
+     * plenty for the handful of threads hosts and plugins make concurrent
+     * calls from.
+     */
+    static constexpr size_t max_idle_secondary_sockets = 4;
+
+    /**
+     * Secondary socket connections that have been used for a request in
+     * `send()` and that can be reused for the next request.
+     *
+     * @see AdHocSocketHandler::acquire_secondary_socket
+     */
+    std::vector<asio::local::stream_protocol::socket> idle_secondary_sockets_;
+    std::mutex idle_secondary_sockets_mutex_;
+
+    /**
+     * The shared memory object set through `set_shm_buffer()`, if any.
+     */
+    std::atomic<AudioShmBuffer*> shm_buffer_ = nullptr;
 };
 
 /**
@@ -1003,8 +1457,6 @@ class TypedMessageHandler : public AdHocSocketHandler<Thread> {
         typename T::Response& response_object,
         std::optional<std::pair<LoggerImpl&, bool>> logging,
         SerializationBufferBase& buffer) {
-        using TResponse = typename T::Response;
-
         // Since a lot of messages just return a `tresult`, we can't filter out
         // responses based on the response message type. Instead, we'll just
         // only print the responses when the request was not filtered out.
@@ -1029,10 +1481,33 @@ class TypedMessageHandler : public AdHocSocketHandler<Thread> {
         // messages from arriving out of order. `AdHocSocketHandler::send()`
         // will either use a long-living primary socket, or if that's currently
         // in use it will spawn a new socket for us.
-        this->send([&](asio::local::stream_protocol::socket& socket) {
-            write_object(socket, Request(object), buffer);
-            read_object<TResponse>(socket, response_object, buffer);
-        });
+        {
+            const ScopedTrace trace(trace_type_name<T>(),
+                                    this->trace_category_,
+                                    trace_instance_id(object), false);
+            const auto start = this->stats_
+                                   ? std::chrono::steady_clock::now()
+                                   : std::chrono::steady_clock::time_point{};
+
+            MessageSizes sizes{};
+            this->send([&](asio::local::stream_protocol::socket& socket) {
+                // If a shared memory object has been attached and we're using
+                // the primary socket, then the request and the response may be
+                // passed through its control block instead
+                AudioShmBuffer* shm = this->shm_buffer_for(socket);
+
+                write_object_via_shm(socket, Request(object), buffer, shm,
+                                     &sizes.request);
+                read_object_via_shm(socket, response_object, buffer, shm,
+                                    &sizes.response);
+            });
+
+            if (this->stats_) {
+                this->stats_->record_sent(
+                    trace_type_name<T>(), sizes,
+                    std::chrono::steady_clock::now() - start);
+            }
+        }
 
 #pragma GCC diagnostic pop
 
@@ -1114,12 +1589,27 @@ class TypedMessageHandler : public AdHocSocketHandler<Thread> {
                 //       used for audio thread messages
                 thread_local SerializationBuffer<256> persistent_buffer{};
                 thread_local Request persistent_object;
+                SerializationBuffer<256> local_buffer{};
+                SerializationBufferBase& buffer =
+                    persistent_buffers ? persistent_buffer : local_buffer;
+
+                // The audio thread sockets that use persistent buffers can
+                // also receive requests through a shared memory object's
+                // control block. We'll only write the response there if the
+                // request was also written there, since that means the other
+                // side has attached the same shared memory object. This
+                // matters when the object gets attached while handling a
+                // request.
+                AudioShmBuffer* shm = nullptr;
+                if constexpr (persistent_buffers) {
+                    shm = this->shm_buffer_for(socket);
+                }
+
+                MessageSizes sizes{};
+                const bool request_in_shm = read_object_via_shm(
+                    socket, persistent_object, buffer, shm, &sizes.request);
 
-                auto& request =
-                    persistent_buffers
-                        ? read_object<Request>(socket, persistent_object,
-                                               persistent_buffer)
-                        : read_object<Request>(socket, persistent_object);
+                auto& request = persistent_object;
 
                 // See the comment in `receive_into()` for more information
                 bool should_log_response = false;
@@ -1142,17 +1632,24 @@ class TypedMessageHandler : public AdHocSocketHandler<Thread> {
                 // type, and we can scrap a lot of boilerplate elsewhere.
                 std::visit(
                     [&]<typename T>(T object) {
+                        std::optional<ScopedTrace> trace(
+                            std::in_place, trace_type_name<T>(),
+                            this->trace_category_, trace_instance_id(object),
+                            true);
                         typename T::Response response = callback(object);
+                        trace.reset();
 
                         if (should_log_response) {
                             auto [logger, is_host_plugin] = *logging;
                             logger.log_response(!is_host_plugin, response);
                         }
 
-                        if constexpr (persistent_buffers) {
-                            write_object(socket, response, persistent_buffer);
-                        } else {
-                            write_object(socket, response);
+                        write_object_via_shm(socket, response, buffer,
+                                             request_in_shm ? shm : nullptr,
+                                             &sizes.response);
+                        if (this->stats_) {
+                            this->stats_->record_handled(trace_type_name<T>(),
+                                                         sizes);
                         }
                     },
                     // See above
@@ -0,0 +1,260 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "stats.h"
+
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
+
+#include <unistd.h>
+
+namespace fs = ghc::filesystem;
+
+/**
+ * Statistics are only collected when this environment variable is set to a
+ * non-empty value.
+ */
+constexpr char stats_environment_variable[] = "YABRIDGE_STATS";
+
+/**
+ * Escape a string for use in a JSON string literal.
+ */
+static std::string json_escape(std::string_view input) {
+    std::ostringstream escaped;
+    for (const char c : input) {
+        switch (c) {
+            case '"':
+                escaped << "\\\"";
+                break;
+            case '\\':
+                escaped << "\\\\";
+                break;
+            case '\n':
+                escaped << "\\n";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    escaped << "\\u" << std::hex << std::setw(4)
+                            << std::setfill('0') << static_cast<int>(c)
+                            << std::dec;
+                } else {
+                    escaped << c;
+                }
+                break;
+        }
+    }
+
+    return escaped.str();
+}
+
+/**
+ * Format a histogram summary as a JSON object with the durations in
+ * microseconds.
+ */
+static void write_summary(std::ostream& stream,
+                          const LatencyHistogram::Summary& summary) {
+    const auto microseconds = [](std::chrono::nanoseconds duration) {
+        return static_cast<double>(duration.count()) / 1000.0;
+    };
+
+    stream << R"({"count":)" << summary.count << R"(,"p50_us":)"
+           << microseconds(summary.p50) << R"(,"p99_us":)"
+           << microseconds(summary.p99) << R"(,"max_us":)"
+           << microseconds(summary.max) << "}";
+}
+
+BridgeStats::BridgeStats(fs::path base_dir) : base_dir(std::move(base_dir)) {}
+
+std::shared_ptr<BridgeStats> BridgeStats::get(const fs::path& base_dir) {
+#ifdef __WINE__
+    return nullptr;
+#else
+    // NOLINTNEXTLINE(concurrency-mt-unsafe)
+    static const bool enabled = []() {
+        const char* value = getenv(stats_environment_variable);
+        return value && *value != '\0';
+    }();
+    if (!enabled) {
+        return nullptr;
+    }
+
+    static std::mutex registry_mutex;
+    static std::unordered_map<std::string, std::weak_ptr<BridgeStats>>
+        registry;
+
+    std::lock_guard lock(registry_mutex);
+    std::erase_if(registry,
+                  [](const auto& entry) { return entry.second.expired(); });
+
+    std::weak_ptr<BridgeStats>& entry = registry[base_dir.string()];
+    std::shared_ptr<BridgeStats> stats = entry.lock();
+    if (!stats) {
+        stats = std::make_shared<BridgeStats>(base_dir);
+        entry = stats;
+    }
+
+    return stats;
+#endif
+}
+
+std::shared_ptr<SocketStats> BridgeStats::add_socket(std::string name) {
+    // The socket needs to keep this object alive, but this object should not
+    // keep the socket alive
+    auto socket =
+        std::make_shared<SocketStats>(shared_from_this(), std::move(name));
+
+    std::lock_guard lock(sockets_mutex_);
+    std::erase_if(sockets_, [](const auto& socket) { return socket.expired(); });
+    sockets_.push_back(socket);
+
+    return socket;
+}
+
+std::string BridgeStats::to_json(
+    const std::vector<std::pair<std::string_view, std::string>>& plugin_info)
+    const {
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(1);
+
+    json << R"({"pid":)" << getpid() << R"(,"plugin":{)";
+    bool first = true;
+    for (const auto& [key, value] : plugin_info) {
+        json << (first ? "" : ",") << '"' << key << R"(":")"
+             << json_escape(value) << '"';
+        first = false;
+    }
+
+    json << R"(},"round_trips":{"audio_thread":)";
+    write_summary(json, audio_thread_round_trips.summarize());
+    json << R"(,"main_thread":)";
+    write_summary(json, main_thread_round_trips.summarize());
+
+    // The audio buffers and other shared memory objects for this bridge are
+    // all prefixed with the name of the socket base directory
+    json << R"(},"shared_memory":[)";
+    const std::string shm_prefix = base_dir.filename().string();
+    std::error_code err;
+    first = true;
+    for (const auto& entry : fs::directory_iterator("/dev/shm", err)) {
+        const std::string name = entry.path().filename().string();
+        if (name != shm_prefix && !name.starts_with(shm_prefix + "-")) {
+            continue;
+        }
+
+        json << (first ? "" : ",") << R"({"name":")" << json_escape(name)
+             << R"(","bytes":)" << entry.file_size(err) << "}";
+        first = false;
+    }
+
+    json << R"(],"sockets":[)";
+    std::lock_guard lock(sockets_mutex_);
+    first = true;
+    for (const auto& weak_socket : sockets_) {
+        const std::shared_ptr<SocketStats> socket = weak_socket.lock();
+        if (!socket) {
+            continue;
+        }
+
+        json << (first ? "" : ",") << R"({"name":")"
+             << json_escape(socket->name) << R"(","secondary_sockets":)"
+             << socket->secondary_sockets.load(std::memory_order_relaxed)
+             << R"(,"requests":[)";
+        first = false;
+
+        bool first_request = true;
+        for (const auto& counters : socket->requests()) {
+            json << (first_request ? "" : ",") << R"({"type":")"
+                 << json_escape(counters.type) << R"(","sent":)"
+                 << counters.sent << R"(,"handled":)" << counters.handled
+                 << R"(,"bytes_sent":)" << counters.bytes_sent
+                 << R"(,"bytes_received":)" << counters.bytes_received << "}";
+            first_request = false;
+        }
+
+        json << "]}";
+    }
+    json << "]}\n";
+
+    return json.str();
+}
+
+SocketStats::SocketStats(std::shared_ptr<BridgeStats> bridge, std::string name)
+    : name(std::move(name)),
+      audio_thread(this->name.find("audio") != std::string::npos ||
+                   this->name.find("process") != std::string::npos),
+      bridge_(std::move(bridge)) {
+    requests_.reserve(64);
+}
+
+std::shared_ptr<SocketStats> SocketStats::for_endpoint(
+    const std::string& endpoint) {
+    const fs::path endpoint_path(endpoint);
+    if (std::shared_ptr<BridgeStats> bridge =
+            BridgeStats::get(endpoint_path.parent_path())) {
+        return bridge->add_socket(endpoint_path.stem().string());
+    } else {
+        return nullptr;
+    }
+}
+
+void SocketStats::record_sent(
+    std::string_view type,
+    const MessageSizes& sizes,
+    std::chrono::steady_clock::duration round_trip) {
+    if (audio_thread) {
+        bridge_->audio_thread_round_trips.record(round_trip);
+    } else {
+        bridge_->main_thread_round_trips.record(round_trip);
+    }
+
+    std::lock_guard lock(requests_mutex_);
+    RequestCounters& counters = counters_for(type);
+    counters.sent++;
+    counters.bytes_sent += sizes.request;
+    counters.bytes_received += sizes.response;
+}
+
+void SocketStats::record_handled(std::string_view type,
+                                 const MessageSizes& sizes) {
+    std::lock_guard lock(requests_mutex_);
+    RequestCounters& counters = counters_for(type);
+    counters.handled++;
+    counters.bytes_received += sizes.request;
+    counters.bytes_sent += sizes.response;
+}
+
+void SocketStats::record_secondary_socket() noexcept {
+    secondary_sockets.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<SocketStats::RequestCounters> SocketStats::requests() const {
+    std::lock_guard lock(requests_mutex_);
+    return requests_;
+}
+
+SocketStats::RequestCounters& SocketStats::counters_for(std::string_view type) {
+    // The names point to static storage, so comparing the pointers is enough
+    // in the common case
+    for (auto& counters : requests_) {
+        if (counters.type.data() == type.data() || counters.type == type) {
+            return counters;
+        }
+    }
+
+    return requests_.emplace_back(RequestCounters{.type = type});
+}
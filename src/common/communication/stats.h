@@ -0,0 +1,226 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <ghc/filesystem.hpp>
+
+#include "../latency-histogram.h"
+
+/**
+ * The name of the socket the native plugin listens on for statistics requests,
+ * relative to the bridge's socket base directory.
+ */
+constexpr char stats_socket_name[] = "stats.sock";
+
+/**
+ * The sizes of a serialized request and its response in bytes. When an object
+ * was passed through a shared memory object's control block, this is the size
+ * of the object in that control block.
+ */
+struct MessageSizes {
+    size_t request = 0;
+    size_t response = 0;
+};
+
+class SocketStats;
+
+/**
+ * Live statistics for all of the sockets belonging to a single bridge, i.e. to
+ * a single `Sockets` base directory. These are only collected on the native
+ * plugin side, and only when the `YABRIDGE_STATS` environment variable is set.
+ * The native plugin will then serve a JSON snapshot of these statistics on
+ * `<base_dir>/stats.sock` for `yabridgectl stats` to pick up.
+ *
+ * The socket handlers find the object for their bridge through the socket's
+ * base directory, so they don't need to know anything about the bridge they
+ * belong to.
+ */
+class BridgeStats : public std::enable_shared_from_this<BridgeStats> {
+   public:
+    BridgeStats(ghc::filesystem::path base_dir);
+
+    /**
+     * Get or create the statistics object for the bridge using `base_dir` as
+     * its socket base directory. Returns a null pointer when statistics are
+     * not enabled, and always returns a null pointer in the Wine plugin host.
+     * The returned object lives for as long as someone holds on to it.
+     */
+    static std::shared_ptr<BridgeStats> get(
+        const ghc::filesystem::path& base_dir);
+
+    /**
+     * Create a new statistics object for a socket in this bridge. The socket
+     * will be included in the snapshots for as long as the returned object is
+     * alive.
+     *
+     * @param name The socket endpoint's name without the extension, e.g.
+     *   `host_plugin_dispatch`.
+     */
+    std::shared_ptr<SocketStats> add_socket(std::string name);
+
+    /**
+     * Format a snapshot of these statistics as a JSON object. This also lists
+     * the sizes of this bridge's shared memory objects in `/dev/shm`.
+     *
+     * @param plugin_info Additional string fields to include in the `plugin`
+     *   object, such as the plugin's path.
+     */
+    std::string to_json(
+        const std::vector<std::pair<std::string_view, std::string>>&
+            plugin_info) const;
+
+    const ghc::filesystem::path base_dir;
+
+    /**
+     * Round trip times for requests sent over one of the audio thread sockets.
+     *
+     * @see SocketStats::audio_thread
+     */
+    LatencyHistogram audio_thread_round_trips;
+    /**
+     * Round trip times for requests sent over any other socket. These are
+     * mostly made from the GUI thread.
+     */
+    LatencyHistogram main_thread_round_trips;
+
+   private:
+    mutable std::mutex sockets_mutex_;
+    std::vector<std::weak_ptr<SocketStats>> sockets_;
+};
+
+/**
+ * Counters for a single socket endpoint, including any secondary connections
+ * made to it. Recording a message only briefly locks a mutex, and it only
+ * allocates the first time a request type is sent or handled on this socket.
+ *
+ * @see BridgeStats
+ */
+class SocketStats {
+   public:
+    /**
+     * Counters for a single request type.
+     */
+    struct RequestCounters {
+        /**
+         * The name of the request type. This points to static storage, see
+         * `trace_type_name()`.
+         */
+        std::string_view type;
+        /**
+         * The number of requests of this type we sent to the other side.
+         */
+        uint64_t sent = 0;
+        /**
+         * The number of requests of this type the other side sent to us.
+         */
+        uint64_t handled = 0;
+        /**
+         * The number of bytes sent, including the responses to requests we
+         * handled.
+         */
+        uint64_t bytes_sent = 0;
+        /**
+         * The number of bytes received, including the responses to requests
+         * we sent.
+         */
+        uint64_t bytes_received = 0;
+    };
+
+    SocketStats(std::shared_ptr<BridgeStats> bridge, std::string name);
+
+    /**
+     * Create a statistics object for a socket handler listening on or
+     * connecting to `endpoint`. This is a convenience wrapper around
+     * `BridgeStats::get()` and `BridgeStats::add_socket()`, and it also
+     * returns a null pointer when statistics are not enabled.
+     */
+    static std::shared_ptr<SocketStats> for_endpoint(
+        const std::string& endpoint);
+
+    /**
+     * Record a request we sent to the other side, along with the time it took
+     * to receive the response.
+     *
+     * @param type The name of the request type. This must have static storage
+     *   duration.
+     */
+    void record_sent(std::string_view type,
+                     const MessageSizes& sizes,
+                     std::chrono::steady_clock::duration round_trip);
+
+    /**
+     * Record a request the other side sent to us.
+     *
+     * @param type The name of the request type. This must have static storage
+     *   duration.
+     */
+    void record_handled(std::string_view type, const MessageSizes& sizes);
+
+    /**
+     * Record that `AdHocSocketHandler` had to make or accept an additional
+     * connection because the primary socket was already in use.
+     */
+    void record_secondary_socket() noexcept;
+
+    /**
+     * Copy the current per request type counters.
+     */
+    std::vector<RequestCounters> requests() const;
+
+    /**
+     * The socket endpoint's name without the extension.
+     */
+    const std::string name;
+
+    /**
+     * Whether this is one of the sockets used for audio processing. The round
+     * trip times for these sockets are tracked separately from the other
+     * sockets. This is based on the socket's name, so on the VST3 audio
+     * processor sockets this also includes a handful of non-realtime
+     * functions like `IAudioProcessor::setupProcessing()`.
+     */
+    const bool audio_thread;
+
+    /**
+     * The number of secondary connections made or accepted for this socket.
+     *
+     * @see SocketStats::record_secondary_socket
+     */
+    std::atomic_uint64_t secondary_sockets = 0;
+
+   private:
+    /**
+     * Find or insert the counters for a request type. `requests_mutex_` must
+     * be locked.
+     */
+    RequestCounters& counters_for(std::string_view type);
+
+    std::shared_ptr<BridgeStats> bridge_;
+
+    mutable std::mutex requests_mutex_;
+    std::vector<RequestCounters> requests_;
+};
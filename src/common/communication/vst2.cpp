@@ -73,7 +73,12 @@ intptr_t DefaultDataConverter::return_value(const int /*opcode*/,
 Vst2EventResult DefaultDataConverter::send_event(
     asio::local::stream_protocol::socket& socket,
     const Vst2Event& event,
-    SerializationBufferBase& buffer) const {
-    write_object(socket, event, buffer);
-    return read_object<Vst2EventResult>(socket, buffer);
+    SerializationBufferBase& buffer,
+    MessageSizes& sizes) const {
+    write_object_via_shm(socket, event, buffer, nullptr, &sizes.request);
+
+    Vst2EventResult response;
+    read_object_via_shm(socket, response, buffer, nullptr, &sizes.response);
+
+    return response;
 }
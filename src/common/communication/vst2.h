@@ -84,11 +84,15 @@ class DefaultDataConverter {
      * the event over the socket, and then wait for the response to be sent
      * back. This can be overridden to use `MutualRecursionHelper::fork()` for
      * specific opcodes to allow mutually recursive calling sequences.
+     *
+     * @param sizes The sizes of the serialized event and its response will be
+     *   written here for the statistics enabled with `YABRIDGE_STATS`.
      */
     virtual Vst2EventResult send_event(
         asio::local::stream_protocol::socket& socket,
         const Vst2Event& event,
-        SerializationBufferBase& buffer) const;
+        SerializationBufferBase& buffer,
+        MessageSizes& sizes) const;
 };
 
 /**
@@ -134,13 +138,18 @@ class Vst2EventHandler : public AdHocSocketHandler<Thread> {
      * @param listen If `true`, start listening on the sockets. Incoming
      *   connections will be accepted when `connect()` gets called. This should
      *   be set to `true` on the plugin side, and `false` on the Wine host side.
+     * @param is_dispatch Whether this socket handles `dispatch()` events or
+     *   host callbacks. This is only used to look up opcode names for the
+     *   events recorded when `YABRIDGE_TRACE_FILE` is set.
      *
      * @see Sockets::connect
      */
     Vst2EventHandler(asio::io_context& io_context,
                      asio::local::stream_protocol::endpoint endpoint,
-                     bool listen)
-        : AdHocSocketHandler<Thread>(io_context, endpoint, listen) {}
+                     bool listen,
+                     bool is_dispatch)
+        : AdHocSocketHandler<Thread>(io_context, endpoint, listen),
+          is_dispatch_(is_dispatch) {}
 
     /**
      * Serialize and send an event over a socket. This is used for both the host
@@ -205,11 +214,23 @@ class Vst2EventHandler : public AdHocSocketHandler<Thread> {
         // from the socket, so we can override this for specific function calls
         // that potentially need to have their responses handled on the same
         // calling thread (i.e. mutual recursion).
+        std::optional<ScopedTrace> trace(std::in_place, trace_name(opcode),
+                                         this->trace_category_, -1, false);
+        const auto start = this->stats_
+                               ? std::chrono::steady_clock::now()
+                               : std::chrono::steady_clock::time_point{};
+
+        MessageSizes sizes{};
         const Vst2EventResult response =
             this->send([&](asio::local::stream_protocol::socket& socket) {
-                return data_converter.send_event(socket, event,
-                                                 serialization_buffer());
+                return data_converter.send_event(
+                    socket, event, serialization_buffer(), sizes);
             });
+        trace.reset();
+        if (this->stats_) {
+            this->stats_->record_sent(trace_name(opcode), sizes,
+                                      std::chrono::steady_clock::now() - start);
+        }
 
         if (logging) {
             auto [logger, is_dispatch] = *logging;
@@ -254,7 +275,10 @@ class Vst2EventHandler : public AdHocSocketHandler<Thread> {
                 bool on_main_thread) {
                 SerializationBufferBase& buffer = serialization_buffer();
 
-                auto event = read_object<Vst2Event>(socket, buffer);
+                MessageSizes sizes{};
+                Vst2Event event;
+                read_object_via_shm(socket, event, buffer, nullptr,
+                                    &sizes.request);
                 if (logging) {
                     auto [logger, is_dispatch] = *logging;
                     logger.log_event(is_dispatch, event.opcode, event.index,
@@ -262,7 +286,11 @@ class Vst2EventHandler : public AdHocSocketHandler<Thread> {
                                      event.value_payload);
                 }
 
+                std::optional<ScopedTrace> trace(
+                    std::in_place, trace_name(event.opcode),
+                    this->trace_category_, -1, true);
                 Vst2EventResult response = callback(event, on_main_thread);
+                trace.reset();
                 if (logging) {
                     auto [logger, is_dispatch] = *logging;
                     logger.log_event_response(
@@ -270,7 +298,12 @@ class Vst2EventHandler : public AdHocSocketHandler<Thread> {
                         response.payload, response.value_payload);
                 }
 
-                write_object(socket, response, buffer);
+                write_object_via_shm(socket, response, buffer, nullptr,
+                                     &sizes.response);
+                if (this->stats_) {
+                    this->stats_->record_handled(trace_name(event.opcode),
+                                                 sizes);
+                }
             };
 
         this->receive_multi(
@@ -285,6 +318,18 @@ class Vst2EventHandler : public AdHocSocketHandler<Thread> {
     }
 
    private:
+    /**
+     * The name used for an event with this opcode in trace events and in the
+     * statistics enabled with `YABRIDGE_STATS`.
+     */
+    std::string_view trace_name(int opcode) const noexcept {
+        if (const auto name = opcode_to_string(is_dispatch_, opcode)) {
+            return *name;
+        } else {
+            return is_dispatch_ ? "dispatch()" : "audioMasterCallback()";
+        }
+    }
+
     /**
      * Unlike our VST3 implementation, in the VST2 implementation there's no
      * separation between potentially real time critical events that will be
@@ -315,6 +360,11 @@ class Vst2EventHandler : public AdHocSocketHandler<Thread> {
 
         return buffer;
     }
+
+    /**
+     * Whether this socket handles `dispatch()` events or host callbacks.
+     */
+    const bool is_dispatch_;
 };
 
 /**
@@ -353,11 +403,13 @@ class Vst2Sockets final : public Sockets {
           host_plugin_dispatch_(
               io_context,
               (base_dir_ / "host_plugin_dispatch.sock").string(),
-              listen),
+              listen,
+              true),
           plugin_host_callback_(
               io_context,
               (base_dir_ / "plugin_host_callback.sock").string(),
-              listen),
+              listen,
+              false),
           host_plugin_parameters_(
               io_context,
               (base_dir_ / "host_plugin_parameters.sock").string(),
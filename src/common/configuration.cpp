@@ -101,6 +101,12 @@ Configuration::Configuration(const fs::path& config_path,
                 } else {
                     invalid_options.emplace_back(key);
                 }
+            } else if (key == "disable_xrun_warnings") {
+                if (const auto parsed_value = value.as_boolean()) {
+                    disable_xrun_warnings = parsed_value->get();
+                } else {
+                    invalid_options.emplace_back(key);
+                }
             } else if (key == "editor_coordinate_hack") {
                 if (const auto parsed_value = value.as_boolean()) {
                     editor_coordinate_hack = parsed_value->get();
@@ -136,12 +142,30 @@ Configuration::Configuration(const fs::path& config_path,
                 } else {
                     invalid_options.emplace_back(key);
                 }
+            } else if (key == "futex_audio_signalling") {
+                if (const auto parsed_value = value.as_boolean()) {
+                    futex_audio_signalling = parsed_value->get();
+                } else {
+                    invalid_options.emplace_back(key);
+                }
             } else if (key == "hide_daw") {
                 if (const auto parsed_value = value.as_boolean()) {
                     hide_daw = parsed_value->get();
                 } else {
                     invalid_options.emplace_back(key);
                 }
+            } else if (key == "pipelined_processing") {
+                if (const auto parsed_value = value.as_boolean()) {
+                    pipelined_processing = parsed_value->get();
+                } else {
+                    invalid_options.emplace_back(key);
+                }
+            } else if (key == "vst2_parameter_cache") {
+                if (const auto parsed_value = value.as_boolean()) {
+                    vst2_parameter_cache = parsed_value->get();
+                } else {
+                    invalid_options.emplace_back(key);
+                }
             } else if (key == "vst3_prefer_32bit") {
                 if (const auto parsed_value = value.as_boolean()) {
                     vst3_prefer_32bit = parsed_value->get();
@@ -91,6 +91,15 @@ class Configuration {
      */
     std::optional<ghc::filesystem::path> disable_pipes;
 
+    /**
+     * Don't check whether audio processing cycles took longer than the host's
+     * buffer period, and don't print warnings about those cycles. The Wine
+     * plugin host will then also no longer measure how long the Windows
+     * plugin spends processing audio. Setting `+timing` in
+     * `YABRIDGE_DEBUG_LEVEL` overrides this.
+     */
+    bool disable_xrun_warnings = false;
+
     /**
      * If this is set to `true`, then the after every resize we will move the
      * embedded Wine window back to `(0, 0)` and then do the coordinate fixing
@@ -132,6 +141,17 @@ class Configuration {
      */
     std::optional<float> frame_rate;
 
+    /**
+     * If enabled, audio processing requests and their responses are exchanged
+     * through the control block in the plugin's `AudioShmBuffer` instead of
+     * through a Unix domain socket, and the native plugin and the Wine plugin
+     * host will wake each other up using a futex stored in that same shared
+     * memory region. This avoids a couple of system calls and socket copies
+     * per processing cycle. Requests that don't fit in the control block will
+     * still be sent over the socket. This currently only affects VST2 plugins.
+     */
+    bool futex_audio_signalling = false;
+
     /**
      * When this option is enabled, we'll report some random other string
      * instead of the actual name of the host when the plugin queries it. This
@@ -141,6 +161,17 @@ class Configuration {
      */
     bool hide_daw = false;
 
+    /**
+     * If enabled, the native plugin will send audio processing requests to the
+     * Wine plugin host without waiting for the results, and it will instead
+     * return the plugin's outputs from the previous processing cycle. This
+     * lets the host's audio thread and the Wine plugin host's audio thread do
+     * work at the same time, at the cost of adding one block of latency. That
+     * latency is reported to the host. This currently only affects VST2
+     * plugins.
+     */
+    bool pipelined_processing = false;
+
     /**
      * Disable `IPlugViewContentScaleSupport::setContentScaleFactor()`. Wine
      * does not properly implement fractional DPI scaling, so without this
@@ -152,6 +183,18 @@ class Configuration {
      */
     bool editor_disable_host_scaling = false;
 
+    /**
+     * Enable the shared memory parameter cache for VST2 plugins. With the cache
+     * enabled, `getParameter()` calls are answered directly on the native side
+     * using the last value the Wine plugin host has seen, and `setParameter()`
+     * calls no longer wait for the Windows plugin to finish handling them.
+     * Parameter names, labels, and display strings are also cached. This is
+     * opt-in because plugins that change their parameters without calling
+     * `audioMasterAutomate()` would otherwise cause the host to see outdated
+     * values.
+     */
+    bool vst2_parameter_cache = false;
+
     /**
      * If a merged bundle contains both the 64-bit and the 32-bit versions of a
      * Windows VST3 plugin (in the `x86_64-win` and the `x86-win` directories),
@@ -197,13 +240,17 @@ class Configuration {
 
         s.ext(disable_pipes, bitsery::ext::InPlaceOptional(),
               [](S& s, auto& v) { s.ext(v, bitsery::ext::GhcPath{}); });
+        s.value1b(disable_xrun_warnings);
         s.value1b(editor_coordinate_hack);
         s.value1b(editor_force_dnd);
         s.value1b(editor_xembed);
         s.ext(frame_rate, bitsery::ext::InPlaceOptional(),
               [](S& s, auto& v) { s.value4b(v); });
+        s.value1b(futex_audio_signalling);
         s.value1b(hide_daw);
+        s.value1b(pipelined_processing);
         s.value1b(editor_disable_host_scaling);
+        s.value1b(vst2_parameter_cache);
         s.value1b(vst3_prefer_32bit);
 
         s.ext(matched_file, bitsery::ext::InPlaceOptional(),
@@ -0,0 +1,52 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <ctime>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/**
+ * Block until the futex word no longer contains `expected`, or until the
+ * timeout expires. The word lives in a memory region shared between two
+ * processes, so we can't use `FUTEX_PRIVATE_FLAG` here.
+ *
+ * @return Whether the wait was ended because of a timeout.
+ */
+inline bool futex_wait(std::atomic<uint32_t>& word,
+                       uint32_t expected,
+                       const timespec* timeout) noexcept {
+    const long result =
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT,
+                expected, timeout, nullptr, 0);
+
+    return result == -1 && errno == ETIMEDOUT;
+}
+
+/**
+ * Wake up all threads waiting on a futex word.
+ */
+inline void futex_wake(std::atomic<uint32_t>& word) noexcept {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX,
+            nullptr, nullptr, 0);
+}
@@ -0,0 +1,120 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "latency-histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+void LatencyHistogram::record(
+    std::chrono::steady_clock::duration duration) noexcept {
+    const uint64_t nanoseconds = static_cast<uint64_t>(std::max<int64_t>(
+        0, std::chrono::duration_cast<std::chrono::nanoseconds>(duration)
+               .count()));
+
+    buckets_[bucket_index(nanoseconds)].fetch_add(1,
+                                                   std::memory_order_relaxed);
+
+    uint64_t current_max = max_nanoseconds_.load(std::memory_order_relaxed);
+    while (nanoseconds > current_max &&
+           !max_nanoseconds_.compare_exchange_weak(
+               current_max, nanoseconds, std::memory_order_relaxed)) {
+    }
+}
+
+LatencyHistogram::Summary LatencyHistogram::summarize_and_reset() noexcept {
+    std::array<uint64_t, num_buckets> counts;
+    for (size_t i = 0; i < num_buckets; i++) {
+        counts[i] = buckets_[i].exchange(0, std::memory_order_relaxed);
+    }
+
+    return summarize_counts(counts,
+                            std::chrono::nanoseconds(max_nanoseconds_.exchange(
+                                0, std::memory_order_relaxed)));
+}
+
+LatencyHistogram::Summary LatencyHistogram::summarize() const noexcept {
+    std::array<uint64_t, num_buckets> counts;
+    for (size_t i = 0; i < num_buckets; i++) {
+        counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    }
+
+    return summarize_counts(counts,
+                            std::chrono::nanoseconds(max_nanoseconds_.load(
+                                std::memory_order_relaxed)));
+}
+
+LatencyHistogram::Summary LatencyHistogram::summarize_counts(
+    const std::array<uint64_t, num_buckets>& counts,
+    std::chrono::nanoseconds max) noexcept {
+    Summary summary{};
+    for (const uint64_t count : counts) {
+        summary.count += count;
+    }
+    summary.max = max;
+
+    if (summary.count == 0) {
+        return summary;
+    }
+
+    // We'll report the lower bound of the bucket containing the percentile
+    const auto percentile = [&](double fraction) {
+        const uint64_t target = static_cast<uint64_t>(
+            std::ceil(fraction * static_cast<double>(summary.count)));
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < num_buckets; i++) {
+            seen += counts[i];
+            if (seen >= target) {
+                return std::chrono::nanoseconds(bucket_lower_bound(i));
+            }
+        }
+
+        return summary.max;
+    };
+
+    summary.p50 = percentile(0.5);
+    summary.p90 = percentile(0.9);
+    summary.p99 = percentile(0.99);
+
+    return summary;
+}
+
+size_t LatencyHistogram::bucket_index(uint64_t nanoseconds) noexcept {
+    // The first `num_sub_buckets` buckets store the values directly, after that
+    // every power of two gets `num_sub_buckets` equally sized buckets
+    if (nanoseconds < num_sub_buckets) {
+        return nanoseconds;
+    }
+
+    const size_t magnitude = 63 - __builtin_clzll(nanoseconds);
+    const size_t shift = magnitude - sub_bucket_bits;
+    const size_t index = ((shift + 1) * num_sub_buckets) +
+                         ((nanoseconds >> shift) & (num_sub_buckets - 1));
+
+    return std::min(index, num_buckets - 1);
+}
+
+uint64_t LatencyHistogram::bucket_lower_bound(size_t index) noexcept {
+    if (index < num_sub_buckets) {
+        return index;
+    }
+
+    const size_t shift = (index / num_sub_buckets) - 1;
+    const uint64_t sub_bucket = index % num_sub_buckets;
+
+    return (num_sub_buckets + sub_bucket) << shift;
+}
@@ -0,0 +1,88 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * A lock-free histogram for durations, used to keep track of how long audio
+ * processing takes. Values are stored in logarithmic buckets that are each
+ * split up into 16 linear sub-buckets (similar to HdrHistogram), so the values
+ * we can read back from this are accurate within about 6% regardless of the
+ * magnitude. Recording a value only takes a couple of relaxed atomic
+ * operations, so this is safe to use from the audio thread while another thread
+ * reads the histogram. This is used both for the process timings reported with
+ * `YABRIDGE_DEBUG_LEVEL=+timing` and for the round trip times reported through
+ * the statistics socket enabled with `YABRIDGE_STATS`.
+ */
+class LatencyHistogram {
+   public:
+    /**
+     * Summary statistics computed from the histogram.
+     */
+    struct Summary {
+        uint64_t count = 0;
+        std::chrono::nanoseconds p50{};
+        std::chrono::nanoseconds p90{};
+        std::chrono::nanoseconds p99{};
+        std::chrono::nanoseconds max{};
+    };
+
+    /**
+     * Add a duration to the histogram. This is realtime safe.
+     */
+    void record(std::chrono::steady_clock::duration duration) noexcept;
+
+    /**
+     * Compute summary statistics for all values recorded since the last call
+     * to this function, and then clear the histogram. Values recorded while
+     * this function is running may end up in either this summary or the next
+     * one.
+     */
+    Summary summarize_and_reset() noexcept;
+
+    /**
+     * Compute summary statistics for all values recorded so far without
+     * clearing the histogram.
+     */
+    Summary summarize() const noexcept;
+
+   private:
+    static constexpr size_t sub_bucket_bits = 4;
+    static constexpr size_t num_sub_buckets = 1 << sub_bucket_bits;
+    /**
+     * This covers durations of up to about 18 minutes. Anything longer ends up
+     * in the last bucket.
+     */
+    static constexpr size_t num_buckets = 38 * num_sub_buckets;
+
+    static size_t bucket_index(uint64_t nanoseconds) noexcept;
+    static uint64_t bucket_lower_bound(size_t index) noexcept;
+
+    /**
+     * Compute the summary statistics from a snapshot of the buckets.
+     */
+    static Summary summarize_counts(
+        const std::array<uint64_t, num_buckets>& counts,
+        std::chrono::nanoseconds max) noexcept;
+
+    std::array<std::atomic<uint64_t>, num_buckets> buckets_{};
+    std::atomic<uint64_t> max_nanoseconds_ = 0;
+};
@@ -309,6 +309,16 @@ bool ClapLogger::log_request(
     });
 }
 
+bool ClapLogger::log_request(
+    bool is_host_plugin,
+    const clap::ext::params::plugin::GetAllInfo& request) {
+    return log_request_base(is_host_plugin, [&](auto& message) {
+        message << request.instance_id
+                << ": clap_plugin_params::get_info() and "
+                   "clap_plugin_params::get_value() for all parameters";
+    });
+}
+
 bool ClapLogger::log_request(
     bool is_host_plugin,
     const clap::ext::params::plugin::ValueToText& request) {
@@ -868,6 +878,14 @@ void ClapLogger::log_response(
     });
 }
 
+void ClapLogger::log_response(
+    bool is_host_plugin,
+    const clap::ext::params::plugin::GetAllInfoResponse& response) {
+    log_response_base(is_host_plugin, [&](auto& message) {
+        message << "<" << response.infos.size() << " parameters>";
+    });
+}
+
 void ClapLogger::log_response(
     bool is_host_plugin,
     const clap::ext::params::plugin::ValueToTextResponse& response) {
@@ -122,6 +122,8 @@ class ClapLogger {
                      const clap::ext::params::plugin::GetInfo&);
     bool log_request(bool is_host_plugin,
                      const clap::ext::params::plugin::GetValue&);
+    bool log_request(bool is_host_plugin,
+                     const clap::ext::params::plugin::GetAllInfo&);
     bool log_request(bool is_host_plugin,
                      const clap::ext::params::plugin::ValueToText&);
     bool log_request(bool is_host_plugin,
@@ -213,6 +215,8 @@ class ClapLogger {
                       const clap::ext::params::plugin::GetInfoResponse&);
     void log_response(bool is_host_plugin,
                       const clap::ext::params::plugin::GetValueResponse&);
+    void log_response(bool is_host_plugin,
+                      const clap::ext::params::plugin::GetAllInfoResponse&);
     void log_response(bool is_host_plugin,
                       const clap::ext::params::plugin::ValueToTextResponse&);
     void log_response(bool is_host_plugin,
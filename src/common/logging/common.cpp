@@ -16,11 +16,27 @@
 
 #include "common.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <concepts>
+#include <cstring>
 #include <ctime>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <sstream>
+#include <string_view>
+#include <vector>
+
+#ifndef WITHOUT_ASIO
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#endif
 
 /**
  * The environment variable indicating whether to log to a file. Will log to
@@ -41,16 +57,459 @@ constexpr char logging_verbosity_environment_variable[] =
  */
 constexpr char editor_tracing_flag[] = "+editor";
 
+/**
+ * The `YABRIDGE_DEBUG_LEVEL` flag for periodically printing audio processing
+ * timing statistics.
+ */
+constexpr char process_timing_flag[] = "+timing";
+
+/**
+ * Write a single formatted log line to `stream`, optionally prefixed with a
+ * timestamp.
+ */
+static void write_log_line(std::ostream& stream,
+                           std::chrono::system_clock::time_point time,
+                           bool prefix_timestamp,
+                           const std::string& prefix,
+                           std::string_view message) {
+    if (prefix_timestamp) {
+        const time_t timestamp = std::chrono::system_clock::to_time_t(time);
+
+        // How did C++ manage to get time formatting libraries without a way to
+        // actually get a timestamp in a threadsafe way? `localtime_r` in C++ is
+        // not portable but luckily we only have to support GCC anyway.
+        std::tm tm;
+        localtime_r(&timestamp, &tm);
+
+        stream << std::put_time(&tm, "%T") << " ";
+    }
+
+    // We need to put the linefeed in the same string as the message rather
+    // writing it separately to the output stream to prevent two messages from
+    // being put on the same row
+    stream << prefix << message << '\n';
+}
+
+// The chainloaders only ever log fatal errors and they don't link against
+// pthreads, so they'll always log synchronously
+#ifndef WITHOUT_ASIO
+
+/**
+ * How often the background thread writes the buffered log messages to the
+ * output stream.
+ */
+constexpr std::chrono::milliseconds async_log_drain_interval(10);
+
+/**
+ * A lock-free single producer, single consumer ring buffer for log messages.
+ * Every thread that logs gets its own buffer per `AsyncLogWriter`. Messages are
+ * stored as a small header containing the time the message was logged and its
+ * length, followed by the message's text.
+ */
+class LogRingBuffer {
+   public:
+    /**
+     * The size of the buffer in bytes. This is enough for a couple hundred
+     * typical log messages, and the writer empties the buffer every
+     * `async_log_drain_interval`.
+     */
+    static constexpr size_t capacity = 1 << 16;
+
+    /**
+     * Messages longer than this are truncated so a single message can never
+     * take up the entire buffer.
+     */
+    static constexpr size_t max_message_size = capacity / 4;
+
+    /**
+     * Copy a message to the buffer. If there's no room left in the buffer, then
+     * the message is dropped and `dropped_messages` is incremented instead.
+     * This never blocks or allocates. Should only be called from the thread
+     * that owns this buffer.
+     */
+    void push(std::chrono::system_clock::time_point time,
+              std::string_view message) noexcept {
+        const RecordHeader header{
+            .time = time,
+            .size = static_cast<uint32_t>(
+                std::min(message.size(), max_message_size))};
+        const size_t record_size = sizeof(RecordHeader) + header.size;
+
+        const size_t write_pos = write_pos_.load(std::memory_order_relaxed);
+        const size_t read_pos = read_pos_.load(std::memory_order_acquire);
+        if (capacity - (write_pos - read_pos) < record_size) {
+            dropped_messages.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        copy_in(write_pos, &header, sizeof(RecordHeader));
+        copy_in(write_pos + sizeof(RecordHeader), message.data(), header.size);
+        write_pos_.store(write_pos + record_size, std::memory_order_release);
+    }
+
+    /**
+     * Call `fn` with the time and the text of every message currently in the
+     * buffer, and then remove those messages from the buffer. Should only be
+     * called from the writer thread.
+     */
+    template <std::invocable<std::chrono::system_clock::time_point,
+                             std::string> F>
+    void drain(F&& fn) {
+        size_t read_pos = read_pos_.load(std::memory_order_relaxed);
+        const size_t write_pos = write_pos_.load(std::memory_order_acquire);
+        while (read_pos < write_pos) {
+            RecordHeader header;
+            copy_out(read_pos, &header, sizeof(RecordHeader));
+
+            std::string message(header.size, '\0');
+            copy_out(read_pos + sizeof(RecordHeader), message.data(),
+                     header.size);
+            read_pos += sizeof(RecordHeader) + header.size;
+
+            fn(header.time, std::move(message));
+        }
+
+        read_pos_.store(read_pos, std::memory_order_release);
+    }
+
+    /**
+     * Whether the buffer is currently empty. Only meaningful on the writer
+     * thread.
+     */
+    bool empty() const noexcept {
+        return read_pos_.load(std::memory_order_relaxed) ==
+               write_pos_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * The number of messages that were dropped because the buffer was full.
+     * The writer resets this after reporting it.
+     */
+    std::atomic_uint64_t dropped_messages = 0;
+
+    /**
+     * Set when the `AsyncLogWriter` this buffer belongs to has been destroyed.
+     * The thread owning this buffer can then get rid of it.
+     */
+    std::atomic_bool writer_destroyed = false;
+
+   private:
+    struct RecordHeader {
+        std::chrono::system_clock::time_point time;
+        uint32_t size;
+    };
+
+    void copy_in(size_t pos, const void* data, size_t size) noexcept {
+        const size_t offset = pos % capacity;
+        const size_t first_part = std::min(size, capacity - offset);
+        std::memcpy(buffer_.data() + offset, data, first_part);
+        std::memcpy(buffer_.data(),
+                    static_cast<const uint8_t*>(data) + first_part,
+                    size - first_part);
+    }
+
+    void copy_out(size_t pos, void* data, size_t size) const noexcept {
+        const size_t offset = pos % capacity;
+        const size_t first_part = std::min(size, capacity - offset);
+        std::memcpy(data, buffer_.data() + offset, first_part);
+        std::memcpy(static_cast<uint8_t*>(data) + first_part, buffer_.data(),
+                    size - first_part);
+    }
+
+    std::array<uint8_t, capacity> buffer_;
+
+    // These are the total number of bytes written to and read from the buffer.
+    // Placing these on separate cache lines prevents the producer and the
+    // consumer from invalidating each other's caches.
+    alignas(64) std::atomic_size_t write_pos_ = 0;
+    alignas(64) std::atomic_size_t read_pos_ = 0;
+};
+
+/**
+ * Writes log messages on a background thread. Threads calling `Logger::log()`
+ * only copy the message and a timestamp to a thread local `LogRingBuffer`, and
+ * every `async_log_drain_interval` the writer thread empties those buffers,
+ * sorts the messages by the time they were logged, and then formats and writes
+ * them all at once. This means that logging from the audio thread no longer
+ * involves formatting timestamps, writing to a file, or flushing.
+ *
+ * Buffered messages are also written synchronously through `flush()` when a
+ * `Logger` gets destroyed or when we're about to exit after an error, and all
+ * writers are flushed from a `std::terminate()` handler so the last messages
+ * before a crash don't get lost. We don't install any signal handlers for
+ * this since flushing is not async-signal-safe, and Wine uses those signals
+ * for its own exception handling.
+ *
+ * NOTE: The first message a thread logs will allocate and register the thread's
+ *       ring buffer. Every message after that is lock-free and doesn't
+ *       allocate.
+ */
+class AsyncLogWriter {
+   public:
+    AsyncLogWriter(std::shared_ptr<std::ostream> stream,
+                   std::string prefix,
+                   bool prefix_timestamp)
+        : id_(next_id_.fetch_add(1)),
+          stream_(std::move(stream)),
+          prefix_(std::move(prefix)),
+          prefix_timestamp_(prefix_timestamp),
+          // This thread only writes to a stream, so this is also fine to use
+          // on the Wine side
+          writer_thread_([this](std::stop_token stop_token) {
+              std::mutex mutex;
+              std::condition_variable_any stopped;
+              std::unique_lock lock(mutex);
+              while (!stop_token.stop_requested()) {
+                  flush();
+                  stopped.wait_for(lock, stop_token, async_log_drain_interval,
+                                   []() { return false; });
+              }
+          }) {
+        static std::once_flag install_terminate_handler;
+        std::call_once(install_terminate_handler, []() {
+            previous_terminate_handler_ = std::set_terminate([]() {
+                flush_all();
+
+                if (previous_terminate_handler_) {
+                    previous_terminate_handler_();
+                }
+                std::abort();
+            });
+        });
+
+        std::lock_guard lock(live_writers_mutex_);
+        live_writers_.push_back(this);
+    }
+
+    AsyncLogWriter(const AsyncLogWriter&) = delete;
+    AsyncLogWriter& operator=(const AsyncLogWriter&) = delete;
+
+    /**
+     * Stop the writer thread and write any messages that are still buffered.
+     */
+    ~AsyncLogWriter() noexcept {
+        {
+            std::lock_guard lock(live_writers_mutex_);
+            std::erase(live_writers_, this);
+        }
+
+        writer_thread_.request_stop();
+        writer_thread_.join();
+        flush();
+
+        std::lock_guard lock(ring_buffers_mutex_);
+        for (const auto& ring_buffer : ring_buffers_) {
+            ring_buffer->writer_destroyed = true;
+        }
+    }
+
+    /**
+     * Copy a message to the calling thread's ring buffer. It will be written
+     * within `async_log_drain_interval`.
+     */
+    void push(std::string_view message) {
+        thread_ring_buffer().push(std::chrono::system_clock::now(), message);
+    }
+
+    /**
+     * Write all buffered messages to the output stream right now, blocking
+     * until they have been written. This is called periodically from the
+     * writer thread, but it can also be called from any other thread.
+     */
+    void flush() noexcept {
+        try {
+            std::lock_guard lock(write_mutex_);
+            write_pending_messages();
+        } catch (...) {
+            // There's nothing we can do here if writing the log fails
+        }
+    }
+
+    /**
+     * Flush every writer that's currently alive. This is used right before the
+     * process gets terminated. Since this may be called from a terminate
+     * handler while the same thread is already holding one of these locks,
+     * writers that are busy are skipped instead of waiting for them.
+     */
+    static void flush_all() noexcept {
+        std::unique_lock writers_lock(live_writers_mutex_, std::try_to_lock);
+        if (!writers_lock.owns_lock()) {
+            return;
+        }
+
+        for (AsyncLogWriter* writer : live_writers_) {
+            std::unique_lock write_lock(writer->write_mutex_, std::try_to_lock);
+            if (write_lock.owns_lock()) {
+                try {
+                    writer->write_pending_messages();
+                } catch (...) {
+                }
+            }
+        }
+    }
+
+   private:
+    struct PendingMessage {
+        std::chrono::system_clock::time_point time;
+        std::string text;
+    };
+
+    /**
+     * Get or create the calling thread's ring buffer for this writer.
+     */
+    LogRingBuffer& thread_ring_buffer() {
+        // Writers are identified by a unique ID rather than by their address
+        // since a new writer may be allocated at a destroyed writer's address
+        thread_local std::unordered_map<size_t, std::shared_ptr<LogRingBuffer>>
+            ring_buffers;
+        if (const auto ring_buffer = ring_buffers.find(id_);
+            ring_buffer != ring_buffers.end()) {
+            return *ring_buffer->second;
+        }
+
+        std::erase_if(ring_buffers, [](const auto& entry) {
+            return entry.second->writer_destroyed.load();
+        });
+
+        auto ring_buffer = std::make_shared<LogRingBuffer>();
+        {
+            std::lock_guard lock(ring_buffers_mutex_);
+            ring_buffers_.push_back(ring_buffer);
+        }
+
+        return *ring_buffers.emplace(id_, std::move(ring_buffer))
+                    .first->second;
+    }
+
+    /**
+     * Empty all ring buffers and write their messages to the output stream.
+     * `write_mutex_` must be held while calling this.
+     */
+    void write_pending_messages() {
+        std::vector<std::shared_ptr<LogRingBuffer>> ring_buffers;
+        {
+            std::lock_guard lock(ring_buffers_mutex_);
+
+            // Buffers for threads that have exited only need to be emptied one
+            // last time
+            std::erase_if(ring_buffers_, [](const auto& ring_buffer) {
+                return ring_buffer.use_count() == 1 && ring_buffer->empty() &&
+                       ring_buffer->dropped_messages == 0;
+            });
+            ring_buffers = ring_buffers_;
+        }
+
+        uint64_t dropped_messages = 0;
+        pending_messages_.clear();
+        for (const auto& ring_buffer : ring_buffers) {
+            ring_buffer->drain([&](std::chrono::system_clock::time_point time,
+                                   std::string text) {
+                pending_messages_.push_back(
+                    PendingMessage{.time = time, .text = std::move(text)});
+            });
+            dropped_messages += ring_buffer->dropped_messages.exchange(0);
+        }
+
+        if (pending_messages_.empty() && dropped_messages == 0) {
+            return;
+        }
+
+        // Messages from different threads should still be printed in order
+        std::stable_sort(
+            pending_messages_.begin(), pending_messages_.end(),
+            [](const auto& a, const auto& b) { return a.time < b.time; });
+
+        std::ostringstream formatted_messages;
+        for (const auto& message : pending_messages_) {
+            write_log_line(formatted_messages, message.time, prefix_timestamp_,
+                           prefix_, message.text);
+        }
+        if (dropped_messages > 0) {
+            write_log_line(formatted_messages, std::chrono::system_clock::now(),
+                           prefix_timestamp_, prefix_,
+                           "[logger] Dropped " +
+                               std::to_string(dropped_messages) +
+                               " message(s) because the log buffer was full");
+        }
+
+        *stream_ << formatted_messages.str() << std::flush;
+    }
+
+    static inline std::atomic_size_t next_id_ = 0;
+    const size_t id_;
+
+    /**
+     * Every writer that's currently alive, so `flush_all()` can write their
+     * buffered messages when the process is about to be terminated.
+     */
+    static inline std::vector<AsyncLogWriter*> live_writers_;
+    static inline std::mutex live_writers_mutex_;
+    static inline std::terminate_handler previous_terminate_handler_ = nullptr;
+
+    std::shared_ptr<std::ostream> stream_;
+    const std::string prefix_;
+    const bool prefix_timestamp_;
+
+    /**
+     * The ring buffers for every thread that has logged through this writer.
+     * The threads themselves also hold a reference to their buffer.
+     */
+    std::vector<std::shared_ptr<LogRingBuffer>> ring_buffers_;
+    std::mutex ring_buffers_mutex_;
+
+    /**
+     * Reused between calls to `write_pending_messages()` to avoid
+     * reallocations. Protected by `write_mutex_`.
+     */
+    std::vector<PendingMessage> pending_messages_;
+    /**
+     * Held while writing messages, so `flush()` can be called from other
+     * threads while the writer thread is running.
+     */
+    std::mutex write_mutex_;
+
+    /**
+     * This needs to be the last field so it's started after everything else
+     * has been initialized.
+     */
+    std::jthread writer_thread_;
+};
+
+#else
+
+// An empty definition so `Logger` can still hold a `std::shared_ptr` to it
+class AsyncLogWriter {
+   public:
+    void push(std::string_view) {}
+    void flush() noexcept {}
+    static void flush_all() noexcept {}
+};
+
+#endif  // WITHOUT_ASIO
+
 Logger::Logger(std::shared_ptr<std::ostream> stream,
                Verbosity verbosity_level,
                bool editor_tracing,
+               bool process_timing,
                std::string prefix,
                bool prefix_timestamp)
     : verbosity_(verbosity_level),
       editor_tracing_(editor_tracing),
+      process_timing_(process_timing),
       stream_(stream),
       prefix_(prefix),
-      prefix_timestamp_(prefix_timestamp) {}
+      prefix_timestamp_(prefix_timestamp) {
+#ifndef WITHOUT_ASIO
+    if (verbosity_ > Verbosity::basic || editor_tracing_ || process_timing_) {
+        async_writer_ = std::make_shared<AsyncLogWriter>(stream_, prefix_,
+                                                         prefix_timestamp_);
+    }
+#endif
+}
+
+Logger::~Logger() noexcept {
+    flush();
+}
 
 Logger Logger::create_from_environment(std::string prefix,
                                        std::shared_ptr<std::ostream> stream,
@@ -62,13 +521,23 @@ Logger Logger::create_from_environment(std::string prefix,
     std::string file_path = file_path_env ? std::string(file_path_env) : "";
     std::string verbosity = verbosity_env ? std::string(verbosity_env) : "";
 
-    // Editor debug tracing is an optional flag that can be added to any debug
-    // level (and technically it will also work fine if it's the only option,
-    // but you're not supposed to do that ;))
-    const bool editor_tracing = verbosity.ends_with(editor_tracing_flag);
-    if (editor_tracing) {
-        verbosity =
-            verbosity.substr(0, verbosity.size() - strlen(editor_tracing_flag));
+    // Editor debug tracing and process timing are optional flags that can be
+    // added to any debug level in any order (and technically it will also work
+    // fine if they're the only option, but you're not supposed to do that ;))
+    bool editor_tracing = false;
+    bool process_timing = false;
+    while (true) {
+        if (verbosity.ends_with(editor_tracing_flag)) {
+            editor_tracing = true;
+            verbosity = verbosity.substr(
+                0, verbosity.size() - strlen(editor_tracing_flag));
+        } else if (verbosity.ends_with(process_timing_flag)) {
+            process_timing = true;
+            verbosity = verbosity.substr(
+                0, verbosity.size() - strlen(process_timing_flag));
+        } else {
+            break;
+        }
     }
 
     // Default to `Verbosity::basic` if the environment variable has not
@@ -99,8 +568,8 @@ Logger Logger::create_from_environment(std::string prefix,
         }
     }
 
-    return Logger(stream, verbosity_level, editor_tracing, prefix,
-                  prefix_timestamp);
+    return Logger(stream, verbosity_level, editor_tracing, process_timing,
+                  prefix, prefix_timestamp);
 }
 
 Logger Logger::create_wine_stderr() {
@@ -120,28 +589,24 @@ Logger Logger::create_exception_logger() {
 }
 
 void Logger::log(const std::string& message) {
-    std::ostringstream formatted_message;
+    if (async_writer_) {
+        async_writer_->push(message);
+        return;
+    }
 
-    if (prefix_timestamp_) {
-        const auto current_time = std::chrono::system_clock::now();
-        const time_t timestamp =
-            std::chrono::system_clock::to_time_t(current_time);
+    std::ostringstream formatted_message;
+    write_log_line(formatted_message, std::chrono::system_clock::now(),
+                   prefix_timestamp_, prefix_, message);
 
-        // How did C++ manage to get time formatting libraries without a way to
-        // actually get a timestamp in a threadsafe way? `localtime_r` in C++ is
-        // not portable but luckily we only have to support GCC anyway.
-        std::tm tm;
-        localtime_r(&timestamp, &tm);
+    *stream_ << formatted_message.str() << std::flush;
+}
 
-        formatted_message << std::put_time(&tm, "%T") << " ";
+void Logger::flush() noexcept {
+    if (async_writer_) {
+        async_writer_->flush();
     }
+}
 
-    formatted_message << prefix_;
-    formatted_message << message;
-    // Flushing a stringstream doesn't do anything, but we need to put a
-    // linefeed in this string stream rather writing it sprightly to the output
-    // stream to prevent two messages from being put on the same row
-    formatted_message << std::endl;
-
-    *stream_ << formatted_message.str() << std::flush;
+void Logger::flush_all() noexcept {
+    AsyncLogWriter::flush_all();
 }
@@ -33,17 +33,26 @@
 
 #include "../utils.h"
 
+// Defined in `common.cpp`. This is not available in the chainloaders.
+class AsyncLogWriter;
+
 /**
  * Super basic logging facility meant for debugging malfunctioning VST
  * plugins. This is also used to redirect the output of the Wine process
  * because DAWs like Bitwig hide this from you, making it hard to debug
  * crashing plugins.
  *
- * @note This does not do any synchronisation. While this should technically
- *   be causing problems in concurrent use, writing strings to fstreams from
- *   multiple threads at the same time doesn't seem to produce corrupted text if
- *   you're writing an entire string at once even though the messages may be
- *   slightly out of order.
+ * When any form of debug logging is enabled through `YABRIDGE_DEBUG_LEVEL`,
+ * log messages are handed off to a background thread through per-thread ring
+ * buffers instead of being formatted and written on the calling thread. See
+ * `AsyncLogWriter` for more information. This way verbose logging on the audio
+ * thread won't cause xruns.
+ *
+ * @note This does not do any synchronisation in the synchronous mode. While
+ *   this should technically be causing problems in concurrent use, writing
+ *   strings to fstreams from multiple threads at the same time doesn't seem to
+ *   produce corrupted text if you're writing an entire string at once even
+ *   though the messages may be slightly out of order.
  */
 class Logger {
    public:
@@ -85,6 +94,8 @@ class Logger {
      * @param editor_tracing Whether we should enable debug tracing for the
      *   editor window handling. If we end up adding more of these options, we
      *   should move to a bitfield or something.
+     * @param process_timing Whether the native plugin should periodically
+     *   print timing statistics for audio processing.
      * @param prefix An optional prefix for the logger. Useful for differentiate
      *   messages coming from the Wine plugin host. Should end with a single
      *   space character.
@@ -97,9 +108,17 @@ class Logger {
     Logger(std::shared_ptr<std::ostream> stream,
            Verbosity verbosity_level,
            bool editor_tracing,
+           bool process_timing,
            std::string prefix = "",
            bool prefix_timestamp = true);
 
+    /**
+     * Write any buffered log messages before the logger gets destroyed. Copies
+     * of a logger share the same writer, so this only writes messages that
+     * have not yet been written.
+     */
+    ~Logger() noexcept;
+
     /**
      * Create a logger instance based on the set environment variables. See the
      * constants in `logging.cpp` for more information.
@@ -136,12 +155,29 @@ class Logger {
 
     /**
      * Write a message to the log, prefixing it with a timestamp and this
-     * logger's prefix string.
+     * logger's prefix string. If debug logging is enabled, then this only
+     * copies the message to this thread's log buffer and the message will be
+     * written shortly after on a background thread.
      *
      * @param message The message to write.
      */
     void log(const std::string& message);
 
+    /**
+     * Write all of this logger's buffered messages right now, blocking until
+     * they have been written. This should be called before exiting or
+     * rethrowing after an error so the last messages don't get lost. Does
+     * nothing when debug logging is disabled since messages are then written
+     * synchronously.
+     */
+    void flush() noexcept;
+
+    /**
+     * Flush every logger in this process. This should be called before
+     * terminating the process without running any destructors.
+     */
+    static void flush_all() noexcept;
+
 #ifndef WITHOUT_ASIO
     /**
      * Write output from an async pipe to the log on a line by line basis.
@@ -214,6 +250,13 @@ class Logger {
      */
     const bool editor_tracing_;
 
+    /**
+     * If this is set to true, then the native plugin will keep track of how
+     * long audio processing takes and periodically print a summary. See
+     * `ProcessTimingReporter`.
+     */
+    const bool process_timing_;
+
    private:
     /**
      * The output stream to write the log messages to. Typically either STDERR
@@ -230,4 +273,11 @@ class Logger {
      * Whether the log messages should be prefixed with a time stamp.
      */
     const bool prefix_timestamp_;
+
+    /**
+     * Writes the log messages on a background thread when any form of debug
+     * logging has been enabled. Copies of this logger share the same writer.
+     * If this is a null pointer, then messages are written synchronously.
+     */
+    std::shared_ptr<AsyncLogWriter> async_writer_;
 };
@@ -0,0 +1,219 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "trace.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/**
+ * The environment variable containing the path to the trace file. Tracing is
+ * disabled if this is not set.
+ */
+constexpr char trace_file_environment_variable[] = "YABRIDGE_TRACE_FILE";
+
+/**
+ * How often the writer thread appends the recorded events to the trace file.
+ */
+constexpr std::chrono::milliseconds trace_write_interval(100);
+
+/**
+ * The maximum number of events we'll buffer between writes. Anything beyond
+ * this is dropped so a stalled writer can't cause unbounded memory usage.
+ */
+constexpr size_t max_pending_trace_events = 1 << 18;
+
+/**
+ * Convert a time point to microseconds on the `CLOCK_MONOTONIC` time base,
+ * which is the unit used in the Chrome trace event format.
+ */
+static double to_trace_timestamp(std::chrono::steady_clock::time_point time) {
+    return std::chrono::duration<double, std::micro>(time.time_since_epoch())
+        .count();
+}
+
+TraceRecorder* TraceRecorder::instance() {
+    static const std::unique_ptr<TraceRecorder> recorder =
+        []() -> std::unique_ptr<TraceRecorder> {
+        // NOLINTNEXTLINE(concurrency-mt-unsafe)
+        const char* trace_file = getenv(trace_file_environment_variable);
+        if (!trace_file || *trace_file == '\0') {
+            return nullptr;
+        }
+
+        // Whichever process creates the file writes the opening bracket, and
+        // all other processes simply append to it
+        int fd = open(trace_file, O_WRONLY | O_APPEND | O_CREAT | O_EXCL, 0644);
+        if (fd != -1) {
+            constexpr char header[] = "[\n";
+            if (write(fd, header, sizeof(header) - 1) == -1) {
+                close(fd);
+                return nullptr;
+            }
+        } else {
+            fd = open(trace_file, O_WRONLY | O_APPEND);
+            if (fd == -1) {
+                return nullptr;
+            }
+        }
+
+        return std::unique_ptr<TraceRecorder>(new TraceRecorder(fd));
+    }();
+
+    return recorder.get();
+}
+
+TraceRecorder::TraceRecorder(int fd)
+    : fd_(fd),
+      // Like the logger's writer thread, this doesn't call into any Windows
+      // code so it's fine to use a regular thread on the Wine side
+      writer_thread_([this](std::stop_token stop_token) {
+          std::mutex mutex;
+          std::condition_variable_any stopped;
+          std::unique_lock lock(mutex);
+          while (!stop_token.stop_requested()) {
+              stopped.wait_for(lock, stop_token, trace_write_interval,
+                               []() { return false; });
+              write_pending_events();
+          }
+      }) {
+    pending_events_.reserve(4096);
+
+    // Name the process so both sides can easily be told apart in the viewer
+    std::ostringstream metadata;
+    metadata << R"({"name":"process_name","ph":"M","pid":)" << getpid()
+#ifdef __WINE__
+             << R"(,"args":{"name":"yabridge Wine plugin host"}},)"
+#else
+             << R"(,"args":{"name":"yabridge native plugin"}},)"
+#endif
+             << "\n";
+
+    const std::string metadata_str = metadata.str();
+    [[maybe_unused]] const auto _ =
+        write(fd_, metadata_str.data(), metadata_str.size());
+}
+
+TraceRecorder::~TraceRecorder() noexcept {
+    writer_thread_.request_stop();
+    writer_thread_.join();
+    write_pending_events();
+
+    close(fd_);
+}
+
+void TraceRecorder::record(const Event& event) noexcept {
+    std::lock_guard lock(pending_events_mutex_);
+    if (pending_events_.size() >= max_pending_trace_events) {
+        dropped_events_++;
+        return;
+    }
+
+    pending_events_.push_back(event);
+}
+
+void TraceRecorder::write_pending_events() {
+    uint64_t dropped_events;
+    {
+        std::lock_guard lock(pending_events_mutex_);
+        std::swap(pending_events_, writing_events_);
+        dropped_events = dropped_events_;
+        dropped_events_ = 0;
+    }
+
+    if (writing_events_.empty() && dropped_events == 0) {
+        return;
+    }
+
+    const pid_t pid = getpid();
+    std::ostringstream formatted_events;
+    formatted_events << std::fixed << std::setprecision(3);
+    for (const auto& event : writing_events_) {
+        const double begin = to_trace_timestamp(event.begin);
+        const double end = to_trace_timestamp(event.end);
+
+        formatted_events << R"({"name":")" << event.name << R"(","cat":")"
+                         << event.category.data() << R"(","ph":"X","ts":)"
+                         << begin << R"(,"dur":)" << (end - begin)
+                         << R"(,"pid":)" << pid << R"(,"tid":)"
+                         << event.thread_id << R"(,"args":{"side":")"
+                         << (event.handling ? "handle" : "send") << '"';
+        if (event.instance_id != -1) {
+            formatted_events << R"(,"instance_id":)" << event.instance_id;
+        }
+        formatted_events << "}},\n";
+    }
+
+    if (dropped_events > 0) {
+        formatted_events << R"({"name":"dropped )" << dropped_events
+                         << R"( events","ph":"i","s":"p","ts":)"
+                         << to_trace_timestamp(std::chrono::steady_clock::now())
+                         << R"(,"pid":)" << pid << R"(,"tid":0},)" << "\n";
+    }
+
+    writing_events_.clear();
+
+    // With `O_APPEND` every write is appended atomically, so events from the
+    // native plugin and the Wine plugin host won't get interleaved mid-line
+    const std::string buffer = formatted_events.str();
+    size_t written = 0;
+    while (written < buffer.size()) {
+        const ssize_t result =
+            write(fd_, buffer.data() + written, buffer.size() - written);
+        if (result <= 0) {
+            break;
+        }
+
+        written += static_cast<size_t>(result);
+    }
+}
+
+ScopedTrace::ScopedTrace(std::string_view name,
+                         std::string_view category,
+                         int64_t instance_id,
+                         bool handling) noexcept
+    : recorder_(TraceRecorder::instance()) {
+    if (recorder_) [[unlikely]] {
+        thread_local const int32_t thread_id =
+            static_cast<int32_t>(syscall(SYS_gettid));
+
+        event_.name = name;
+        const size_t category_size =
+            std::min(category.size(), event_.category.size() - 1);
+        std::copy_n(category.data(), category_size, event_.category.data());
+        event_.category[category_size] = '\0';
+        event_.instance_id = instance_id;
+        event_.handling = handling;
+        event_.thread_id = thread_id;
+        event_.begin = std::chrono::steady_clock::now();
+    }
+}
+
+ScopedTrace::~ScopedTrace() noexcept {
+    if (recorder_) [[unlikely]] {
+        event_.end = std::chrono::steady_clock::now();
+        recorder_->record(event_);
+    }
+}
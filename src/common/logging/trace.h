@@ -0,0 +1,177 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/**
+ * Records the begin and end times of every request sent and handled through
+ * our sockets, and periodically writes them to a file in the Chrome trace event
+ * format. This is enabled by setting the `YABRIDGE_TRACE_FILE` environment
+ * variable to a file path. Both the native plugin and the Wine plugin host
+ * append their events to that same file using `CLOCK_MONOTONIC` timestamps, so
+ * the resulting file can be loaded in `chrome://tracing` or
+ * https://ui.perfetto.dev to see exactly where the time goes on both sides of
+ * the bridge.
+ *
+ * The file uses the JSON array format without the closing bracket. Both trace
+ * viewers accept this, and it allows multiple processes to append to the same
+ * file without any coordination.
+ */
+class TraceRecorder {
+   public:
+    /**
+     * A single completed request. The name must point to static storage, since
+     * it will only be formatted later on the writer thread. The category is
+     * copied.
+     */
+    struct Event {
+        std::string_view name;
+        std::array<char, 48> category;
+        /**
+         * The instance ID from the request, or -1 if the request did not
+         * contain one.
+         */
+        int64_t instance_id;
+        /**
+         * Whether this event was recorded on the side that handled the request
+         * (`true`), or on the side that sent it and waited for the response
+         * (`false`).
+         */
+        bool handling;
+        int32_t thread_id;
+        std::chrono::steady_clock::time_point begin;
+        std::chrono::steady_clock::time_point end;
+    };
+
+    /**
+     * Get the trace recorder for this process. Returns a null pointer if
+     * tracing has not been enabled or if the trace file could not be opened.
+     */
+    static TraceRecorder* instance();
+
+    ~TraceRecorder() noexcept;
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    /**
+     * Record a completed event. This only briefly locks a mutex and doesn't
+     * allocate under normal circumstances.
+     */
+    void record(const Event& event) noexcept;
+
+   private:
+    /**
+     * Start the writer thread, writing to the opened file descriptor `fd`.
+     */
+    TraceRecorder(int fd);
+
+    /**
+     * Format all pending events and append them to the trace file.
+     */
+    void write_pending_events();
+
+    int fd_;
+
+    std::mutex pending_events_mutex_;
+    std::vector<Event> pending_events_;
+    /**
+     * Events that could not be recorded because the writer could not keep up.
+     */
+    uint64_t dropped_events_ = 0;
+
+    /**
+     * Only used on the writer thread, swapped with `pending_events_`.
+     */
+    std::vector<Event> writing_events_;
+
+    /**
+     * This needs to be the last field so it's started after everything else
+     * has been initialized.
+     */
+    std::jthread writer_thread_;
+};
+
+/**
+ * Get a type's fully qualified name for use in trace events. The returned
+ * string has static storage duration.
+ */
+template <typename T>
+constexpr std::string_view trace_type_name() noexcept {
+    // This looks like `... [with T = clap::plugin::Process; ...]` on GCC and
+    // `... [T = clap::plugin::Process]` on Clang
+    const std::string_view function_name = __PRETTY_FUNCTION__;
+    const size_t start = function_name.find("T = ") + 4;
+    const size_t end = function_name.find_first_of(";]", start);
+
+    return function_name.substr(start, end - start);
+}
+
+/**
+ * Get the instance ID from a request object for use in trace events, or -1 if
+ * the request doesn't contain an instance ID.
+ */
+template <typename T>
+int64_t trace_instance_id(const T& object) noexcept {
+    if constexpr (requires { object.instance_id; }) {
+        return static_cast<int64_t>(object.instance_id);
+    } else if constexpr (requires { object.owner_instance_id; }) {
+        return static_cast<int64_t>(object.owner_instance_id);
+    } else if constexpr (requires { object.get(); }) {
+        // This is a `MessageReference<T>`
+        return trace_instance_id(object.get());
+    } else {
+        return -1;
+    }
+}
+
+/**
+ * Records a trace event spanning this object's lifetime if tracing has been
+ * enabled. Otherwise this doesn't do anything.
+ *
+ * @see TraceRecorder
+ */
+class ScopedTrace {
+   public:
+    /**
+     * @param name The name of the request. This must have static storage
+     *   duration, see `trace_type_name()`.
+     * @param category The name of the socket the request was sent over.
+     * @param instance_id The instance ID from the request, or -1.
+     * @param handling Whether this is the side handling the request, or the
+     *   side that sent it.
+     */
+    ScopedTrace(std::string_view name,
+                std::string_view category,
+                int64_t instance_id,
+                bool handling) noexcept;
+    ~ScopedTrace() noexcept;
+
+    ScopedTrace(const ScopedTrace&) = delete;
+    ScopedTrace& operator=(const ScopedTrace&) = delete;
+
+   private:
+    TraceRecorder* recorder_;
+    TraceRecorder::Event event_;
+};
@@ -20,7 +20,8 @@
 
 Vst2Logger::Vst2Logger(Logger& generic_logger) : logger_(generic_logger) {}
 
-std::optional<std::string> opcode_to_string(bool is_dispatch, int opcode) {
+std::optional<std::string_view> opcode_to_string(bool is_dispatch,
+                                                 int opcode) {
     if (is_dispatch) {
         // Opcodes for a plugin's dispatch function
         switch (opcode) {
@@ -341,10 +342,13 @@ void Vst2Logger::log_get_parameter(int index) {
     }
 }
 
-void Vst2Logger::log_get_parameter_response(float value) {
+void Vst2Logger::log_get_parameter_response(float value, bool from_cache) {
     if (logger_.verbosity_ >= Logger::Verbosity::most_events) [[unlikely]] {
         std::ostringstream message;
         message << "   getParameter() :: " << value;
+        if (from_cache) {
+            message << " (from cache)";
+        }
 
         log(message.str());
     }
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <string_view>
+
 #include "../serialization/vst2.h"
 #include "common.h"
 
@@ -28,9 +30,9 @@
  * @param opcode The opcode of the event.
  *
  * @return Either the name from `aeffectx.h`, or a nullopt if it was not listed
- *   there.
+ *   there. The name has static storage duration.
  */
-std::optional<std::string> opcode_to_string(bool is_dispatch, int opcode);
+std::optional<std::string_view> opcode_to_string(bool is_dispatch, int opcode);
 
 /**
  * Wraps around `Logger` to provide VST2 specific logging functionality for
@@ -49,7 +51,7 @@ class Vst2Logger {
     // The following functions are for logging specific events, they are only
     // enabled for verbosity levels higher than 1 (i.e. `Verbosity::events`)
     void log_get_parameter(int index);
-    void log_get_parameter_response(float vlaue);
+    void log_get_parameter_response(float vlaue, bool from_cache = false);
     void log_set_parameter(int index, float value);
     void log_set_parameter_response();
     // If `is_dispatch` is `true`, then use opcode names from the plugin's
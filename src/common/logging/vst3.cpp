@@ -250,6 +250,15 @@ bool Vst3Logger::log_request(
     });
 }
 
+bool Vst3Logger::log_request(
+    bool is_host_plugin,
+    const YaEditController::GetAllParameterInfo& request) {
+    return log_request_base(is_host_plugin, [&](auto& message) {
+        message << request.instance_id
+                << ": IEditController::getParameterInfo(<all parameters>)";
+    });
+}
+
 bool Vst3Logger::log_request(
     bool is_host_plugin,
     const YaEditController::GetParamStringByValue& request) {
@@ -1495,24 +1504,41 @@ void Vst3Logger::log_response(
 
 void Vst3Logger::log_response(
     bool is_host_plugin,
-    const YaEditController::GetParamStringByValueResponse& response) {
+    const YaEditController::GetAllParameterInfoResponse& response) {
+    log_response_base(is_host_plugin, [&](auto& message) {
+        message << "<ParameterInfo for " << response.parameters.size()
+                << " parameters>";
+    });
+}
+
+void Vst3Logger::log_response(
+    bool is_host_plugin,
+    const YaEditController::GetParamStringByValueResponse& response,
+    bool from_cache) {
     log_response_base(is_host_plugin, [&](auto& message) {
         message << response.result.string();
         if (response.result == Steinberg::kResultOk) {
             std::string value = VST3::StringConvert::convert(response.string);
             message << ", \"" << value << "\"";
         }
+        if (from_cache) {
+            message << " (from cache)";
+        }
     });
 }
 
 void Vst3Logger::log_response(
     bool is_host_plugin,
-    const YaEditController::GetParamValueByStringResponse& response) {
+    const YaEditController::GetParamValueByStringResponse& response,
+    bool from_cache) {
     log_response_base(is_host_plugin, [&](auto& message) {
         message << response.result.string();
         if (response.result == Steinberg::kResultOk) {
             message << ", " << response.value_normalized;
         }
+        if (from_cache) {
+            message << " (from cache)";
+        }
     });
 }
 
@@ -85,6 +85,8 @@ class Vst3Logger {
                      const YaEditController::GetParameterCount&);
     bool log_request(bool is_host_plugin,
                      const YaEditController::GetParameterInfo&);
+    bool log_request(bool is_host_plugin,
+                     const YaEditController::GetAllParameterInfo&);
     bool log_request(bool is_host_plugin,
                      const YaEditController::GetParamStringByValue&);
     bool log_request(bool is_host_plugin,
@@ -275,9 +277,13 @@ class Vst3Logger {
                       const YaEditController::GetParameterInfoResponse&,
                       bool from_cache = false);
     void log_response(bool is_host_plugin,
-                      const YaEditController::GetParamStringByValueResponse&);
+                      const YaEditController::GetAllParameterInfoResponse&);
+    void log_response(bool is_host_plugin,
+                      const YaEditController::GetParamStringByValueResponse&,
+                      bool from_cache = false);
     void log_response(bool is_host_plugin,
-                      const YaEditController::GetParamValueByStringResponse&);
+                      const YaEditController::GetParamValueByStringResponse&,
+                      bool from_cache = false);
     void log_response(bool is_host_plugin,
                       const YaEditController::CreateViewResponse&);
     void log_response(bool is_host_plugin,
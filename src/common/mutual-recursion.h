@@ -26,6 +26,8 @@
 #include <asio/dispatch.hpp>
 #include <asio/io_context.hpp>
 
+#include "probes.h"
+
 /**
  * A helper to allow mutually recursive calling sequences with remote function
  * calls. Some plugins (and hosts) are very picky about which thread a function
@@ -85,10 +87,13 @@ class MutualRecursionHelper {
         // IPlugFrame::resizeView() -> IPlugView::onSize()`.
         std::shared_ptr<asio::io_context> current_io_context =
             std::make_shared<asio::io_context>();
+        [[maybe_unused]] size_t depth;
         {
             std::unique_lock lock(mutual_recursion_contexts_mutex_);
             mutual_recursion_contexts_.push_back(current_io_context);
+            depth = mutual_recursion_contexts_.size();
         }
+        YABRIDGE_PROBE(mutual_recursion_fork_start, depth);
 
         // Instead of directly stopping the IO context, we'll reset this work
         // guard instead. This prevents us from accidentally cancelling any
@@ -119,7 +124,10 @@ class MutualRecursionHelper {
         // which point the context will be stopped
         current_io_context->run();
 
-        return response_promise.get_future().get();
+        Result result = response_promise.get_future().get();
+        YABRIDGE_PROBE(mutual_recursion_fork_end, depth);
+
+        return result;
     }
 
     /**
@@ -169,9 +177,15 @@ class MutualRecursionHelper {
         std::packaged_task<Result()> do_call(std::forward<F>(fn));
         std::future<Result> do_call_response = do_call.get_future();
         asio::dispatch(*mutual_recursion_contexts_.back(), std::move(do_call));
+        [[maybe_unused]] const size_t depth =
+            mutual_recursion_contexts_.size();
         mutual_recursion_lock.unlock();
 
-        return do_call_response.get();
+        YABRIDGE_PROBE(mutual_recursion_handle_start, depth);
+        Result result = do_call_response.get();
+        YABRIDGE_PROBE(mutual_recursion_handle_end, depth);
+
+        return result;
     }
 
    private:
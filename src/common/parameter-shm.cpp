@@ -0,0 +1,189 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "parameter-shm.h"
+
+#include <bit>
+#include <cassert>
+#include <chrono>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "futex.h"
+
+/**
+ * How long the Wine plugin host's audio thread will wait for posted
+ * `setParameter()` calls to be applied before it starts processing audio
+ * anyways. These calls normally take a couple of microseconds, so this only
+ * kicks in when something is very wrong.
+ */
+constexpr std::chrono::milliseconds pending_sets_timeout(20);
+
+ParameterShmTable::ParameterShmTable(const Config& config)
+    : config_(config),
+      shm_fd_(shm_open(config.name.c_str(), O_RDWR | O_CREAT, 0600)),
+      shm_size_(entries_offset +
+                (config.num_parameters * sizeof(std::atomic<uint64_t>))) {
+    if (shm_fd_ == -1) {
+        throw std::system_error(
+            std::error_code(errno, std::system_category()),
+            "Could not create shared memory object " + config_.name);
+    }
+
+    // The object will be zero filled when it gets created, and we'll reserve
+    // generation 0 for entries that have never been written to. Whichever side
+    // maps the table first gets to move it to the first real generation.
+    if (ftruncate(shm_fd_, shm_size_) != 0) {
+        close(shm_fd_);
+        throw std::system_error(
+            std::error_code(errno, std::system_category()),
+            "Could not resize shared memory object " + config_.name);
+    }
+
+    void* mapping = mmap(nullptr, shm_size_, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, shm_fd_, 0);
+    if (mapping == MAP_FAILED) {
+        close(shm_fd_);
+        throw std::system_error(
+            std::error_code(errno, std::system_category()),
+            "Could not map shared memory object " + config_.name);
+    }
+
+    shm_bytes_ = static_cast<uint8_t*>(mapping);
+
+    uint32_t expected_generation = 0;
+    header().generation.compare_exchange_strong(expected_generation, 1);
+}
+
+ParameterShmTable::~ParameterShmTable() noexcept {
+    if (!is_moved_) {
+        munmap(shm_bytes_, shm_size_);
+        close(shm_fd_);
+        shm_unlink(config_.name.c_str());
+    }
+}
+
+ParameterShmTable::ParameterShmTable(ParameterShmTable&& o) noexcept
+    : config_(std::move(o.config_)),
+      shm_fd_(std::move(o.shm_fd_)),
+      shm_bytes_(std::move(o.shm_bytes_)),
+      shm_size_(std::move(o.shm_size_)) {
+    o.is_moved_ = true;
+}
+
+ParameterShmTable& ParameterShmTable::operator=(
+    ParameterShmTable&& o) noexcept {
+    if (this == &o) {
+        return *this;
+    }
+
+    // We'll need to release our current mapping first, since it would
+    // otherwise leak after we take over the other object's resources
+    if (!is_moved_) {
+        munmap(shm_bytes_, shm_size_);
+        close(shm_fd_);
+        shm_unlink(config_.name.c_str());
+    }
+
+    config_ = std::move(o.config_);
+    shm_fd_ = std::move(o.shm_fd_);
+    shm_bytes_ = std::move(o.shm_bytes_);
+    shm_size_ = std::move(o.shm_size_);
+    is_moved_ = o.is_moved_;
+    o.is_moved_ = true;
+
+    return *this;
+}
+
+uint32_t ParameterShmTable::generation() const noexcept {
+    return header().generation.load(std::memory_order_acquire);
+}
+
+std::optional<float> ParameterShmTable::get(int index) const noexcept {
+    if (index < 0 || static_cast<uint32_t>(index) >= config_.num_parameters) {
+        return std::nullopt;
+    }
+
+    const uint64_t packed = entry(index).load(std::memory_order_acquire);
+    if (static_cast<uint32_t>(packed >> 32) != generation()) {
+        return std::nullopt;
+    }
+
+    return std::bit_cast<float>(static_cast<uint32_t>(packed));
+}
+
+void ParameterShmTable::store(int index,
+                              float value,
+                              uint32_t generation) noexcept {
+    if (index < 0 || static_cast<uint32_t>(index) >= config_.num_parameters) {
+        return;
+    }
+
+    const uint64_t packed = (static_cast<uint64_t>(generation) << 32) |
+                            std::bit_cast<uint32_t>(value);
+    entry(index).store(packed, std::memory_order_release);
+}
+
+void ParameterShmTable::store(int index, float value) noexcept {
+    store(index, value, generation());
+}
+
+void ParameterShmTable::invalidate() noexcept {
+    // Generation 0 is reserved for entries that have never been written to, so
+    // we'll skip over it if the counter ever wraps around
+    if (header().generation.fetch_add(1, std::memory_order_acq_rel) + 1 == 0) {
+        header().generation.fetch_add(1, std::memory_order_acq_rel);
+    }
+}
+
+void ParameterShmTable::post_set() noexcept {
+    header().posted_sets.fetch_add(1, std::memory_order_release);
+}
+
+void ParameterShmTable::confirm_set() noexcept {
+    header().applied_sets.fetch_add(1, std::memory_order_release);
+    futex_wake(header().applied_sets);
+}
+
+void ParameterShmTable::wait_for_pending_sets() noexcept {
+    const auto deadline =
+        std::chrono::steady_clock::now() + pending_sets_timeout;
+    while (true) {
+        const uint32_t applied =
+            header().applied_sets.load(std::memory_order_acquire);
+        const uint32_t posted =
+            header().posted_sets.load(std::memory_order_acquire);
+        // These counters can wrap around, so we need to compare the difference
+        if (static_cast<int32_t>(posted - applied) <= 0) {
+            return;
+        }
+
+        const auto remaining = deadline - std::chrono::steady_clock::now();
+        if (remaining <= std::chrono::steady_clock::duration::zero()) {
+            return;
+        }
+
+        const timespec timeout{
+            .tv_sec = 0,
+            .tv_nsec = static_cast<long>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(remaining)
+                    .count())};
+        futex_wait(header().applied_sets, applied, &timeout);
+    }
+}
@@ -0,0 +1,192 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+/**
+ * A small shared memory table containing the last known value for each of a
+ * VST2 plugin's parameters. Hosts like Bitwig and REAPER will poll
+ * `getParameter()` for every single parameter on every UI frame, and doing a
+ * full round trip to the Wine plugin host for each of those calls adds up to
+ * thousands of blocking socket messages per second per plugin instance. With
+ * this table the native plugin can answer those calls with a single atomic
+ * read instead.
+ *
+ * The table is created on the Wine side right after the plugin has been
+ * initialized, and its configuration is then sent to the native plugin so it
+ * can map the same region. The Wine plugin host keeps the values up to date
+ * whenever it learns about a new value. That happens when it handles a
+ * `getParameter()` or `setParameter()` call, and when the plugin calls
+ * `audioMasterAutomate()`. When the plugin's state changes in bulk (e.g.
+ * because of `effSetProgram()`, `effSetChunk()`, or
+ * `audioMasterUpdateDisplay()`), the entire table is invalidated by bumping
+ * its generation. Every entry stores the generation it was written in, so
+ * stale entries simply result in a cache miss and the native plugin will fall
+ * back to asking the Wine plugin host.
+ *
+ * Because `setParameter()` calls no longer need to be answered, this table
+ * also tracks the number of `setParameter()` calls posted by the native plugin
+ * and the number of calls the Wine plugin host has applied. The audio thread
+ * on the Wine side uses this to make sure all parameter changes made before an
+ * audio processing call are applied before the plugin processes audio.
+ */
+class ParameterShmTable {
+   public:
+    /**
+     * The parameters needed for creating and connecting to a parameter table.
+     * This is created on the Wine side and then sent to the native plugin.
+     */
+    struct Config {
+        /**
+         * The unique identifier for this shared memory object. The backing file
+         * will be created in `/dev/shm` by the operating system.
+         */
+        std::string name;
+
+        /**
+         * The number of parameters the table has space for. This is the
+         * plugin's `numParams` at the time the table was created. Parameters
+         * outside of this range are never cached.
+         */
+        uint32_t num_parameters;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.text1b(name, 1024);
+            s.value4b(num_parameters);
+        }
+    };
+
+    /**
+     * Connect to or create the shared memory object and map it to this
+     * process's memory.
+     *
+     * @throw std::system_error If the shared memory object could not be
+     *   created or mapped.
+     */
+    ParameterShmTable(const Config& config);
+
+    /**
+     * Unmap and remove the shared memory object. Like with `AudioShmBuffer`,
+     * this is done on both sides.
+     */
+    ~ParameterShmTable() noexcept;
+
+    ParameterShmTable(const ParameterShmTable&) = delete;
+    ParameterShmTable& operator=(const ParameterShmTable&) = delete;
+
+    ParameterShmTable(ParameterShmTable&& o) noexcept;
+    ParameterShmTable& operator=(ParameterShmTable&& o) noexcept;
+
+    /**
+     * The table's current generation. This should be read before asking the
+     * plugin for a parameter's value, and then passed to `store()` so a value
+     * read before an invalidation can never overwrite the invalidation.
+     */
+    uint32_t generation() const noexcept;
+
+    /**
+     * Get the cached value for a parameter. This is a single atomic read and it
+     * can safely be called from any thread in either process.
+     *
+     * @return The parameter's value, or a nullopt if the index is out of range
+     *   or if the value has not been stored since the last invalidation.
+     */
+    std::optional<float> get(int index) const noexcept;
+
+    /**
+     * Store a parameter's value. The entry will only be considered valid if
+     * `generation` is still the table's current generation. Out of range
+     * indices are ignored.
+     */
+    void store(int index, float value, uint32_t generation) noexcept;
+
+    /**
+     * Store a parameter's value using the table's current generation. Used for
+     * values the plugin itself reported through `audioMasterAutomate()`.
+     */
+    void store(int index, float value) noexcept;
+
+    /**
+     * Invalidate all values in the table. Should be called after anything that
+     * may change a lot of parameters at once.
+     */
+    void invalidate() noexcept;
+
+    /**
+     * Called on the native plugin side right before sending an asynchronous
+     * `setParameter()` request to the Wine plugin host.
+     */
+    void post_set() noexcept;
+
+    /**
+     * Called on the Wine plugin host side after a `setParameter()` request sent
+     * after a call to `post_set()` has been handled.
+     */
+    void confirm_set() noexcept;
+
+    /**
+     * Block until every `setParameter()` call posted through `post_set()` has
+     * been confirmed through `confirm_set()`. This is called on the Wine side
+     * before processing audio. To avoid stalling the audio thread forever if
+     * something goes wrong, this gives up after a couple milliseconds.
+     */
+    void wait_for_pending_sets() noexcept;
+
+   private:
+    /**
+     * The header at the start of the shared memory object. The parameter
+     * entries follow directly after this.
+     */
+    struct Header {
+        std::atomic<uint32_t> generation;
+        std::atomic<uint32_t> posted_sets;
+        std::atomic<uint32_t> applied_sets;
+    };
+
+    Header& header() const noexcept {
+        return *reinterpret_cast<Header*>(shm_bytes_);
+    }
+
+    /**
+     * Get the entry for a parameter. Every entry packs the generation it was
+     * written in into the upper 32 bits, and the value's bit pattern into the
+     * lower 32 bits so both can be read and written atomically.
+     */
+    std::atomic<uint64_t>& entry(uint32_t index) const noexcept {
+        return reinterpret_cast<std::atomic<uint64_t>*>(shm_bytes_ +
+                                                        entries_offset)[index];
+    }
+
+    /**
+     * The entries start after the header, aligned to a 64-bit boundary.
+     */
+    static constexpr size_t entries_offset = 16;
+    static_assert(sizeof(Header) <= entries_offset);
+
+    Config config_;
+
+    int shm_fd_ = 0;
+    uint8_t* shm_bytes_ = nullptr;
+    size_t shm_size_ = 0;
+
+    bool is_moved_ = false;
+};
@@ -0,0 +1,45 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+// These are SystemTap style USDT probes that can be used with tools like
+// bpftrace and perf to trace yabridge's communication without any logging
+// overhead. They're only compiled in when yabridge is built with `-Dusdt=true`.
+// A probe is a single `nop` instruction until a tracer attaches to it, but its
+// arguments are still evaluated every time the probe is reached, so they should
+// only be cheap values like sizes and pointers that are already available. All
+// probes use the `yabridge` provider, so they show up as
+// `usdt:<binary>:yabridge:<name>` in bpftrace. See the debugging section of the
+// readme for a list of probes.
+#ifdef WITH_USDT
+
+#include <sys/sdt.h>
+
+/**
+ * Fire the `yabridge:name` USDT probe with up to twelve integer or pointer
+ * arguments.
+ */
+#define YABRIDGE_PROBE(name, ...) \
+    STAP_PROBEV(yabridge, name __VA_OPT__(, ) __VA_ARGS__)
+
+#else
+
+#define YABRIDGE_PROBE(name, ...) \
+    do {                          \
+    } while (0)
+
+#endif
@@ -79,6 +79,7 @@ using ClapMainThreadControlRequest =
                  clap::ext::params::plugin::Count,
                  clap::ext::params::plugin::GetInfo,
                  clap::ext::params::plugin::GetValue,
+                 clap::ext::params::plugin::GetAllInfo,
                  clap::ext::params::plugin::ValueToText,
                  clap::ext::params::plugin::TextToValue,
                  clap::ext::render::plugin::HasHardRealtimeRequirement,
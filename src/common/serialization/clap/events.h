@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <concepts>
 #include <string>
 #include <variant>
 
@@ -277,6 +278,26 @@ class EventList {
     static bool CLAP_ABI out_try_push(const struct clap_output_events* list,
                                       const clap_event_header_t* event);
 
+    /**
+     * Call `fn` with every `CLAP_EVENT_PARAM_VALUE` event in this list that
+     * applies to the parameter as a whole, i.e. events that aren't tied to a
+     * specific note, port, channel, or key. The plugin proxy uses this to keep
+     * its cached parameter values in sync with the plugin.
+     */
+    template <std::invocable<const clap_event_param_value_t&> F>
+    void for_each_param_value(F&& fn) const {
+        for (const auto& event : events_) {
+            if (const auto* param_value =
+                    std::get_if<payload::ParamValue>(&event.payload)) {
+                const clap_event_param_value_t& value = param_value->event;
+                if (value.note_id == -1 && value.port_index == -1 &&
+                    value.channel == -1 && value.key == -1) {
+                    fn(value);
+                }
+            }
+        }
+    }
+
     /**
      * Return the number of events we store. Used in debug logs.
      */
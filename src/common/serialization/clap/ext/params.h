@@ -151,6 +151,39 @@ struct GetValue {
     }
 };
 
+/**
+ * The response to the `clap::ext::params::plugin::GetAllInfo` message defined
+ * below. `values[i]` contains the value for the parameter described by
+ * `infos[i]`, and it will be a nullopt if either of the two calls failed.
+ */
+struct GetAllInfoResponse {
+    std::vector<GetInfoResponse> infos;
+    std::vector<GetValueResponse> values;
+
+    template <typename S>
+    void serialize(S& s) {
+        s.container(infos, 1 << 16);
+        s.container(values, 1 << 16);
+    }
+};
+
+/**
+ * Fetch the results of `clap_plugin_params::count()`, and then
+ * `clap_plugin_params::get_info()` and `clap_plugin_params::get_value()` for
+ * every parameter in a single request. The native plugin caches these values
+ * so the host's parameter queries don't each need their own round trip.
+ */
+struct GetAllInfo {
+    using Response = GetAllInfoResponse;
+
+    native_size_t instance_id;
+
+    template <typename S>
+    void serialize(S& s) {
+        s.value8b(instance_id);
+    }
+};
+
 /**
  * The response to the `clap::ext::params::plugin::ValueToText` message defined
  * below.
@@ -299,10 +299,19 @@ struct ProcessResponse {
     clap_process_status result;
     clap::process::Process::Response output_data;
 
+    /**
+     * How long the plugin's `clap_plugin::process()` call took, in
+     * nanoseconds. This is only measured when `Process::measure_plugin_time`
+     * is set.
+     */
+    std::optional<uint64_t> plugin_time_ns;
+
     template <typename S>
     void serialize(S& s) {
         s.value4b(result);
         s.object(output_data);
+        s.ext(plugin_time_ns, bitsery::ext::InPlaceOptional{},
+              [](S& s, uint64_t& time) { s.value8b(time); });
     }
 };
 
@@ -333,12 +342,21 @@ struct Process {
      */
     std::optional<int> new_realtime_priority;
 
+    /**
+     * Whether the Wine plugin host should measure how long the plugin's
+     * `clap_plugin::process()` call takes and include that in the response.
+     * The native plugin uses this to tell why a processing cycle missed its
+     * deadline.
+     */
+    bool measure_plugin_time = false;
+
     template <typename S>
     void serialize(S& s) {
         s.value8b(instance_id);
         s.object(process);
         s.ext(new_realtime_priority, bitsery::ext::InPlaceOptional{},
               [](S& s, int& priority) { s.value4b(priority); });
+        s.value1b(measure_plugin_time);
     }
 };
 
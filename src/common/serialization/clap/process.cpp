@@ -19,6 +19,22 @@
 namespace clap {
 namespace process {
 
+/**
+ * Get the host's buffer for a channel within an audio port. Used to find
+ * channels that share the same buffer.
+ */
+static const void* channel_buffer(const clap_audio_buffer_t& buffer,
+                                  clap::audio_buffer::AudioBufferType type,
+                                  uint32_t channel) {
+    switch (type) {
+        case clap::audio_buffer::AudioBufferType::Float32:
+        default:
+            return buffer.data32[channel];
+        case clap::audio_buffer::AudioBufferType::Double64:
+            return buffer.data64[channel];
+    }
+}
+
 Process::Process() noexcept {}
 
 void Process::repopulate(const clap_process_t& process,
@@ -66,34 +82,22 @@ void Process::repopulate(const clap_process_t& process,
         if (process.audio_inputs[port].data32) {
             audio_inputs_type_[port] =
                 clap::audio_buffer::AudioBufferType::Float32;
-
-            // We copy the actual input audio for every bus to the shared memory
-            // object
-            for (uint32_t channel = 0;
-                 channel < process.audio_inputs[port].channel_count;
-                 channel++) {
-                std::copy_n(process.audio_inputs[port].data32[channel],
-                            frames_count_,
-                            shared_audio_buffers.input_channel_ptr<float>(
-                                port, channel));
-            }
         } else if (process.audio_inputs[port].data64) {
             audio_inputs_type_[port] =
                 clap::audio_buffer::AudioBufferType::Double64;
-
-            for (uint32_t channel = 0;
-                 channel < process.audio_inputs[port].channel_count;
-                 channel++) {
-                std::copy_n(process.audio_inputs[port].data64[channel],
-                            frames_count_,
-                            shared_audio_buffers.input_channel_ptr<double>(
-                                port, channel));
-            }
         } else {
             // Only reasonable-ish (it's still not reasonable) time where
             // neither of the pointers is set
             assert(process.audio_inputs[port].channel_count == 0);
         }
+
+        for (uint32_t channel = 0; channel < audio_inputs_[port].channel_count;
+             channel++) {
+            channel_alias_detector_.add_input(
+                port, channel,
+                channel_buffer(process.audio_inputs[port],
+                               audio_inputs_type_[port], channel));
+        }
     }
 
     audio_outputs_.resize(process.audio_outputs_count);
@@ -121,6 +125,62 @@ void Process::repopulate(const clap_process_t& process,
             // neither of the pointers is set
             assert(process.audio_outputs[port].channel_count == 0);
         }
+
+        for (uint32_t channel = 0; channel < audio_outputs_[port].channel_count;
+             channel++) {
+            channel_alias_detector_.add_output(
+                port, channel,
+                channel_buffer(process.audio_outputs[port],
+                               audio_outputs_type_[port], channel));
+        }
+    }
+
+    // If the host passed the same buffer for multiple channels, then we only
+    // need to copy those buffers once. The Wine plugin host will let the
+    // plugin use the same region of the shared memory object for all of them.
+    channel_aliases_ = channel_alias_detector_.update();
+
+    // We copy the actual input audio for every port to the shared memory object
+    size_t input_index = 0;
+    for (size_t port = 0; port < audio_inputs_.size(); port++) {
+        for (uint32_t channel = 0; channel < audio_inputs_[port].channel_count;
+             channel++) {
+            if (channel_alias_detector_.is_input_alias(input_index++)) {
+                continue;
+            }
+
+            // If the host marked a channel as constant then we don't need to
+            // read the host's buffer
+            const bool is_constant =
+                frames_count_ > 0 && channel < 64 &&
+                (process.audio_inputs[port].constant_mask &
+                 (static_cast<uint64_t>(1) << channel));
+            switch (audio_inputs_type_[port]) {
+                case clap::audio_buffer::AudioBufferType::Float32:
+                default: {
+                    const float* samples =
+                        process.audio_inputs[port].data32[channel];
+                    if (is_constant) {
+                        shared_audio_buffers.fill_input_channel(
+                            port, channel, samples[0], frames_count_);
+                    } else {
+                        shared_audio_buffers.write_input_channel(
+                            port, channel, samples, frames_count_);
+                    }
+                } break;
+                case clap::audio_buffer::AudioBufferType::Double64: {
+                    const double* samples =
+                        process.audio_inputs[port].data64[channel];
+                    if (is_constant) {
+                        shared_audio_buffers.fill_input_channel(
+                            port, channel, samples[0], frames_count_);
+                    } else {
+                        shared_audio_buffers.write_input_channel(
+                            port, channel, samples, frames_count_);
+                    }
+                } break;
+            }
+        }
     }
 
     in_events_.repopulate(*process.in_events);
@@ -200,11 +260,31 @@ Process::Response& Process::create_response() noexcept {
     return response_object_;
 }
 
+void Process::update_silent_outputs(
+    AudioShmBuffer& shared_audio_buffers) const noexcept {
+    for (size_t port = 0; port < audio_outputs_.size(); port++) {
+        switch (audio_outputs_type_[port]) {
+            case clap::audio_buffer::AudioBufferType::Float32:
+            default:
+                shared_audio_buffers.update_silent_outputs<float>(
+                    static_cast<uint32_t>(port),
+                    audio_outputs_[port].channel_count, frames_count_);
+                break;
+            case clap::audio_buffer::AudioBufferType::Double64:
+                shared_audio_buffers.update_silent_outputs<double>(
+                    static_cast<uint32_t>(port),
+                    audio_outputs_[port].channel_count, frames_count_);
+                break;
+        }
+    }
+}
+
 void Process::write_back_outputs(const clap_process_t& process,
                                  const AudioShmBuffer& shared_audio_buffers) {
     assert(process.audio_outputs && process.out_events);
 
     assert(audio_outputs_.size() == process.audio_outputs_count);
+    size_t output_index = 0;
     for (size_t port = 0; port < audio_outputs_.size(); port++) {
         process.audio_outputs[port].constant_mask =
             audio_outputs_[port].constant_mask;
@@ -215,6 +295,36 @@ void Process::write_back_outputs(const clap_process_t& process,
         // and the host's channel count
         for (size_t channel = 0; channel < audio_outputs_[port].channel_count;
              channel++) {
+            // The plugin wrote to the same region in the shared memory object
+            // for all channels sharing this buffer
+            if (channel_alias_detector_.is_output_alias(output_index++)) {
+                continue;
+            }
+
+            // The Wine plugin host checked which outputs are silent, so we can
+            // write zeroes for those instead of copying them. We'll also let
+            // the host know that these channels are constant.
+            if (shared_audio_buffers.output_channel_silent(port, channel)) {
+                switch (audio_outputs_type_[port]) {
+                    case clap::audio_buffer::AudioBufferType::Float32:
+                    default:
+                        std::fill_n(process.audio_outputs[port].data32[channel],
+                                    process.frames_count, 0.0f);
+                        break;
+                    case clap::audio_buffer::AudioBufferType::Double64:
+                        std::fill_n(process.audio_outputs[port].data64[channel],
+                                    process.frames_count, 0.0);
+                        break;
+                }
+
+                if (channel < 64) {
+                    process.audio_outputs[port].constant_mask |=
+                        static_cast<uint64_t>(1) << channel;
+                }
+
+                continue;
+            }
+
             // We copy the output audio for every bus from the shared memory
             // object back to the buffer provided by the host
             switch (audio_outputs_type_[port]) {
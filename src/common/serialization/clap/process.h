@@ -147,10 +147,20 @@ class Process {
      */
     Response& create_response() noexcept;
 
+    /**
+     * Check which output channels in `shared_audio_buffers` only contain
+     * zeroes. This is called on the Wine side after the plugin has finished
+     * processing, so `write_back_outputs()` can write zeroes to the host's
+     * buffers for those channels instead of copying them.
+     */
+    void update_silent_outputs(
+        AudioShmBuffer& shared_audio_buffers) const noexcept;
+
     /**
      * Write all of this output data back to the host's `clap_process_t` object.
      * During this process we'll also write the output audio from the
-     * corresponding shared memory audio buffers back.
+     * corresponding shared memory audio buffers back. Channels that
+     * `update_silent_outputs()` found to be silent are cleared instead.
      */
     void write_back_outputs(const clap_process_t& process,
                             const AudioShmBuffer& shared_audio_buffers);
@@ -173,6 +183,8 @@ class Process {
         // be empty on the Wine side. The response is sent back through the
         // separate `Response` object
         s.object(in_events_);
+
+        s.object(channel_aliases_);
     }
 
     // These fields are input and context data read from the original
@@ -217,6 +229,13 @@ class Process {
     clap::events::EventList in_events_;
     clap::events::EventList out_events_;
 
+    /**
+     * Input and output channels the host passed the same buffer for. These are
+     * only copied once, and on the Wine side the plugin will use the same
+     * region of the shared memory object for all of them.
+     */
+    AudioChannelAliases channel_aliases_;
+
    private:
     // These last few members are used on the Wine plugin host side to
     // reconstruct the original `clap_process_t` object. Here we also initialize
@@ -241,6 +260,11 @@ class Process {
      * `reconstruct()`.
      */
     clap_process_t reconstructed_process_data_{};
+
+    /**
+     * Used on the plugin side to populate `channel_aliases_`.
+     */
+    AudioChannelAliasDetector channel_alias_detector_;
 };
 
 }  // namespace process
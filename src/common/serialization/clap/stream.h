@@ -21,6 +21,8 @@
 #include <bitsery/traits/vector.h>
 #include <clap/stream.h>
 
+#include "../../bitsery/ext/shm-buffer.h"
+
 // Serialization messages for `clap/stream.h`
 
 namespace clap {
@@ -68,7 +70,9 @@ class Stream {
 
     template <typename S>
     void serialize(S& s) {
-        s.container1b(buffer_, 50 << 20);
+        // Large states are transferred through shared memory instead of being
+        // serialized, so this limit only applies to smaller states
+        s.ext(buffer_, bitsery::ext::ShmBuffer(50 << 20));
     }
 
    protected:
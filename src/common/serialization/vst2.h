@@ -26,6 +26,7 @@
 #include "../audio-shm.h"
 #include "../bitsery/ext/in-place-optional.h"
 #include "../bitsery/ext/in-place-variant.h"
+#include "../bitsery/ext/shm-buffer.h"
 #include "../bitsery/traits/small-vector.h"
 #include "../utils.h"
 #include "../vst24.h"
@@ -59,8 +60,9 @@ constexpr size_t max_midi_events = max_buffer_size;
 
 /**
  * The maximum size for the buffer we're receiving chunks in. Allows for up to
- * 50 MB chunks. Hopefully no plugin will come anywhere near this limit, but it
- * will add up when plugins start to audio include samples in their presets.
+ * 50 MB chunks. Chunks larger than `bitsery::ext::shm_buffer_threshold` are
+ * transferred through shared memory instead, and those are not bound by this
+ * limit.
  */
 constexpr size_t binary_buffer_size = 50 << 20;
 
@@ -83,7 +85,7 @@ struct ChunkData {
 
     template <typename S>
     void serialize(S& s) {
-        s.container1b(buffer, binary_buffer_size);
+        s.ext(buffer, bitsery::ext::ShmBuffer(binary_buffer_size));
     }
 };
 
@@ -528,6 +530,24 @@ struct Parameter {
     }
 };
 
+/**
+ * The response to a `Vst2ProcessRequest`. At this point the plugin's output
+ * audio has been written to the shared memory audio buffers.
+ */
+struct Vst2ProcessResponse {
+    /**
+     * How long the plugin's processing function took, in nanoseconds. This is
+     * only measured when `Vst2ProcessRequest::measure_plugin_time` is set.
+     */
+    std::optional<uint64_t> plugin_time_ns;
+
+    template <typename S>
+    void serialize(S& s) {
+        s.ext(plugin_time_ns, bitsery::ext::InPlaceOptional{},
+              [](S& s, uint64_t& time) { s.value8b(time); });
+    }
+};
+
 /**
  * When the host calls `processReplacing()`, `processDoubleReplacing()`, or the
  * deprecated `process()` function on our VST2 plugin, we'll write the input
@@ -536,7 +556,7 @@ struct Parameter {
  * host with the rest of the .
  */
 struct Vst2ProcessRequest {
-    using Response = Ack;
+    using Response = Vst2ProcessResponse;
 
     /**
      * The number of samples per channel. We'll trust the host to never provide
@@ -574,6 +594,32 @@ struct Vst2ProcessRequest {
      */
     std::optional<int> new_realtime_priority;
 
+    /**
+     * The input and output channels the host passed the same buffer for. Those
+     * are only copied to and from the shared memory object once, and the Wine
+     * plugin host will point the plugin to the same region in the shared
+     * memory object for all of them.
+     */
+    AudioChannelAliases channel_aliases;
+
+    /**
+     * Whether the Wine plugin host should measure how long the plugin's
+     * processing function takes and include that in the response. The native
+     * plugin uses this to tell why a processing cycle missed its deadline.
+     */
+    bool measure_plugin_time = false;
+
+    /**
+     * The MIDI events the host passed to `effProcessEvents()` since the last
+     * processing cycle. Hosts send these right before every processing call,
+     * so instead of doing a separate round trip to the Wine plugin host for
+     * those events, we'll queue them on the native plugin side and send them
+     * along with the processing request. The Wine plugin host will then pass
+     * these to the plugin right before it processes audio. In practice this
+     * will contain at most one element.
+     */
+    llvm::SmallVector<DynamicVstEvents, 1> midi_events;
+
     template <typename S>
     void serialize(S& s) {
         s.value4b(sample_frames);
@@ -584,6 +630,10 @@ struct Vst2ProcessRequest {
 
         s.ext(new_realtime_priority, bitsery::ext::InPlaceOptional{},
               [](S& s, int& priority) { s.value4b(priority); });
+
+        s.object(channel_aliases);
+        s.value1b(measure_plugin_time);
+        s.container(midi_events, max_midi_events);
     }
 };
 
@@ -77,6 +77,7 @@ using Vst3ControlRequest =
                  YaEditController::SetComponentState,
                  YaEditController::GetParameterCount,
                  YaEditController::GetParameterInfo,
+                 YaEditController::GetAllParameterInfo,
                  YaEditController::GetParamStringByValue,
                  YaEditController::GetParamValueByString,
                  YaEditController::NormalizedParamToPlain,
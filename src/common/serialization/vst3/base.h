@@ -38,9 +38,9 @@ using Steinberg::TBool, Steinberg::char16, Steinberg::int8, Steinberg::int16,
 constexpr size_t max_num_speakers = 16384;
 
 /**
- * The maximum size for an `IBStream` we can serialize. Allows for up to 50 MB
- * of preset data. Hopefully no plugin will come anywhere near this limit, but
- * it will add up when plugins start to include audio samples in their presets.
+ * The maximum size for an `IBStream` we can serialize over a socket. Allows for
+ * up to 50 MB of preset data. Larger streams are transferred through shared
+ * memory using `bitsery::ext::ShmBuffer`, so this limit doesn't apply to those.
  */
 constexpr size_t max_vector_stream_size = 50 << 20;
 
@@ -21,6 +21,7 @@
 #include <pluginterfaces/base/ibstream.h>
 #include <pluginterfaces/vst/ivstattributes.h>
 
+#include "../../bitsery/ext/shm-buffer.h"
 #include "attribute-list.h"
 #include "base.h"
 
@@ -90,7 +91,7 @@ class YaBStream : public Steinberg::IBStream,
 
     template <typename S>
     void serialize(S& s) {
-        s.container1b(buffer_, max_vector_stream_size);
+        s.ext(buffer_, bitsery::ext::ShmBuffer(max_vector_stream_size));
         // The seek position should always be initialized at 0
 
         s.value1b(supports_stream_attributes_);
@@ -227,10 +227,19 @@ class YaAudioProcessor : public Steinberg::Vst::IAudioProcessor {
         UniversalTResult result;
         YaProcessData::Response output_data;
 
+        /**
+         * How long the plugin's `IAudioProcessor::process()` call took, in
+         * nanoseconds. This is only measured when
+         * `Process::measure_plugin_time` is set.
+         */
+        std::optional<uint64_t> plugin_time_ns;
+
         template <typename S>
         void serialize(S& s) {
             s.object(result);
             s.object(output_data);
+            s.ext(plugin_time_ns, bitsery::ext::InPlaceOptional{},
+                  [](S& s, uint64_t& time) { s.value8b(time); });
         }
     };
 
@@ -261,6 +270,14 @@ class YaAudioProcessor : public Steinberg::Vst::IAudioProcessor {
          */
         std::optional<int> new_realtime_priority;
 
+        /**
+         * Whether the Wine plugin host should measure how long the plugin's
+         * `IAudioProcessor::process()` call takes and include that in the
+         * response. The native plugin uses this to tell why a processing cycle
+         * missed its deadline.
+         */
+        bool measure_plugin_time = false;
+
         template <typename S>
         void serialize(S& s) {
             s.value8b(instance_id);
@@ -268,6 +285,7 @@ class YaAudioProcessor : public Steinberg::Vst::IAudioProcessor {
 
             s.ext(new_realtime_priority, bitsery::ext::InPlaceOptional{},
                   [](S& s, int& priority) { s.value4b(priority); });
+            s.value1b(measure_plugin_time);
         }
     };
 
@@ -152,6 +152,38 @@ class YaEditController : public Steinberg::Vst::IEditController {
     getParameterInfo(int32 paramIndex,
                      Steinberg::Vst::ParameterInfo& info /*out*/) override = 0;
 
+    /**
+     * The results from calling `IEditController::getParameterInfo()` for every
+     * parameter index up to `IEditController::getParameterCount()`. The index
+     * in this vector is the parameter index.
+     */
+    struct GetAllParameterInfoResponse {
+        std::vector<GetParameterInfoResponse> parameters;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.container(parameters, 1 << 20);
+        }
+    };
+
+    /**
+     * Message to fetch the parameter count and the information for all
+     * parameters at once. This is not part of `IEditController`, but hosts will
+     * typically query the information for every single parameter when loading
+     * a plugin. Doing that with one message per parameter can take seconds for
+     * plugins with thousands of parameters.
+     */
+    struct GetAllParameterInfo {
+        using Response = GetAllParameterInfoResponse;
+
+        native_size_t instance_id;
+
+        template <typename S>
+        void serialize(S& s) {
+            s.value8b(instance_id);
+        }
+    };
+
     /**
      * The response code and returned parameter information for a call to
      * `IEditController::getParamStringByValue(id, value_normalized,
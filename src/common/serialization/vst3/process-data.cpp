@@ -43,20 +43,12 @@ void YaProcessData::repopulate(const Steinberg::Vst::ProcessData& process_data,
             process_data.inputs[bus].numChannels);
         inputs_[bus].silenceFlags = process_data.inputs[bus].silenceFlags;
 
-        // We copy the actual input audio for every bus to the shared memory
-        // object
+        // The 32-bit and 64-bit pointers are a union, so it doesn't matter
+        // which one we use for finding buffers shared between channels
         for (int channel = 0; channel < inputs_[bus].numChannels; channel++) {
-            if (process_data.symbolicSampleSize == Steinberg::Vst::kSample64) {
-                std::copy_n(process_data.inputs[bus].channelBuffers64[channel],
-                            process_data.numSamples,
-                            shared_audio_buffers.input_channel_ptr<double>(
-                                bus, channel));
-            } else {
-                std::copy_n(process_data.inputs[bus].channelBuffers32[channel],
-                            process_data.numSamples,
-                            shared_audio_buffers.input_channel_ptr<float>(
-                                bus, channel));
-            }
+            channel_alias_detector_.add_input(
+                bus, channel,
+                process_data.inputs[bus].channelBuffers32[channel]);
         }
     }
 
@@ -69,6 +61,54 @@ void YaProcessData::repopulate(const Steinberg::Vst::ProcessData& process_data,
             static_cast<int32>(shared_audio_buffers.num_output_channels(bus)),
             process_data.outputs[bus].numChannels);
         outputs_[bus].silenceFlags = process_data.outputs[bus].silenceFlags;
+
+        for (int channel = 0; channel < outputs_[bus].numChannels; channel++) {
+            channel_alias_detector_.add_output(
+                bus, channel,
+                process_data.outputs[bus].channelBuffers32[channel]);
+        }
+    }
+
+    // If the host passed the same buffer for multiple channels, then we only
+    // need to copy those buffers once. The Wine plugin host will let the
+    // plugin use the same region of the shared memory object for all of them.
+    channel_aliases_ = channel_alias_detector_.update();
+
+    // We copy the actual input audio for every bus to the shared memory object
+    size_t input_index = 0;
+    for (int bus = 0; bus < process_data.numInputs; bus++) {
+        for (int channel = 0; channel < inputs_[bus].numChannels; channel++) {
+            if (channel_alias_detector_.is_input_alias(input_index++)) {
+                continue;
+            }
+
+            // Channels the host marked as silent don't need to be read
+            const bool is_silent =
+                channel < 64 && (static_cast<uint64_t>(
+                                     process_data.inputs[bus].silenceFlags) &
+                                 (static_cast<uint64_t>(1) << channel));
+            if (process_data.symbolicSampleSize == Steinberg::Vst::kSample64) {
+                if (is_silent) {
+                    shared_audio_buffers.fill_input_channel<double>(
+                        bus, channel, 0, process_data.numSamples);
+                } else {
+                    shared_audio_buffers.write_input_channel(
+                        bus, channel,
+                        process_data.inputs[bus].channelBuffers64[channel],
+                        process_data.numSamples);
+                }
+            } else {
+                if (is_silent) {
+                    shared_audio_buffers.fill_input_channel<float>(
+                        bus, channel, 0, process_data.numSamples);
+                } else {
+                    shared_audio_buffers.write_input_channel(
+                        bus, channel,
+                        process_data.inputs[bus].channelBuffers32[channel],
+                        process_data.numSamples);
+                }
+            }
+        }
     }
 
     // Even though `ProcessData::inputParamterChanges` is mandatory, the VST3
@@ -197,10 +237,26 @@ YaProcessData::Response& YaProcessData::create_response() noexcept {
     return response_object_;
 }
 
+void YaProcessData::update_silent_outputs(
+    AudioShmBuffer& shared_audio_buffers) const noexcept {
+    for (size_t bus = 0; bus < outputs_.size(); bus++) {
+        if (symbolic_sample_size_ == Steinberg::Vst::kSample64) {
+            shared_audio_buffers.update_silent_outputs<double>(
+                static_cast<uint32_t>(bus), outputs_[bus].numChannels,
+                num_samples_);
+        } else {
+            shared_audio_buffers.update_silent_outputs<float>(
+                static_cast<uint32_t>(bus), outputs_[bus].numChannels,
+                num_samples_);
+        }
+    }
+}
+
 void YaProcessData::write_back_outputs(
     Steinberg::Vst::ProcessData& process_data,
     const AudioShmBuffer& shared_audio_buffers) {
     assert(static_cast<int32>(outputs_.size()) == process_data.numOutputs);
+    size_t output_index = 0;
     for (int bus = 0; bus < process_data.numOutputs; bus++) {
         process_data.outputs[bus].silenceFlags = outputs_[bus].silenceFlags;
 
@@ -209,6 +265,35 @@ void YaProcessData::write_back_outputs(
         //       `outputs[bus].numChannels` to the number of channels requested
         //       by the plugin during `YaProcessData::repopulate()`.
         for (int channel = 0; channel < outputs_[bus].numChannels; channel++) {
+            // The plugin wrote to the same region in the shared memory object
+            // for all channels sharing this buffer
+            if (channel_alias_detector_.is_output_alias(output_index++)) {
+                continue;
+            }
+
+            // The Wine plugin host checked which outputs are silent, so we can
+            // write zeroes for those instead of copying them. We'll also let
+            // the host know that these channels are silent.
+            if (shared_audio_buffers.output_channel_silent(bus, channel)) {
+                if (process_data.symbolicSampleSize ==
+                    Steinberg::Vst::kSample64) {
+                    std::fill_n(
+                        process_data.outputs[bus].channelBuffers64[channel],
+                        process_data.numSamples, 0.0);
+                } else {
+                    std::fill_n(
+                        process_data.outputs[bus].channelBuffers32[channel],
+                        process_data.numSamples, 0.0f);
+                }
+
+                if (channel < 64) {
+                    process_data.outputs[bus].silenceFlags |=
+                        static_cast<uint64_t>(1) << channel;
+                }
+
+                continue;
+            }
+
             // We copy the output audio for every bus from the shared memory
             // object back to the buffer provided by the host
             if (process_data.symbolicSampleSize == Steinberg::Vst::kSample64) {
@@ -145,10 +145,20 @@ class YaProcessData {
      */
     Response& create_response() noexcept;
 
+    /**
+     * Check which output channels in `shared_audio_buffers` only contain
+     * zeroes. This is called on the Wine side after the plugin has finished
+     * processing, so `write_back_outputs()` can write zeroes to the host's
+     * buffers for those channels instead of copying them.
+     */
+    void update_silent_outputs(
+        AudioShmBuffer& shared_audio_buffers) const noexcept;
+
     /**
      * Write all of this output data back to the host's `ProcessData` object.
      * During this process we'll also write the output audio from the
-     * corresponding shared memory audio buffers back.
+     * corresponding shared memory audio buffers back. Channels that
+     * `update_silent_outputs()` found to be silent are cleared instead.
      */
     void write_back_outputs(Steinberg::Vst::ProcessData& process_data,
                             const AudioShmBuffer& shared_audio_buffers);
@@ -174,6 +184,8 @@ class YaProcessData {
 
         s.ext(process_context_, bitsery::ext::InPlaceOptional{});
 
+        s.object(channel_aliases_);
+
         // We of course won't serialize the `reconstructed_process_data` and all
         // of the `output*` fields defined below it
     }
@@ -243,7 +255,21 @@ class YaProcessData {
      */
     std::optional<Steinberg::Vst::ProcessContext> process_context_;
 
+    /**
+     * The input and output channels the host passed the same buffer for. These
+     * are only copied to and from the shared memory object once. On the Wine
+     * side this should be applied to the pointers passed to `reconstruct()`
+     * using `ScopedAudioChannelAliases`.
+     */
+    AudioChannelAliases channel_aliases_;
+
    private:
+    /**
+     * Used on the plugin side during `repopulate()` to find the channels that
+     * share a buffer. This caches the results between processing cycles.
+     */
+    AudioChannelAliasDetector channel_alias_detector_;
+
     // These last few members are used on the Wine plugin host side to
     // reconstruct the original `ProcessData` object. Here we also initialize
     // these `output*` fields so the Windows VST3 plugin can write to them
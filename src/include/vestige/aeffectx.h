@@ -182,6 +182,8 @@ constexpr int kVstTransportPlaying = 1 << 1;
 constexpr int kVstTransportCycleActive = 1 << 2;
 constexpr int kVstTransportChanged = 1;
 
+constexpr int kVstProcessLevelOffline = 4;
+
 class RemoteVstPlugin;
 
 class VstMidiEvent {
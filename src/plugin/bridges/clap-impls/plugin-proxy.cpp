@@ -62,6 +62,7 @@ clap_plugin_proxy::clap_plugin_proxy(ClapPluginBridge& bridge,
       bridge_(bridge),
       instance_id_(instance_id),
       descriptor_(std::move(descriptor)),
+      process_timings_(bridge.create_process_timings(instance_id)),
       plugin_vtable_(clap_plugin_t{
           .desc = descriptor_.get(),
           .plugin_data = this,
@@ -131,6 +132,99 @@ clap_plugin_proxy::clap_plugin_proxy(ClapPluginBridge& bridge,
       // getting that many of them
       pending_callbacks_(128) {}
 
+void clap_plugin_proxy::clear_param_cache() {
+    std::lock_guard lock(param_cache_mutex_);
+    param_cache_.reset();
+    param_cache_generation_++;
+}
+
+std::unique_lock<std::mutex> clap_plugin_proxy::lock_param_cache() {
+    while (true) {
+        std::unique_lock lock(param_cache_mutex_);
+        if (param_cache_) {
+            // The audio thread could not update the values at some point, so
+            // we no longer know which of them are accurate
+            if (param_values_stale_.exchange(false)) {
+                for (auto& value : param_cache_->values) {
+                    value.reset();
+                }
+            }
+
+            return lock;
+        }
+
+        param_cache_fetching_ = true;
+        const uint64_t generation = param_cache_generation_;
+        lock.unlock();
+
+        const clap::ext::params::plugin::GetAllInfoResponse response =
+            bridge_.send_main_thread_message(
+                clap::ext::params::plugin::GetAllInfo{.instance_id =
+                                                          instance_id()});
+
+        ClapParamCache cache{};
+        cache.infos.reserve(response.infos.size());
+        cache.values.reserve(response.values.size());
+        for (size_t param_index = 0; param_index < response.infos.size();
+             param_index++) {
+            if (const auto& info = response.infos[param_index].result) {
+                clap_param_info_t param_info{};
+                info->reconstruct(param_info);
+
+                cache.index_by_id[param_info.id] = param_index;
+                cache.infos.push_back(param_info);
+            } else {
+                cache.infos.push_back(std::nullopt);
+            }
+
+            cache.values.push_back(response.values[param_index].result);
+        }
+
+        lock.lock();
+        param_cache_fetching_ = false;
+
+        // If the plugin asked for a rescan in the meantime, then this response
+        // may already be outdated
+        if (param_cache_generation_ != generation) {
+            continue;
+        }
+
+        if (param_values_stale_.exchange(false)) {
+            // Parameter values changed while we were waiting for the response,
+            // so the values we just received may also be out of date
+            for (auto& value : cache.values) {
+                value.reset();
+            }
+        }
+
+        param_cache_ = std::move(cache);
+
+        return lock;
+    }
+}
+
+void clap_plugin_proxy::update_cached_param_values(
+    const clap::events::EventList& events) {
+    std::unique_lock lock(param_cache_mutex_, std::try_to_lock);
+    if (!lock.owns_lock() || param_cache_fetching_) {
+        events.for_each_param_value([&](const clap_event_param_value_t&) {
+            param_values_stale_ = true;
+        });
+
+        return;
+    }
+    if (!param_cache_) {
+        return;
+    }
+
+    events.for_each_param_value([&](const clap_event_param_value_t& event) {
+        if (const auto index = param_cache_->index_by_id.find(event.param_id);
+            index != param_cache_->index_by_id.end()) {
+            param_cache_->values[index->second] = event.value;
+        }
+    });
+}
+
 bool CLAP_ABI clap_plugin_proxy::plugin_init(const struct clap_plugin* plugin) {
     assert(plugin && plugin->plugin_data);
     auto self = static_cast<clap_plugin_proxy*>(plugin->plugin_data);
@@ -163,6 +257,10 @@ clap_plugin_proxy::plugin_destroy(const struct clap_plugin* plugin) {
     self->bridge_.send_main_thread_message(
         clap::plugin::Destroy{.instance_id = self->instance_id()});
 
+    // `process_buffers_` gets destroyed together with `self` before the audio
+    // thread socket is removed, so it needs to be detached first
+    self->bridge_.set_audio_thread_shm_buffer(self->instance_id(), nullptr);
+
     // And this deallocates and destroys `self`
     self->bridge_.unregister_plugin_proxy(self->instance_id());
 }
@@ -176,6 +274,16 @@ bool CLAP_ABI clap_plugin_proxy::plugin_activate(
     assert(plugin && plugin->plugin_data);
     auto self = static_cast<clap_plugin_proxy*>(plugin->plugin_data);
 
+    // Parameter information may only change while the plugin is deactivated,
+    // so we'll fetch it again the next time the host asks for it
+    self->clear_param_cache();
+
+    // Used to detect processing cycles that miss their deadline
+    if (self->process_timings_) {
+        self->process_timings_->sample_rate.store(sample_rate,
+                                                  std::memory_order_relaxed);
+    }
+
     const clap::plugin::ActivateResponse response =
         self->bridge_.send_main_thread_message(
             clap::plugin::Activate{.instance_id = self->instance_id(),
@@ -189,6 +297,12 @@ bool CLAP_ABI clap_plugin_proxy::plugin_activate(
         if (!self->process_buffers_) {
             self->process_buffers_.emplace(
                 *response.updated_audio_buffers_config);
+
+            // The Wine plugin host already did the same thing on its side, so
+            // from now on audio thread control messages can be passed through
+            // the buffers' control block
+            self->bridge_.set_audio_thread_shm_buffer(
+                self->instance_id(), &*self->process_buffers_);
         } else {
             self->process_buffers_->resize(
                 *response.updated_audio_buffers_config);
@@ -240,6 +354,9 @@ clap_plugin_proxy::plugin_process(const struct clap_plugin* plugin,
     assert(plugin && plugin->plugin_data && process);
     auto self = static_cast<clap_plugin_proxy*>(plugin->plugin_data);
 
+    ScopedProcessTiming timing(self->process_timings_.get(),
+                               process->frames_count);
+
     // We'll synchronize the scheduling priority of the audio thread on the Wine
     // plugin host with that of the host's audio thread every once in a while
     std::optional<int> new_realtime_priority = std::nullopt;
@@ -259,6 +376,8 @@ clap_plugin_proxy::plugin_process(const struct clap_plugin* plugin,
     self->process_request_.process.repopulate(*process,
                                               *self->process_buffers_);
     self->process_request_.new_realtime_priority = new_realtime_priority;
+    self->process_request_.measure_plugin_time =
+        self->process_timings_ != nullptr;
 
     // HACK: This is a bit ugly. This `clap::process::Process::Response` object
     //       actually contains pointers to the corresponding `YaProcessData`
@@ -278,9 +397,14 @@ clap_plugin_proxy::plugin_process(const struct clap_plugin* plugin,
 
     // We'll also receive the response into an existing object so we can also
     // avoid heap allocations there
+    timing.start_round_trip();
     self->bridge_.receive_audio_thread_message_into(
         MessageReference<clap::plugin::Process>(self->process_request_),
         self->process_response_);
+    timing.end_round_trip();
+    timing.set_plugin_time(self->process_response_.plugin_time_ns);
+    timing.set_offline_processing(
+        self->process_buffers_->offline_processing());
 
     // At this point the shared audio buffers should contain the output audio,
     // so we'll write that back to the host along with any metadata (which in
@@ -289,6 +413,13 @@ clap_plugin_proxy::plugin_process(const struct clap_plugin* plugin,
     self->process_request_.process.write_back_outputs(*process,
                                                       *self->process_buffers_);
 
+    // The plugin will have processed the host's parameter changes, and it may
+    // also have output parameter changes of its own. Both of these are used to
+    // answer `clap_plugin_params::get_value()` without a round trip.
+    self->update_cached_param_values(self->process_request_.process.in_events_);
+    self->update_cached_param_values(
+        self->process_request_.process.out_events_);
+
     return self->process_response_.result;
 }
 
@@ -623,10 +754,13 @@ clap_plugin_proxy::ext_note_ports_get(const clap_plugin_t* plugin,
 uint32_t CLAP_ABI
 clap_plugin_proxy::ext_params_count(const clap_plugin_t* plugin) {
     assert(plugin && plugin->plugin_data);
-    auto self = static_cast<const clap_plugin_proxy*>(plugin->plugin_data);
+    auto self = static_cast<clap_plugin_proxy*>(plugin->plugin_data);
 
-    return self->bridge_.send_main_thread_message(
-        clap::ext::params::plugin::Count{.instance_id = self->instance_id()});
+    // The parameter information and values are fetched in bulk and then cached
+    // until the plugin asks for a rescan, see `ClapParamCache`
+    const auto lock = self->lock_param_cache();
+
+    return static_cast<uint32_t>(self->param_cache_->infos.size());
 }
 
 bool CLAP_ABI
@@ -634,15 +768,12 @@ clap_plugin_proxy::ext_params_get_info(const clap_plugin_t* plugin,
                                        uint32_t param_index,
                                        clap_param_info_t* param_info) {
     assert(plugin && plugin->plugin_data && param_info);
-    auto self = static_cast<const clap_plugin_proxy*>(plugin->plugin_data);
+    auto self = static_cast<clap_plugin_proxy*>(plugin->plugin_data);
 
-    const clap::ext::params::plugin::GetInfoResponse response =
-        self->bridge_.send_main_thread_message(
-            clap::ext::params::plugin::GetInfo{
-                .instance_id = self->instance_id(),
-                .param_index = param_index});
-    if (response.result) {
-        response.result->reconstruct(*param_info);
+    const auto lock = self->lock_param_cache();
+    if (param_index < self->param_cache_->infos.size() &&
+        self->param_cache_->infos[param_index]) {
+        *param_info = *self->param_cache_->infos[param_index];
 
         return true;
     } else {
@@ -655,8 +786,26 @@ clap_plugin_proxy::ext_params_get_value(const clap_plugin_t* plugin,
                                         clap_id param_id,
                                         double* value) {
     assert(plugin && plugin->plugin_data && value);
-    auto self = static_cast<const clap_plugin_proxy*>(plugin->plugin_data);
+    auto self = static_cast<clap_plugin_proxy*>(plugin->plugin_data);
+
+    {
+        const auto lock = self->lock_param_cache();
+        const auto index = self->param_cache_->index_by_id.find(param_id);
+        if (index == self->param_cache_->index_by_id.end()) {
+            return false;
+        }
+
+        if (const auto& cached_value =
+                self->param_cache_->values[index->second]) {
+            *value = *cached_value;
 
+            return true;
+        }
+    }
+
+    // If we don't know the parameter's current value, then we'll ask the
+    // plugin directly. The result will be cached if the plugin hasn't changed
+    // any parameter values in the meantime.
     const clap::ext::params::plugin::GetValueResponse response =
         self->bridge_.send_main_thread_message(
             clap::ext::params::plugin::GetValue{
@@ -664,6 +813,15 @@ clap_plugin_proxy::ext_params_get_value(const clap_plugin_t* plugin,
     if (response.result) {
         *value = *response.result;
 
+        std::lock_guard lock(self->param_cache_mutex_);
+        if (self->param_cache_ && !self->param_values_stale_) {
+            if (const auto index =
+                    self->param_cache_->index_by_id.find(param_id);
+                index != self->param_cache_->index_by_id.end()) {
+                self->param_cache_->values[index->second] = *response.result;
+            }
+        }
+
         return true;
     } else {
         return false;
@@ -722,7 +880,7 @@ clap_plugin_proxy::ext_params_flush(const clap_plugin_t* plugin,
                                     const clap_input_events_t* in,
                                     const clap_output_events_t* out) {
     assert(plugin && plugin->plugin_data && in && out);
-    auto self = static_cast<const clap_plugin_proxy*>(plugin->plugin_data);
+    auto self = static_cast<clap_plugin_proxy*>(plugin->plugin_data);
 
     // This will not allocate below 64 events. Since flush will primarily be
     // called on the main thread, we don't really care about minimizing
@@ -730,6 +888,10 @@ clap_plugin_proxy::ext_params_flush(const clap_plugin_t* plugin,
     clap::events::EventList events{};
     events.repopulate(*in);
 
+    // Like in `clap_plugin::process()`, this lets us keep our cached parameter
+    // values in sync with the plugin
+    self->update_cached_param_values(events);
+
     // This may also be called on the audio thread and it is never called during
     // process, so always using the audio thread here is safe
     const clap::ext::params::plugin::FlushResponse response =
@@ -738,6 +900,7 @@ clap_plugin_proxy::ext_params_flush(const clap_plugin_t* plugin,
                                              .in = std::move(events)});
 
     response.out.write_back_outputs(*out);
+    self->update_cached_param_values(response.out);
 }
 
 bool CLAP_ABI clap_plugin_proxy::ext_render_has_hard_realtime_requirement(
@@ -780,11 +943,17 @@ bool CLAP_ABI clap_plugin_proxy::ext_state_save(const clap_plugin_t* plugin,
 bool CLAP_ABI clap_plugin_proxy::ext_state_load(const clap_plugin_t* plugin,
                                                 const clap_istream_t* stream) {
     assert(plugin && plugin->plugin_data && stream);
-    auto self = static_cast<const clap_plugin_proxy*>(plugin->plugin_data);
+    auto self = static_cast<clap_plugin_proxy*>(plugin->plugin_data);
 
-    return self->bridge_.send_main_thread_message(
+    const bool result = self->bridge_.send_main_thread_message(
         clap::ext::state::plugin::Load{.instance_id = self->instance_id(),
                                        .stream = *stream});
+
+    // Loading a state will likely change the plugin's parameter values, and
+    // plugins don't always report those changes through a rescan
+    self->clear_param_cache();
+
+    return result;
 }
 
 uint32_t CLAP_ABI clap_plugin_proxy::ext_tail_get(const clap_plugin_t* plugin) {
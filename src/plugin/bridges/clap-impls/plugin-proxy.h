@@ -16,8 +16,11 @@
 
 #pragma once
 
+#include <atomic>
 #include <future>
+#include <mutex>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include <clap/ext/audio-ports.h>
@@ -76,6 +79,35 @@ struct ClapHostExtensions {
     const clap_host_voice_info_t* voice_info = nullptr;
 };
 
+/**
+ * A local copy of the bridged plugin's parameter information and values. This
+ * is fetched in a single `clap::ext::params::plugin::GetAllInfo` request the
+ * first time the host queries the plugin's parameters, so
+ * `clap_plugin_params::count()`, `clap_plugin_params::get_info()`, and
+ * `clap_plugin_params::get_value()` can be answered without a round trip to
+ * the Wine plugin host. The values are kept up to date using the parameter
+ * value events passed to and from the plugin.
+ *
+ * @relates clap_plugin_proxy
+ */
+struct ClapParamCache {
+    /**
+     * The information for every parameter index. This is a nullopt if the
+     * plugin's `clap_plugin_params::get_info()` returned false for that index.
+     */
+    std::vector<std::optional<clap_param_info_t>> infos;
+    /**
+     * The current value for the parameter at the same index in `infos`. A
+     * nullopt means that the value is not known, in which case it will be
+     * requested from the plugin when the host asks for it.
+     */
+    std::vector<std::optional<double>> values;
+    /**
+     * Maps parameter IDs to indices in `infos` and `values`.
+     */
+    std::unordered_map<clap_id, size_t> index_by_id;
+};
+
 /**
  * A proxy for a `clap_plugin`.
  */
@@ -149,6 +181,16 @@ class clap_plugin_proxy {
         return response_future;
     }
 
+    /**
+     * Drop the cached parameter information and values. They will be fetched
+     * again the next time the host queries the plugin's parameters. Called when
+     * the plugin asks the host to rescan its parameters, and after activating
+     * the plugin or loading a new state.
+     *
+     * @see ClapParamCache
+     */
+    void clear_param_cache();
+
     /**
      * The `clap_host_t*` passed when creating the instance. Any callbacks made
      * by the proxied plugin instance must go through here.
@@ -275,6 +317,24 @@ class clap_plugin_proxy {
                                             clap_voice_info_t* info);
 
    private:
+    /**
+     * Lock `param_cache_`, fetching the plugin's parameter information and
+     * values in one go first if we haven't done so already. The mutex is not
+     * held while waiting for the response so the audio thread never gets
+     * blocked by this. `param_cache_` is guaranteed to contain a value as long
+     * as the returned lock is held.
+     */
+    std::unique_lock<std::mutex> lock_param_cache();
+
+    /**
+     * Update the cached parameter values using the `CLAP_EVENT_PARAM_VALUE`
+     * events in an event list. This is called on the audio thread after every
+     * process call and after `clap_plugin_params::flush()`, so this never
+     * blocks. If the cache is in use or if it's currently being fetched, then
+     * we'll set `param_values_stale_` instead.
+     */
+    void update_cached_param_values(const clap::events::EventList& events);
+
     ClapPluginBridge& bridge_;
     size_t instance_id_;
     clap::plugin::Descriptor descriptor_;
@@ -320,6 +380,42 @@ class clap_plugin_proxy {
      */
     clap::plugin::ProcessResponse process_response_;
 
+    /**
+     * The plugin's parameter information and values, fetched by
+     * `lock_param_cache()`. This is a nullopt until the host first queries
+     * the plugin's parameters, and it will be reset by `clear_param_cache()`.
+     */
+    std::optional<ClapParamCache> param_cache_;
+    /**
+     * Guards `param_cache_`, `param_cache_fetching_`, and
+     * `param_cache_generation_`. The audio thread only ever tries to lock this.
+     */
+    std::mutex param_cache_mutex_;
+    /**
+     * Set while `lock_param_cache()` is waiting for the plugin's response.
+     * Value changes that happen during that time may not be reflected in the
+     * response.
+     */
+    bool param_cache_fetching_ = false;
+    /**
+     * Incremented by `clear_param_cache()`. This lets `lock_param_cache()`
+     * discard a response that was requested before the cache was cleared.
+     */
+    uint64_t param_cache_generation_ = 0;
+    /**
+     * Set on the audio thread when it could not update the cached parameter
+     * values. The next parameter query on the main thread will then forget all
+     * cached values so they are requested from the plugin again.
+     */
+    std::atomic_bool param_values_stale_ = false;
+
+    /**
+     * Timing information for audio processing, used to detect late processing
+     * cycles. This is a null pointer when the `disable_xrun_warnings` option is
+     * enabled, unless `YABRIDGE_DEBUG_LEVEL` contains `+timing`.
+     */
+    std::shared_ptr<ProcessTimings> process_timings_;
+
     /**
      * The vtable for `clap_plugin`, requires that this object is never moved or
      * copied. We'll use the host data pointer instead of placing this vtable at
@@ -218,6 +218,15 @@ ClapPluginBridge::ClapPluginBridge(const ghc::filesystem::path& plugin_path)
                     const auto& [plugin_proxy, _] =
                         get_proxy(request.owner_instance_id);
 
+                    // The host will likely query the new parameter information
+                    // or values right away, so our cached copy needs to be
+                    // dropped first
+                    if (request.flags &
+                        (CLAP_PARAM_RESCAN_VALUES | CLAP_PARAM_RESCAN_INFO |
+                         CLAP_PARAM_RESCAN_ALL)) {
+                        plugin_proxy.clear_param_cache();
+                    }
+
                     plugin_proxy
                         .run_on_main_thread(
                             [&, host = plugin_proxy.host_,
@@ -30,6 +30,8 @@
 #include "../../common/notifications.h"
 #include "../../common/utils.h"
 #include "../host-process.h"
+#include "../process-timing.h"
+#include "../stats-server.h"
 
 /**
  * If the amount of lockable memory is below this, then we'll warn about it
@@ -89,6 +91,7 @@ class PluginBridge {
           sockets_(create_socket_instance(io_context_, info_)),
           generic_logger_(Logger::create_from_environment(
               create_logger_prefix(sockets_.base_dir_))),
+          process_timing_reporter_(generic_logger_),
           plugin_host_(
               config_.group
                   ? std::unique_ptr<HostProcess>(std::make_unique<GroupHost>(
@@ -127,11 +130,50 @@ class PluginBridge {
               pthread_setname_np(pthread_self(), "wine-stdio");
 
               io_context_.run();
-          }) {}
+          }) {
+        // The sockets have already registered themselves with this object if
+        // `YABRIDGE_STATS` is set
+        if (std::shared_ptr<BridgeStats> stats =
+                BridgeStats::get(sockets_.base_dir_)) {
+            try {
+                stats_server_.emplace(
+                    std::move(stats),
+                    std::vector<std::pair<std::string_view, std::string>>{
+                        {"type", plugin_type_to_string(info_.plugin_type_)},
+                        {"native_path", info_.native_library_path_.string()},
+                        {"windows_path", info_.windows_plugin_path_.string()},
+                    });
+            } catch (const std::system_error& error) {
+                generic_logger_.log(
+                    "WARNING: Could not create the statistics socket: " +
+                    std::string(error.what()));
+            }
+        }
+    }
 
     virtual ~PluginBridge() noexcept = default;
 
    protected:
+    /**
+     * Create an object for keeping track of how long audio processing takes for
+     * a plugin instance. This is used to report processing cycles that missed
+     * their deadline, and to print timing summaries if `YABRIDGE_DEBUG_LEVEL`
+     * contains `+timing`. The instance should keep the returned object alive
+     * for as long as it exists.
+     *
+     * @param name A name to identify the plugin instance by in the log.
+     *
+     * @return A null pointer if the `disable_xrun_warnings` option is enabled
+     *   and process timing is not enabled.
+     */
+    std::shared_ptr<ProcessTimings> create_process_timings(std::string name) {
+        if (config_.disable_xrun_warnings && !generic_logger_.process_timing_) {
+            return nullptr;
+        }
+
+        return process_timing_reporter_.add_instance(std::move(name));
+    }
+
     /**
      * Format and log all relevant debug information during initialization.
      */
@@ -288,6 +330,9 @@ class PluginBridge {
                 "hack: pipes disabled, plugin output will go to \"" +
                 config_.disable_pipes->string() + "\"");
         }
+        if (config_.disable_xrun_warnings) {
+            other_options.push_back("audio: no xrun warnings");
+        }
         if (config_.editor_coordinate_hack) {
             other_options.push_back("editor: coordinate hack");
         }
@@ -306,9 +351,18 @@ class PluginBridge {
                    << *config_.frame_rate << " fps";
             other_options.push_back(option.str());
         }
+        if (config_.futex_audio_signalling) {
+            other_options.push_back("audio: futex signalling");
+        }
         if (config_.hide_daw) {
             other_options.push_back("hack: hide DAW name");
         }
+        if (config_.pipelined_processing) {
+            other_options.push_back("audio: pipelined processing");
+        }
+        if (config_.vst2_parameter_cache) {
+            other_options.push_back("vst2: parameter cache");
+        }
         if (config_.vst3_prefer_32bit) {
             other_options.push_back("vst3: prefer 32-bit");
         }
@@ -387,6 +441,7 @@ class PluginBridge {
                     generic_logger_.log(
                         "The Wine host process has exited unexpectedly. Check "
                         "the output above for more information.");
+                    generic_logger_.flush();
 
                     // Also show a desktop notification so users running from
                     // the GUI get a heads up
@@ -470,6 +525,24 @@ class PluginBridge {
      */
     Logger generic_logger_;
 
+    /**
+     * Prints late processing cycles for this bridge's plugin instances, and
+     * periodically prints their timing information when `YABRIDGE_DEBUG_LEVEL`
+     * contains `+timing`.
+     *
+     * @see PluginBridge::create_process_timings
+     */
+    ProcessTimingReporter process_timing_reporter_;
+
+    /**
+     * Serves live statistics for this bridge's sockets on
+     * `<base_dir>/stats.sock`. Only set when the `YABRIDGE_STATS` environment
+     * variable is set.
+     *
+     * @see BridgeStats
+     */
+    std::optional<StatsServer> stats_server_;
+
     /**
      * The Wine process hosting our plugins. In the case of group hosts a
      * `PluginBridge` instance doesn't actually own a process, but rather either
@@ -16,9 +16,25 @@
 
 #include "vst2.h"
 
+#include "../../common/audio-kernels.h"
 #include "../../common/communication/vst2.h"
 #include "../utils.h"
 
+/**
+ * How long a cached `effGetParamDisplay()` string stays valid, even when the
+ * parameter's value has not changed. See
+ * `Vst2PluginBridge::CachedParameterDisplay`.
+ */
+constexpr std::chrono::milliseconds parameter_display_cache_duration(500);
+
+/**
+ * The maximum number of `effProcessEvents()` calls we'll queue up until the
+ * next processing cycle. Hosts normally call this once or twice before every
+ * processing cycle, so this only kicks in when a host keeps sending events
+ * without processing any audio. Any events past this limit are dropped.
+ */
+constexpr size_t max_outgoing_midi_event_batches = 64;
+
 intptr_t dispatch_proxy(AEffect*, int, int, intptr_t, void*, float);
 void process_proxy(AEffect*, float**, float**, int);
 void process_replacing_proxy(AEffect*, float**, float**, int);
@@ -53,7 +69,12 @@ Vst2PluginBridge::Vst2PluginBridge(const ghc::filesystem::path& plugin_path,
       // bridge will crash otherwise
       plugin_(),
       host_callback_function_(host_callback),
-      logger_(generic_logger_) {
+      logger_(generic_logger_),
+      process_timings_(create_process_timings(
+          info_.windows_plugin_path_.filename().string())),
+      process_stats_(SocketStats::for_endpoint(
+          (sockets_.base_dir_ / "host_plugin_process_replacing.sock")
+              .string())) {
     log_init_message();
 
     // This will block until all sockets have been connected to by the Wine VST
@@ -81,6 +102,24 @@ Vst2PluginBridge::Vst2PluginBridge(const ghc::filesystem::path& plugin_path,
             std::pair<Vst2Logger&, bool>(logger_, false),
             [&](Vst2Event& event, bool /*on_main_thread*/) {
                 switch (event.opcode) {
+                    // The `AEffect` sent along with this contains the plugin's
+                    // own latency. When using pipelined processing we'll need
+                    // to add our own latency to that before the host sees it.
+                    case audioMasterIOChanged: {
+                        // The plugin may have changed its parameters, so any
+                        // cached parameter names are no longer valid
+                        clear_parameter_string_cache();
+
+                        if (config_.pipelined_processing) {
+                            std::get<AEffect>(event.payload).initialDelay +=
+                                static_cast<int>(pipelined_outputs_.latency());
+                        }
+                    } break;
+                    // The plugin uses this to tell the host to refresh its
+                    // parameter names and display strings
+                    case audioMasterUpdateDisplay: {
+                        clear_parameter_string_cache();
+                    } break;
                     // MIDI events sent from the plugin back to the host are
                     // a special case here. They have to sent during the
                     // `processReplacing()` function or else the host will
@@ -190,10 +229,21 @@ Vst2PluginBridge::Vst2PluginBridge(const ghc::filesystem::path& plugin_path,
     // back to complete the startup process
     sockets_.host_plugin_control_.send(config_);
 
+    // When the parameter cache has been enabled, the Wine plugin host will
+    // then set up the shared parameter table and send us its configuration
+    if (config_.vst2_parameter_cache) {
+        parameter_table_.emplace(
+            sockets_.host_plugin_control_
+                .receive_single<ParameterShmTable::Config>());
+    }
+
     update_aeffect(plugin_, initialized_plugin);
 }
 
 Vst2PluginBridge::~Vst2PluginBridge() noexcept {
+    // `process_buffers_` is destroyed before the sockets in the base class
+    sockets_.host_plugin_process_replacing_.set_shm_buffer(nullptr);
+
     try {
         // Drop all work make sure all sockets are closed
         plugin_host_->terminate();
@@ -211,10 +261,12 @@ Vst2PluginBridge::~Vst2PluginBridge() noexcept {
 class DispatchDataConverter : public DefaultDataConverter {
    public:
     DispatchDataConverter(std::optional<AudioShmBuffer>& process_buffers,
+                          SocketHandler& process_socket,
                           std::vector<uint8_t>& chunk_data,
                           AEffect& plugin,
                           VstRect& editor_rectangle) noexcept
         : process_buffers_(process_buffers),
+          process_socket_(process_socket),
           chunk_(chunk_data),
           plugin_(plugin),
           rect_(editor_rectangle) {}
@@ -392,6 +444,12 @@ class DispatchDataConverter : public DefaultDataConverter {
                             &response.payload)) {
                     if (!process_buffers_) {
                         process_buffers_.emplace(*audio_buffer_config);
+
+                        // The Wine plugin host has already attached its side
+                        // of the buffers to the socket at this point, so the
+                        // processing requests can now be passed through the
+                        // shared memory object's control block
+                        process_socket_.set_shm_buffer(&*process_buffers_);
                     } else {
                         process_buffers_->resize(*audio_buffer_config);
                     }
@@ -501,6 +559,7 @@ class DispatchDataConverter : public DefaultDataConverter {
 
    private:
     std::optional<AudioShmBuffer>& process_buffers_;
+    SocketHandler& process_socket_;
     std::vector<uint8_t>& chunk_;
     AEffect& plugin_;
     VstRect& rect_;
@@ -529,8 +588,9 @@ intptr_t Vst2PluginBridge::dispatch(AEffect* /*plugin*/,
         return 0;
     }
 
-    DispatchDataConverter converter(process_buffers_, chunk_data_, plugin_,
-                                    editor_rectangle_);
+    DispatchDataConverter converter(process_buffers_,
+                                    sockets_.host_plugin_process_replacing_,
+                                    chunk_data_, plugin_, editor_rectangle_);
 
     switch (opcode) {
         case effClose: {
@@ -585,6 +645,68 @@ intptr_t Vst2PluginBridge::dispatch(AEffect* /*plugin*/,
             logger_.log_event_response(true, opcode, 0, nullptr, std::nullopt);
             return 0;
         }; break;
+        case effSetSampleRate: {
+            // Used to detect processing cycles that miss their deadline
+            if (process_timings_) {
+                process_timings_->sample_rate.store(option,
+                                                    std::memory_order_relaxed);
+            }
+        } break;
+        case effSetBlockSize: {
+            // Needed to determine the latency for pipelined processing. This
+            // mirrors what the Wine plugin host does in
+            // `Vst2Bridge::setup_shared_audio_buffers()`.
+            max_samples_per_block_ = static_cast<uint32_t>(value);
+        } break;
+        case effMainsChanged: {
+            // With pipelined processing the Wine plugin host may still be
+            // processing the last block of audio. Its output is no longer
+            // needed, but we do need to wait for it before the plugin gets
+            // suspended. Hosts won't call this while they're processing audio,
+            // so we can safely do this from here.
+            if (process_request_in_flight_) {
+                SerializationBuffer<256> buffer{};
+                finish_process_request(buffer);
+            }
+
+            // Any MIDI events that were queued up before the plugin got
+            // suspended or resumed should not end up in the next processing
+            // cycle
+            std::lock_guard lock(outgoing_midi_events_mutex_);
+            outgoing_midi_events_.clear();
+            dropping_outgoing_midi_events_ = false;
+        } break;
+        case effProcessEvents: {
+            // Hosts send MIDI events right before every processing cycle. These
+            // events will be sent to the Wine plugin host together with the
+            // next audio processing request, so we don't need to do a separate
+            // round trip here. The return value of this function is not used
+            // for anything, and plugins will always return 1 here.
+            Vst2Event::Payload payload(std::in_place_type<DynamicVstEvents>,
+                                       *static_cast<const VstEvents*>(data));
+            logger_.log_event(true, opcode, index, value, payload, option,
+                              std::nullopt);
+
+            {
+                std::lock_guard lock(outgoing_midi_events_mutex_);
+                if (outgoing_midi_events_.size() <
+                    max_outgoing_midi_event_batches) {
+                    outgoing_midi_events_.push_back(
+                        std::move(std::get<DynamicVstEvents>(payload)));
+                } else if (!dropping_outgoing_midi_events_) {
+                    // We'll only warn about this once until the queue gets
+                    // emptied again
+                    dropping_outgoing_midi_events_ = true;
+                    logger_.log(
+                        "WARNING: The host keeps sending MIDI events without "
+                        "processing audio, dropping events until the next "
+                        "processing cycle");
+                }
+            }
+
+            logger_.log_event_response(true, opcode, 1, nullptr, std::nullopt);
+            return 1;
+        }; break;
         case effCanDo: {
             const std::string query(static_cast<const char*>(data));
 
@@ -610,6 +732,14 @@ intptr_t Vst2PluginBridge::dispatch(AEffect* /*plugin*/,
                 return -1;
             }
         } break;
+        case effGetParamName:
+        case effGetParamLabel:
+        case effGetParamDisplay: {
+            if (parameter_table_) {
+                return dispatch_parameter_string(converter, opcode, index,
+                                                 value, data, option);
+            }
+        } break;
     }
 
     // We don't reuse any buffers here like we do for audio processing. This
@@ -617,18 +747,177 @@ intptr_t Vst2PluginBridge::dispatch(AEffect* /*plugin*/,
     // and loading plugin state it's much better to have bitsery or our
     // receiving function temporarily allocate a large enough buffer rather than
     // to have a bunch of allocated memory sitting around doing nothing.
-    return sockets_.host_plugin_dispatch_.send_event(
+    const intptr_t return_value = sockets_.host_plugin_dispatch_.send_event(
+        converter, std::pair<Vst2Logger&, bool>(logger_, true), opcode, index,
+        value, data, option);
+
+    // Loading a program or new state may change the plugin's parameter names
+    // and how their values are displayed
+    switch (opcode) {
+        case effOpen:
+        case effSetProgram:
+        case effEndSetProgram:
+        case effSetChunk:
+            clear_parameter_string_cache();
+            break;
+    }
+
+    // With pipelined processing we need to add our own latency on top of the
+    // plugin's. `effOpen()` will have overwritten our `AEffect`'s values with
+    // the plugin's values, and the latency can only be determined once the
+    // host resumes audio processing.
+    if (config_.pipelined_processing) {
+        if (opcode == effOpen) {
+            plugin_.initialDelay +=
+                static_cast<int>(pipelined_outputs_.latency());
+        } else if (opcode == effMainsChanged && value == 1) {
+            update_pipelined_latency();
+        }
+    }
+
+    return return_value;
+}
+
+intptr_t Vst2PluginBridge::dispatch_parameter_string(
+    DefaultDataConverter& converter,
+    int opcode,
+    int index,
+    intptr_t value,
+    void* data,
+    float option) {
+    // Display strings are only cached for the parameter's current value, so we
+    // need to know that value before sending the event
+    const std::optional<float> current_value =
+        opcode == effGetParamDisplay ? parameter_table_->get(index)
+                                     : std::nullopt;
+    const auto now = std::chrono::steady_clock::now();
+
+    std::optional<CachedParameterString> cached;
+    uint64_t generation;
+    {
+        std::lock_guard lock(parameter_string_cache_mutex_);
+        generation = parameter_string_cache_generation_;
+        switch (opcode) {
+            case effGetParamName:
+                if (auto it = parameter_string_cache_.names.find(index);
+                    it != parameter_string_cache_.names.end()) {
+                    cached = it->second;
+                }
+                break;
+            case effGetParamLabel:
+                if (auto it = parameter_string_cache_.labels.find(index);
+                    it != parameter_string_cache_.labels.end()) {
+                    cached = it->second;
+                }
+                break;
+            case effGetParamDisplay:
+                if (auto it = parameter_string_cache_.displays.find(index);
+                    current_value &&
+                    it != parameter_string_cache_.displays.end() &&
+                    it->second.value == *current_value &&
+                    now - it->second.fetched_at <
+                        parameter_display_cache_duration) {
+                    cached = it->second.display;
+                }
+                break;
+        }
+    }
+
+    if (cached) {
+        logger_.log_event(true, opcode, index, value, WantsString{}, option,
+                          std::nullopt);
+
+        char* output = static_cast<char*>(data);
+        std::copy(cached->string.begin(), cached->string.end(), output);
+        output[cached->string.size()] = 0;
+
+        logger_.log_event_response(true, opcode, cached->return_value,
+                                   cached->string, std::nullopt, true);
+
+        return cached->return_value;
+    }
+
+    const intptr_t return_value = sockets_.host_plugin_dispatch_.send_event(
         converter, std::pair<Vst2Logger&, bool>(logger_, true), opcode, index,
         value, data, option);
+
+    // The response has already been written to `data` at this point
+    CachedParameterString result{
+        .return_value = return_value,
+        .string = std::string(static_cast<const char*>(data))};
+
+    // If the plugin told the host that its parameters changed while we were
+    // waiting for the response, then this string may already be outdated
+    std::lock_guard lock(parameter_string_cache_mutex_);
+    if (parameter_string_cache_generation_ != generation) {
+        return return_value;
+    }
+
+    switch (opcode) {
+        case effGetParamName:
+            parameter_string_cache_.names[index] = std::move(result);
+            break;
+        case effGetParamLabel:
+            parameter_string_cache_.labels[index] = std::move(result);
+            break;
+        case effGetParamDisplay:
+            if (current_value) {
+                parameter_string_cache_.displays[index] =
+                    CachedParameterDisplay{.display = std::move(result),
+                                           .value = *current_value,
+                                           .fetched_at = now};
+            }
+            break;
+    }
+
+    return return_value;
+}
+
+void Vst2PluginBridge::clear_parameter_string_cache() noexcept {
+    std::lock_guard lock(parameter_string_cache_mutex_);
+    parameter_string_cache_ = ParameterStringCache{};
+    parameter_string_cache_generation_++;
+}
+
+void Vst2PluginBridge::update_pipelined_latency() {
+    // This is the same fallback the Wine plugin host uses when the host never
+    // called `effSetBlockSize()`
+    const uint32_t new_latency =
+        max_samples_per_block_
+            ? *max_samples_per_block_
+            : static_cast<uint32_t>(host_callback_function_(
+                  &plugin_, audioMasterGetBlockSize, 0, 0, nullptr, 0.0));
+    if (new_latency == 0) {
+        logger_.log(
+            "WARNING: The host did not report a block size, so pipelined "
+            "processing will be disabled.");
+    }
+
+    const uint32_t old_latency = pipelined_outputs_.latency();
+    pipelined_outputs_.reset(plugin_.numOutputs, new_latency);
+
+    // Plugins are supposed to call `audioMasterIOChanged()` during
+    // `effMainsChanged()` when their latency changes, so that's what we'll do
+    // as well
+    if (new_latency != old_latency) {
+        plugin_.initialDelay +=
+            static_cast<int>(new_latency) - static_cast<int>(old_latency);
+        host_callback_function_(&plugin_, audioMasterIOChanged, 0, 0, nullptr,
+                                0.0);
+    }
 }
 
 template <typename T, bool replacing>
 // NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
 void Vst2PluginBridge::do_process(T** inputs, T** outputs, int sample_frames) {
+    ScopedProcessTiming timing(process_timings_.get(),
+                               static_cast<uint32_t>(sample_frames));
+
     // During audio processing we'll write the inputs to shared memory buffers,
     // and we'll then send this request alongside it with additional information
-    // needed to process audio
-    Vst2ProcessRequest request{};
+    // needed to process audio. This object is reused between calls so the
+    // channel aliases don't need to be reallocated every processing cycle.
+    Vst2ProcessRequest& request = process_request_;
 
     // To prevent unnecessary bridging overhead, we'll send the time information
     // together with the buffers because basically every plugin needs this
@@ -675,50 +964,161 @@ void Vst2PluginBridge::do_process(T** inputs, T** outputs, int sample_frames) {
     // two up even though it really shouldn't do that and some plugins won't be
     // able to handle that)
     request.sample_frames = sample_frames;
+    request.measure_plugin_time = process_timings_ != nullptr;
     if constexpr (std::is_same_v<T, double>) {
         request.double_precision = true;
     } else {
         static_assert(std::is_same_v<T, float>);
+        request.double_precision = false;
+    }
+
+    // Blocks that don't fit in the pipelined output queue are processed
+    // synchronously. This only happens when the block size is unknown or when
+    // the host sends more samples than it said it would, and it causes a
+    // discontinuity but it won't overflow the queue.
+    const bool pipelined =
+        config_.pipelined_processing &&
+        pipelined_outputs_.can_process(static_cast<uint32_t>(sample_frames));
+
+    // Some hosts pass the same buffer for multiple channels. Those buffers only
+    // need to be copied once, and the Wine plugin host will then reuse the same
+    // region in the shared memory object for all of those channels. The old
+    // accumulating `process()` function adds every output channel to the
+    // host's buffers, so we can't merge output channels there. With pipelined
+    // processing the outputs belong to the previous processing cycle, so we
+    // also can't merge them there.
+    for (int channel = 0; channel < plugin_.numInputs; channel++) {
+        channel_alias_detector_.add_input(0, channel, inputs[channel]);
+    }
+    if constexpr (replacing) {
+        if (!pipelined) {
+            for (int channel = 0; channel < plugin_.numOutputs; channel++) {
+                channel_alias_detector_.add_output(0, channel,
+                                                   outputs[channel]);
+            }
+        }
+    }
+    request.channel_aliases = channel_alias_detector_.update();
+
+    // Any MIDI events the host sent since the last processing cycle are sent
+    // along with this request. Swapping the queues means neither of them needs
+    // to be reallocated.
+    {
+        std::lock_guard lock(outgoing_midi_events_mutex_);
+        request.midi_events.clear();
+        std::swap(request.midi_events, outgoing_midi_events_);
+        dropping_outgoing_midi_events_ = false;
     }
 
     // The host should have called `effMainsChanged()` before sending audio to
     // process
     assert(process_buffers_);
+
+    // NOTE: This is large enough to fit a couple dozen MIDI events without
+    //       having to allocate
+    SerializationBuffer<2048> buffer{};
+
+    // With pipelined processing the Wine plugin host may still be processing
+    // the previous block at this point. We'll need to wait for it to finish
+    // and store its outputs before we can reuse the shared memory buffers.
+    // Since the host will have done other work in the meantime, this should
+    // usually not block for very long. The round trip time reported for
+    // pipelined processing is thus only the time spent waiting here.
+    if (config_.pipelined_processing && process_request_in_flight_) {
+        timing.start_round_trip();
+        const Vst2ProcessResponse response = finish_process_request(buffer);
+        timing.end_round_trip();
+        timing.set_plugin_time(response.plugin_time_ns);
+        timing.set_offline_processing(process_buffers_->offline_processing());
+
+        for (int channel = 0; channel < plugin_.numOutputs; channel++) {
+            if (process_buffers_->output_channel_silent(0, channel)) {
+                pipelined_outputs_.write_silence<T>(channel,
+                                                    pipelined_sample_frames_);
+            } else {
+                pipelined_outputs_.write(
+                    channel,
+                    process_buffers_->output_channel_ptr<T>(0, channel),
+                    pipelined_sample_frames_);
+            }
+        }
+        pipelined_outputs_.commit_write(pipelined_sample_frames_);
+    }
+
     for (int channel = 0; channel < plugin_.numInputs; channel++) {
-        T* input_channel = process_buffers_->input_channel_ptr<T>(0, channel);
-        std::copy_n(inputs[channel], sample_frames, input_channel);
+        if (channel_alias_detector_.is_input_alias(channel)) {
+            continue;
+        }
+
+        // VST2 doesn't have any way to tell the plugin that an input is
+        // silent, so we'll check for that ourselves. Silent inputs are cleared
+        // instead of copied.
+        const T* input_channel = inputs[channel];
+        if (is_silent(input_channel, sample_frames)) {
+            process_buffers_->fill_input_channel<T>(0, channel, 0,
+                                                    sample_frames);
+        } else {
+            process_buffers_->write_input_channel(0, channel, input_channel,
+                                                  sample_frames);
+        }
     }
 
     // After writing audio to the shared memory buffers, we'll send the
     // processing request parameters to the Wine plugin host so it can start
     // processing audio. This is why we don't need any explicit synchronisation.
-    sockets_.host_plugin_process_replacing_.send(request);
-
-    // From the Wine side we'll send a zero byte struct back as an
-    // acknowledgement that audio processing has finished. At this point the
-    // audio will have been written to our buffers.
-    sockets_.host_plugin_process_replacing_.receive_single<Ack>();
+    // With pipelined processing we'll return the previous block's outputs to
+    // the host right away, and we'll only collect the results for this block
+    // during the next processing cycle.
+    if (pipelined) {
+        start_process_request(request, buffer);
+        pipelined_sample_frames_ = sample_frames;
+
+        for (int channel = 0; channel < plugin_.numOutputs; channel++) {
+            pipelined_outputs_.read<replacing>(channel, outputs[channel],
+                                               sample_frames);
+        }
+        pipelined_outputs_.commit_read(sample_frames);
+    } else {
+        timing.start_round_trip();
+        start_process_request(request, buffer);
+        const Vst2ProcessResponse response = finish_process_request(buffer);
+        timing.end_round_trip();
+        timing.set_plugin_time(response.plugin_time_ns);
+        timing.set_offline_processing(process_buffers_->offline_processing());
+
+        for (int channel = 0; channel < plugin_.numOutputs; channel++) {
+            const T* output_channel =
+                process_buffers_->output_channel_ptr<T>(0, channel);
+
+            // The Wine plugin host checked which outputs are silent, so we can
+            // write zeroes for those instead of copying them
+            const bool is_silent =
+                process_buffers_->output_channel_silent(0, channel);
+            if constexpr (replacing) {
+                if (channel_alias_detector_.is_output_alias(channel)) {
+                    continue;
+                }
 
-    for (int channel = 0; channel < plugin_.numOutputs; channel++) {
-        const T* output_channel =
-            process_buffers_->output_channel_ptr<T>(0, channel);
+                if (is_silent) {
+                    std::fill_n(outputs[channel], sample_frames, 0);
+                } else {
+                    std::copy_n(output_channel, sample_frames,
+                                outputs[channel]);
+                }
+            } else {
+                // Adding silence doesn't do anything
+                if (is_silent) {
+                    continue;
+                }
 
-        if constexpr (replacing) {
-            std::copy_n(output_channel, sample_frames, outputs[channel]);
-        } else {
-            // The old `process()` function expects the plugin to add its output
-            // to the accumulated values in `outputs`. Since no host is ever
-            // going to call this anyways we won't even bother with a separate
-            // implementation and we'll just add `processReplacing()` results to
-            // `outputs`.
-            // We could use `std::execution::unseq` here but that would require
-            // linking to TBB and since this probably won't ever be used anyways
-            // that's a bit of a waste.
-            std::transform(output_channel, output_channel + sample_frames,
-                           outputs[channel], outputs[channel],
-                           [](const T& new_value, T& current_value) -> T {
-                               return new_value + current_value;
-                           });
+                // The old `process()` function expects the plugin to add its
+                // output to the accumulated values in `outputs`. Since no host
+                // is ever going to call this anyways we won't even bother with
+                // a separate implementation and we'll just add
+                // `processReplacing()` results to `outputs`.
+                accumulate_samples(output_channel, sample_frames,
+                                   outputs[channel]);
+            }
         }
     }
 
@@ -737,6 +1137,69 @@ void Vst2PluginBridge::do_process(T** inputs, T** outputs, int sample_frames) {
     incoming_midi_events_.clear();
 }
 
+void Vst2PluginBridge::start_process_request(
+    const Vst2ProcessRequest& request,
+    SerializationBufferBase& buffer) {
+    assert(!process_request_in_flight_);
+
+    // The socket will pass the request through the shared memory object's
+    // control block and only send a small doorbell message over the socket.
+    // With the `futex_audio_signalling` option enabled, the request is written
+    // to the shared memory object's control block instead and we'll wake up
+    // the Wine plugin host's audio thread using a futex. If the request somehow
+    // doesn't fit in there, we'll still use the socket.
+    if (process_stats_) {
+        process_request_start_ = std::chrono::steady_clock::now();
+    }
+
+    if (config_.futex_audio_signalling &&
+        write_shm_object(*process_buffers_, request, buffer)) {
+        process_request_size_ = process_buffers_->control_payload_size();
+        process_futex_request_id_ = process_buffers_->signal_request();
+    } else {
+        sockets_.host_plugin_process_replacing_.send(request, buffer,
+                                                     &process_request_size_);
+        process_futex_request_id_.reset();
+    }
+
+    process_request_in_flight_ = true;
+}
+
+Vst2ProcessResponse Vst2PluginBridge::finish_process_request(
+    SerializationBufferBase& buffer) {
+    assert(process_request_in_flight_);
+
+    // The response is sent back once audio processing has finished. At this
+    // point the audio will have been written to our buffers.
+    Vst2ProcessResponse response{};
+    size_t response_size = 0;
+    if (process_futex_request_id_) {
+        // The Wine plugin host writes its response back to the control block
+        // before waking us up again
+        process_buffers_->wait_for_response(*process_futex_request_id_, [&]() {
+            return plugin_host_->running() &&
+                   !is_socket_peer_closed(
+                       sockets_.host_plugin_process_replacing_.native_handle());
+        });
+        read_shm_object(*process_buffers_, response);
+        response_size = process_buffers_->control_payload_size();
+    } else {
+        sockets_.host_plugin_process_replacing_.receive_single(
+            response, buffer, &response_size);
+    }
+
+    process_request_in_flight_ = false;
+    if (process_stats_) {
+        process_stats_->record_sent(
+            trace_type_name<Vst2ProcessRequest>(),
+            MessageSizes{.request = process_request_size_,
+                         .response = response_size},
+            std::chrono::steady_clock::now() - process_request_start_);
+    }
+
+    return response;
+}
+
 void Vst2PluginBridge::process(AEffect* /*plugin*/,
                                float** inputs,
                                float** outputs,
@@ -770,6 +1233,16 @@ void Vst2PluginBridge::process_double_replacing(AEffect* /*plugin*/,
 float Vst2PluginBridge::get_parameter(AEffect* /*plugin*/, int index) {
     logger_.log_get_parameter(index);
 
+    // Hosts tend to poll every single parameter on every UI frame, so whenever
+    // possible we'll answer this from the shared parameter table instead
+    if (parameter_table_) {
+        if (const std::optional<float> value = parameter_table_->get(index)) {
+            logger_.log_get_parameter_response(*value, true);
+
+            return *value;
+        }
+    }
+
     const Parameter request{index, std::nullopt};
     ParameterResult response;
 
@@ -796,6 +1269,23 @@ void Vst2PluginBridge::set_parameter(AEffect* /*plugin*/,
     const Parameter request{index, value};
     ParameterResult response;
 
+    // With the parameter cache enabled we don't need to wait for the plugin to
+    // handle this. The new value is immediately visible to `getParameter()`,
+    // the Wine plugin host will store the value the plugin actually ended up
+    // using once it has been applied, and the Wine plugin host's audio thread
+    // waits for all posted changes to be applied before processing audio.
+    if (parameter_table_) {
+        parameter_table_->store(index, value);
+
+        std::lock_guard lock(parameters_mutex_);
+        parameter_table_->post_set();
+        sockets_.host_plugin_parameters_.send(request);
+
+        logger_.log_set_parameter_response();
+
+        return;
+    }
+
     {
         std::lock_guard lock(parameters_mutex_);
         sockets_.host_plugin_parameters_.send(request);
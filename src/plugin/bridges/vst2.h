@@ -19,10 +19,15 @@
 #include <vestige/aeffectx.h>
 
 #include <asio/io_context.hpp>
+#include <atomic>
+#include <chrono>
 #include <thread>
+#include <unordered_map>
 
 #include "../../common/communication/vst2.h"
 #include "../../common/logging/vst2.h"
+#include "../../common/parameter-shm.h"
+#include "../pipelined-output-queue.h"
 #include "common.h"
 
 /**
@@ -127,6 +132,22 @@ class Vst2PluginBridge : PluginBridge<Vst2Sockets<std::jthread>> {
     template <typename T, bool replacing>
     void do_process(T** inputs, T** outputs, int sample_frames);
 
+    /**
+     * Send an audio processing request to the Wine plugin host after the input
+     * audio has been written to `process_buffers_`. This does not wait for the
+     * response. `finish_process_request()` has to be called before the next
+     * request can be sent.
+     */
+    void start_process_request(const Vst2ProcessRequest& request,
+                               SerializationBufferBase& buffer);
+
+    /**
+     * Wait for the Wine plugin host to finish processing the request sent in
+     * `start_process_request()`. The plugin's output audio will be in
+     * `process_buffers_` after this returns.
+     */
+    Vst2ProcessResponse finish_process_request(SerializationBufferBase& buffer);
+
     /**
      * This AEffect struct will be populated using the data passed by the Wine
      * VST host during initialization and then passed as a pointer to the Linux
@@ -135,6 +156,36 @@ class Vst2PluginBridge : PluginBridge<Vst2Sockets<std::jthread>> {
     AEffect plugin_;
 
    private:
+    /**
+     * Determine the latency for pipelined processing after the host resumed
+     * audio processing, reset `pipelined_outputs_`, and let the host know when
+     * our reported latency has changed. Only used when the
+     * `pipelined_processing` option is enabled.
+     */
+    void update_pipelined_latency();
+
+    /**
+     * Handle `effGetParamName()`, `effGetParamLabel()`, and
+     * `effGetParamDisplay()` using `parameter_string_cache_`, and only send
+     * the event to the Wine plugin host when the string isn't cached yet. Hosts
+     * query these strings for every parameter every time they redraw a generic
+     * plugin UI or their automation lanes. Only used when the
+     * `vst2_parameter_cache` option is enabled.
+     */
+    intptr_t dispatch_parameter_string(DefaultDataConverter& converter,
+                                       int opcode,
+                                       int index,
+                                       intptr_t value,
+                                       void* data,
+                                       float option);
+
+    /**
+     * Clear `parameter_string_cache_`. This is done when the plugin calls
+     * `audioMasterUpdateDisplay()` or `audioMasterIOChanged()`, and when the
+     * host loads a new program or new state.
+     */
+    void clear_parameter_string_cache() noexcept;
+
     /**
      * The thread that handles host callbacks.
      */
@@ -142,12 +193,72 @@ class Vst2PluginBridge : PluginBridge<Vst2Sockets<std::jthread>> {
 
     /**
      * A mutex to prevent multiple simultaneous calls to `getParameter()` and
-     * `setParameter()`. This likely won't happen, but better safe than sorry.
-     * For `dispatch()` and `audioMaster()` there's some more complex logic for
-     * this in `Vst2EventHandler`.
+     * `setParameter()` from using the parameters socket at the same time. This
+     * likely won't happen, but better safe than sorry. For `dispatch()` and
+     * `audioMaster()` there's some more complex logic for this in
+     * `Vst2EventHandler`.
      */
     std::mutex parameters_mutex_;
 
+    /**
+     * The last known values for the plugin's parameters, shared with the Wine
+     * plugin host. When a value in here is valid, `getParameter()` can be
+     * answered without sending a message to the Wine plugin host, and
+     * `setParameter()` won't wait for the plugin to finish handling the
+     * change. This is set up during initialization, and it will be a nullopt
+     * unless the `vst2_parameter_cache` option is enabled.
+     */
+    std::optional<ParameterShmTable> parameter_table_;
+
+    /**
+     * A string returned by the plugin for `effGetParamName()`,
+     * `effGetParamLabel()`, or `effGetParamDisplay()`, along with the
+     * dispatcher's return value.
+     */
+    struct CachedParameterString {
+        intptr_t return_value;
+        std::string string;
+    };
+
+    /**
+     * A cached `effGetParamDisplay()` string. Unlike names and labels, these
+     * are only valid for the parameter value they were fetched for. Since the
+     * displayed value may also depend on the values of other parameters, these
+     * entries also expire after `parameter_display_cache_duration`.
+     */
+    struct CachedParameterDisplay {
+        CachedParameterString display;
+        /**
+         * The parameter's value in `parameter_table_` at the time the display
+         * string was fetched.
+         */
+        float value;
+        std::chrono::steady_clock::time_point fetched_at;
+    };
+
+    /**
+     * Parameter names, labels, and display strings cached by
+     * `dispatch_parameter_string()`, indexed by parameter index.
+     *
+     * @see clear_parameter_string_cache
+     */
+    struct ParameterStringCache {
+        std::unordered_map<int, CachedParameterString> names;
+        std::unordered_map<int, CachedParameterString> labels;
+        std::unordered_map<int, CachedParameterDisplay> displays;
+    };
+
+    ParameterStringCache parameter_string_cache_;
+    std::mutex parameter_string_cache_mutex_;
+    /**
+     * Incremented by `clear_parameter_string_cache()`. Since we can't hold on
+     * to `parameter_string_cache_mutex_` while waiting for the Wine plugin
+     * host, `dispatch_parameter_string()` uses this to avoid caching a string
+     * that was requested before the cache was cleared. Guarded by
+     * `parameter_string_cache_mutex_`.
+     */
+    uint64_t parameter_string_cache_generation_ = 0;
+
     /**
      * The callback function passed by the host to the VST plugin instance.
      */
@@ -173,6 +284,82 @@ class Vst2PluginBridge : PluginBridge<Vst2Sockets<std::jthread>> {
      */
     std::optional<AudioShmBuffer> process_buffers_;
 
+    /**
+     * The request object sent to the Wine plugin host during audio processing.
+     * This is reused between processing cycles to avoid allocations.
+     */
+    Vst2ProcessRequest process_request_;
+
+    /**
+     * Whether we've sent an audio processing request to the Wine plugin host
+     * that we haven't received the response for yet. Without pipelined
+     * processing this is only true during `do_process()`. This is written on
+     * the audio thread and read from `effMainsChanged()`, which the host may
+     * call from another thread.
+     */
+    std::atomic_bool process_request_in_flight_ = false;
+    /**
+     * If the request that's currently in flight was passed through the shared
+     * memory object's control block because of the `futex_audio_signalling`
+     * option, then this contains the request's ID so we can wait for the
+     * response. Otherwise the response will be sent over the socket.
+     */
+    std::optional<uint32_t> process_futex_request_id_;
+    /**
+     * When the request that's currently in flight was sent and how large it
+     * was. Only used for the statistics enabled with `YABRIDGE_STATS`. With
+     * pipelined processing the round trip also includes the time the host
+     * spent between the two processing calls.
+     */
+    std::chrono::steady_clock::time_point process_request_start_;
+    size_t process_request_size_ = 0;
+
+    /**
+     * The maximum block size the host passed to `effSetBlockSize()`, if it has
+     * called that function. Used to determine the latency for pipelined
+     * processing.
+     */
+    std::optional<uint32_t> max_samples_per_block_;
+
+    /**
+     * When the `pipelined_processing` option is enabled, the Wine plugin host
+     * will process the current block of audio while the host does other work,
+     * and we'll return the plugin's outputs from the previous processing cycle.
+     * This queue delays the plugin's output by exactly the maximum block size.
+     * That latency is added to the plugin's own latency in `initialDelay`. If
+     * the block size is not known, or if the host processes a larger block
+     * than it said it would, then we'll process those blocks without
+     * pipelining instead.
+     */
+    PipelinedOutputQueue pipelined_outputs_;
+    /**
+     * The number of samples in the request that's currently in flight when
+     * using pipelined processing.
+     */
+    uint32_t pipelined_sample_frames_ = 0;
+
+    /**
+     * Used to find input and output channels the host passed the same buffer
+     * for during audio processing, so we can avoid copying those buffers more
+     * than once.
+     */
+    AudioChannelAliasDetector channel_alias_detector_;
+
+    /**
+     * Timing information for audio processing, used to detect late processing
+     * cycles. This is a null pointer when the `disable_xrun_warnings` option is
+     * enabled, unless `YABRIDGE_DEBUG_LEVEL` contains `+timing`.
+     */
+    std::shared_ptr<ProcessTimings> process_timings_;
+
+    /**
+     * Statistics for the audio processing socket. Audio processing doesn't go
+     * through `AdHocSocketHandler`, so we'll have to record these requests
+     * ourselves. Only set when the `YABRIDGE_STATS` environment variable is
+     * set.
+     */
+    std::shared_ptr<SocketStats> process_stats_;
+
     /**
      * We'll periodically synchronize the Wine host's audio thread priority with
      * that of the host. Since the overhead from doing so does add up, we'll
@@ -209,6 +396,29 @@ class Vst2PluginBridge : PluginBridge<Vst2Sockets<std::jthread>> {
      */
     std::mutex incoming_midi_events_mutex_;
 
+    /**
+     * The events the host passed to `effProcessEvents()` that have not yet been
+     * sent to the Wine plugin host. Instead of forwarding these immediately,
+     * which would cost an additional round trip every processing cycle, we'll
+     * send these along with the next audio processing request. This is capped
+     * at `max_outgoing_midi_event_batches` batches so a host that sends events
+     * without ever processing audio can't make this grow indefinitely.
+     *
+     * @see Vst2ProcessRequest::midi_events
+     */
+    llvm::SmallVector<DynamicVstEvents, 1> outgoing_midi_events_;
+    /**
+     * Set when we had to drop events because `outgoing_midi_events_` was full,
+     * so we only print a warning once until the queue gets emptied again.
+     * Protected by `outgoing_midi_events_mutex_`.
+     */
+    bool dropping_outgoing_midi_events_ = false;
+    /**
+     * Mutex for locking the above event queue. Hosts will normally call
+     * `effProcessEvents()` from the audio thread, but we can't rely on that.
+     */
+    std::mutex outgoing_midi_events_mutex_;
+
     /**
      * REAPER requires us to call `audioMasterSizeWidnow()` from the same thread
      * that's calling `effEditIdle()`. If we call this from any other thread,
@@ -37,17 +37,29 @@ constexpr char other_instance_message_id[] = "yabridge_other_instance";
  */
 constexpr char other_instance_pointer_attribute[] = "other_proxy_ptr";
 
+/**
+ * How long a cached `IEditController::getParamStringByValue()` response stays
+ * valid. See `Vst3PluginProxyImpl::CachedParamStringByValue`.
+ */
+constexpr std::chrono::milliseconds parameter_string_cache_duration(500);
+
 Vst3PluginProxyImpl::ContextMenu::ContextMenu(
     Steinberg::IPtr<Steinberg::Vst::IContextMenu> menu)
     : menu(menu) {}
 
 Vst3PluginProxyImpl::Vst3PluginProxyImpl(Vst3PluginBridge& bridge,
                                          Vst3PluginProxy::ConstructArgs&& args)
-    : Vst3PluginProxy(std::move(args)), bridge_(bridge) {
+    : Vst3PluginProxy(std::move(args)),
+      bridge_(bridge),
+      process_timings_(bridge.create_process_timings(instance_id())) {
     bridge.register_plugin_proxy(*this);
 }
 
 Vst3PluginProxyImpl::~Vst3PluginProxyImpl() noexcept {
+    // `process_buffers_` will be destroyed together with this object, so it
+    // should no longer be attached to the audio processor socket
+    bridge_.set_audio_processor_shm_buffer(instance_id(), nullptr);
+
     // NOTE: This can actually throw (e.g. out of memory or the socket got
     //       closed). But if that were to happen, then we wouldn't be able to
     //       recover from it anyways.
@@ -87,9 +99,11 @@ bool Vst3PluginProxyImpl::unregister_context_menu(size_t context_menu_id) {
 
 void Vst3PluginProxyImpl::clear_caches() noexcept {
     clear_bus_cache();
+    clear_parameter_conversion_cache();
 
     std::lock_guard lock(function_result_cache_mutex_);
     function_result_cache_ = FunctionResultCache{};
+    function_result_cache_generation_++;
 }
 
 tresult PLUGIN_API Vst3PluginProxyImpl::setAudioPresentationLatencySamples(
@@ -186,6 +200,12 @@ uint32 PLUGIN_API Vst3PluginProxyImpl::getLatencySamples() {
 
 tresult PLUGIN_API
 Vst3PluginProxyImpl::setupProcessing(Steinberg::Vst::ProcessSetup& setup) {
+    // Used to detect processing cycles that miss their deadline
+    if (process_timings_) {
+        process_timings_->sample_rate.store(setup.sampleRate,
+                                            std::memory_order_relaxed);
+    }
+
     return bridge_.send_audio_processor_message(
         YaAudioProcessor::SetupProcessing{.instance_id = instance_id(),
                                           .setup = setup});
@@ -212,6 +232,9 @@ tresult PLUGIN_API Vst3PluginProxyImpl::setProcessing(TBool state) {
 
 tresult PLUGIN_API
 Vst3PluginProxyImpl::process(Steinberg::Vst::ProcessData& data) {
+    ScopedProcessTiming timing(process_timings_.get(),
+                               static_cast<uint32_t>(data.numSamples));
+
     // We'll synchronize the scheduling priority of the audio thread on the Wine
     // plugin host with that of the host's audio thread every once in a while
     std::optional<int> new_realtime_priority = std::nullopt;
@@ -229,6 +252,7 @@ Vst3PluginProxyImpl::process(Steinberg::Vst::ProcessData& data) {
     process_request_.instance_id = instance_id();
     process_request_.data.repopulate(data, *process_buffers_);
     process_request_.new_realtime_priority = new_realtime_priority;
+    process_request_.measure_plugin_time = process_timings_ != nullptr;
 
     // HACK: This is a bit ugly. This `YaProcessData::Response` object actually
     //       contains pointers to the corresponding `YaProcessData` fields in
@@ -246,9 +270,13 @@ Vst3PluginProxyImpl::process(Steinberg::Vst::ProcessData& data) {
 
     // We'll also receive the response into an existing object so we can also
     // avoid heap allocations there
+    timing.start_round_trip();
     bridge_.receive_audio_processor_message_into(
         MessageReference<YaAudioProcessor::Process>(process_request_),
         process_response_);
+    timing.end_round_trip();
+    timing.set_plugin_time(process_response_.plugin_time_ns);
+    timing.set_offline_processing(process_buffers_->offline_processing());
 
     // At this point the shared audio buffers should contain the output audio,
     // so we'll write that back to the host along with any metadata (which in
@@ -423,6 +451,12 @@ tresult PLUGIN_API Vst3PluginProxyImpl::setActive(TBool state) {
     if (response.updated_audio_buffers_config) {
         if (!process_buffers_) {
             process_buffers_.emplace(*response.updated_audio_buffers_config);
+
+            // The Wine plugin host already did the same thing on its side, so
+            // from now on audio processor messages can be passed through the
+            // buffers' control block
+            bridge_.set_audio_processor_shm_buffer(instance_id(),
+                                                   &*process_buffers_);
         } else {
             process_buffers_->resize(*response.updated_audio_buffers_config);
         }
@@ -441,9 +475,14 @@ tresult PLUGIN_API Vst3PluginProxyImpl::setState(Steinberg::IBStream* state) {
         //       GUI thread. So if the GUI is active, we'll use the mutual
         //       recursion mechanism to allow this resize call to also be
         //       performed from the GUI thread.
-        return bridge_.send_mutually_recursive_message(
+        const tresult result = bridge_.send_mutually_recursive_message(
             Vst3PluginProxy::SetState{.instance_id = instance_id(),
                                       .state = state});
+
+        // Loading a new state may change how parameter values are displayed
+        clear_parameter_conversion_cache();
+
+        return result;
     } else {
         bridge_.logger_.log(
             "WARNING: Null pointer passed to "
@@ -612,8 +651,12 @@ Vst3PluginProxyImpl::notify(Steinberg::Vst::IMessage* message) {
 tresult PLUGIN_API
 Vst3PluginProxyImpl::setComponentState(Steinberg::IBStream* state) {
     if (state) {
-        return bridge_.send_message(YaEditController::SetComponentState{
-            .instance_id = instance_id(), .state = state});
+        const tresult result =
+            bridge_.send_message(YaEditController::SetComponentState{
+                .instance_id = instance_id(), .state = state});
+        clear_parameter_conversion_cache();
+
+        return result;
     } else {
         bridge_.logger_.log(
             "WARNING: Null pointer passed to "
@@ -626,8 +669,14 @@ int32 PLUGIN_API Vst3PluginProxyImpl::getParameterCount() {
     const auto request =
         YaEditController::GetParameterCount{.instance_id = instance_id()};
 
+    // Hosts will almost always query the information for every parameter
+    // right after this, so we'll fetch all of that at once
+    prefetch_parameter_info();
+
+    uint64_t generation;
     {
         std::lock_guard lock(function_result_cache_mutex_);
+        generation = function_result_cache_generation_;
         if (function_result_cache_.parameter_count) {
             const bool log_response =
                 bridge_.logger_.log_request(true, request);
@@ -647,7 +696,9 @@ int32 PLUGIN_API Vst3PluginProxyImpl::getParameterCount() {
 
     {
         std::lock_guard lock(function_result_cache_mutex_);
-        function_result_cache_.parameter_count = result;
+        if (function_result_cache_generation_ == generation) {
+            function_result_cache_.parameter_count = result;
+        }
     }
 
     return result;
@@ -659,8 +710,12 @@ tresult PLUGIN_API Vst3PluginProxyImpl::getParameterInfo(
     const auto request = YaEditController::GetParameterInfo{
         .instance_id = instance_id(), .param_index = paramIndex};
 
+    prefetch_parameter_info();
+
+    uint64_t generation;
     {
         std::lock_guard lock(function_result_cache_mutex_);
+        generation = function_result_cache_generation_;
         if (auto it = function_result_cache_.parameter_info.find(paramIndex);
             it != function_result_cache_.parameter_info.end()) {
             const bool log_response =
@@ -685,27 +740,116 @@ tresult PLUGIN_API Vst3PluginProxyImpl::getParameterInfo(
 
     {
         std::lock_guard lock(function_result_cache_mutex_);
-        function_result_cache_.parameter_info[paramIndex] = response.info;
+        if (response.result == Steinberg::kResultOk &&
+            function_result_cache_generation_ == generation) {
+            function_result_cache_.parameter_info[paramIndex] = response.info;
+        }
     }
 
     return response.result;
 }
 
+void Vst3PluginProxyImpl::prefetch_parameter_info() {
+    while (true) {
+        std::unique_lock lock(function_result_cache_mutex_);
+        if (function_result_cache_.parameter_count) {
+            return;
+        }
+
+        // NOTE: We can't hold on to the lock while sending the request, since
+        //       the plugin may call `IComponentHandler::restartComponent()` in
+        //       the meantime, which also needs to lock the cache to clear it
+        const uint64_t generation = function_result_cache_generation_;
+        lock.unlock();
+
+        const GetAllParameterInfoResponse response =
+            bridge_.send_message(YaEditController::GetAllParameterInfo{
+                .instance_id = instance_id()});
+
+        lock.lock();
+
+        // If the plugin told the host that its parameters changed in the
+        // meantime, then this response may already be outdated
+        if (function_result_cache_generation_ != generation) {
+            continue;
+        }
+
+        function_result_cache_.parameter_count =
+            static_cast<int32>(response.parameters.size());
+        for (size_t param_index = 0; param_index < response.parameters.size();
+             param_index++) {
+            // Parameters the plugin failed to return information for will
+            // still be queried individually
+            const auto& [result, info] = response.parameters[param_index];
+            if (result == Steinberg::kResultOk) {
+                function_result_cache_
+                    .parameter_info[static_cast<int32>(param_index)] = info;
+            }
+        }
+
+        return;
+    }
+}
+
+void Vst3PluginProxyImpl::clear_parameter_conversion_cache() noexcept {
+    std::lock_guard lock(parameter_conversion_cache_mutex_);
+    parameter_conversion_cache_.param_string_by_value.clear();
+    parameter_conversion_cache_.param_value_by_string.clear();
+    parameter_conversion_cache_.normalized_param_to_plain.clear();
+    parameter_conversion_cache_.plain_param_to_normalized.clear();
+    parameter_conversion_cache_generation_++;
+}
+
 tresult PLUGIN_API Vst3PluginProxyImpl::getParamStringByValue(
     Steinberg::Vst::ParamID id,
     Steinberg::Vst::ParamValue valueNormalized /*in*/,
     Steinberg::Vst::String128 string /*out*/) {
     if (string) {
-        const GetParamStringByValueResponse response =
-            bridge_.send_message(YaEditController::GetParamStringByValue{
-                .instance_id = instance_id(),
-                .id = id,
-                .value_normalized = valueNormalized});
+        const auto request = YaEditController::GetParamStringByValue{
+            .instance_id = instance_id(),
+            .id = id,
+            .value_normalized = valueNormalized};
+
+        const auto now = std::chrono::steady_clock::now();
+        std::optional<GetParamStringByValueResponse> response;
+        uint64_t generation;
+        {
+            std::lock_guard lock(parameter_conversion_cache_mutex_);
+            generation = parameter_conversion_cache_generation_;
+            if (const std::optional<CachedParamStringByValue> cached =
+                    parameter_conversion_cache_.param_string_by_value.get(
+                        {id, valueNormalized});
+                cached &&
+                now - cached->fetched_at < parameter_string_cache_duration) {
+                response = cached->response;
+            }
+        }
 
-        std::copy(response.string.begin(), response.string.end(), string);
-        string[response.string.size()] = 0;
+        if (response) {
+            const bool log_response =
+                bridge_.logger_.log_request(true, request);
+            if (log_response) {
+                bridge_.logger_.log_response(true, *response, true);
+            }
+        } else {
+            response = bridge_.send_message(request);
+
+            // The cache may have been cleared while we were waiting for the
+            // response, in which case this response may already be outdated
+            std::lock_guard lock(parameter_conversion_cache_mutex_);
+            if (response->result == Steinberg::kResultOk &&
+                parameter_conversion_cache_generation_ == generation) {
+                parameter_conversion_cache_.param_string_by_value.put(
+                    {id, valueNormalized},
+                    CachedParamStringByValue{.response = *response,
+                                             .fetched_at = now});
+            }
+        }
 
-        return response.result;
+        std::copy(response->string.begin(), response->string.end(), string);
+        string[response->string.size()] = 0;
+
+        return response->result;
     } else {
         bridge_.logger_.log(
             "WARNING: Null pointer passed to "
@@ -719,13 +863,38 @@ tresult PLUGIN_API Vst3PluginProxyImpl::getParamValueByString(
     Steinberg::Vst::TChar* string /*in*/,
     Steinberg::Vst::ParamValue& valueNormalized /*out*/) {
     if (string) {
-        const GetParamValueByStringResponse response =
-            bridge_.send_message(YaEditController::GetParamValueByString{
-                .instance_id = instance_id(), .id = id, .string = string});
+        const auto request = YaEditController::GetParamValueByString{
+            .instance_id = instance_id(), .id = id, .string = string};
+
+        std::optional<GetParamValueByStringResponse> response;
+        uint64_t generation;
+        {
+            std::lock_guard lock(parameter_conversion_cache_mutex_);
+            generation = parameter_conversion_cache_generation_;
+            response = parameter_conversion_cache_.param_value_by_string.get(
+                {id, request.string});
+        }
 
-        valueNormalized = response.value_normalized;
+        if (response) {
+            const bool log_response =
+                bridge_.logger_.log_request(true, request);
+            if (log_response) {
+                bridge_.logger_.log_response(true, *response, true);
+            }
+        } else {
+            response = bridge_.send_message(request);
 
-        return response.result;
+            std::lock_guard lock(parameter_conversion_cache_mutex_);
+            if (response->result == Steinberg::kResultOk &&
+                parameter_conversion_cache_generation_ == generation) {
+                parameter_conversion_cache_.param_value_by_string.put(
+                    {id, request.string}, *response);
+            }
+        }
+
+        valueNormalized = response->value_normalized;
+
+        return response->result;
     } else {
         bridge_.logger_.log(
             "WARNING: Null pointer passed to "
@@ -738,18 +907,86 @@ Steinberg::Vst::ParamValue PLUGIN_API
 Vst3PluginProxyImpl::normalizedParamToPlain(
     Steinberg::Vst::ParamID id,
     Steinberg::Vst::ParamValue valueNormalized) {
-    return bridge_.send_message(YaEditController::NormalizedParamToPlain{
+    const auto request = YaEditController::NormalizedParamToPlain{
         .instance_id = instance_id(),
         .id = id,
-        .value_normalized = valueNormalized});
+        .value_normalized = valueNormalized};
+
+    uint64_t generation;
+    {
+        std::lock_guard lock(parameter_conversion_cache_mutex_);
+        generation = parameter_conversion_cache_generation_;
+        if (const std::optional<Steinberg::Vst::ParamValue> plain_value =
+                parameter_conversion_cache_.normalized_param_to_plain.get(
+                    {id, valueNormalized})) {
+            const bool log_response =
+                bridge_.logger_.log_request(true, request);
+            if (log_response) {
+                bridge_.logger_.log_response(
+                    true,
+                    YaEditController::NormalizedParamToPlain::Response(
+                        *plain_value),
+                    true);
+            }
+
+            return *plain_value;
+        }
+    }
+
+    const Steinberg::Vst::ParamValue plain_value =
+        bridge_.send_message(request);
+
+    {
+        std::lock_guard lock(parameter_conversion_cache_mutex_);
+        if (parameter_conversion_cache_generation_ == generation) {
+            parameter_conversion_cache_.normalized_param_to_plain.put(
+                {id, valueNormalized}, plain_value);
+        }
+    }
+
+    return plain_value;
 }
 
 Steinberg::Vst::ParamValue PLUGIN_API
 Vst3PluginProxyImpl::plainParamToNormalized(
     Steinberg::Vst::ParamID id,
     Steinberg::Vst::ParamValue plainValue) {
-    return bridge_.send_message(YaEditController::PlainParamToNormalized{
-        .instance_id = instance_id(), .id = id, .plain_value = plainValue});
+    const auto request = YaEditController::PlainParamToNormalized{
+        .instance_id = instance_id(), .id = id, .plain_value = plainValue};
+
+    uint64_t generation;
+    {
+        std::lock_guard lock(parameter_conversion_cache_mutex_);
+        generation = parameter_conversion_cache_generation_;
+        if (const std::optional<Steinberg::Vst::ParamValue> normalized_value =
+                parameter_conversion_cache_.plain_param_to_normalized.get(
+                    {id, plainValue})) {
+            const bool log_response =
+                bridge_.logger_.log_request(true, request);
+            if (log_response) {
+                bridge_.logger_.log_response(
+                    true,
+                    YaEditController::PlainParamToNormalized::Response(
+                        *normalized_value),
+                    true);
+            }
+
+            return *normalized_value;
+        }
+    }
+
+    const Steinberg::Vst::ParamValue normalized_value =
+        bridge_.send_message(request);
+
+    {
+        std::lock_guard lock(parameter_conversion_cache_mutex_);
+        if (parameter_conversion_cache_generation_ == generation) {
+            parameter_conversion_cache_.plain_param_to_normalized.put(
+                {id, plainValue}, normalized_value);
+        }
+    }
+
+    return normalized_value;
 }
 
 Steinberg::Vst::ParamValue PLUGIN_API
@@ -761,8 +998,15 @@ Vst3PluginProxyImpl::getParamNormalized(Steinberg::Vst::ParamID id) {
 tresult PLUGIN_API
 Vst3PluginProxyImpl::setParamNormalized(Steinberg::Vst::ParamID id,
                                         Steinberg::Vst::ParamValue value) {
-    return bridge_.send_message(YaEditController::SetParamNormalized{
-        .instance_id = instance_id(), .id = id, .value = value});
+    const tresult result =
+        bridge_.send_message(YaEditController::SetParamNormalized{
+            .instance_id = instance_id(), .id = id, .value = value});
+
+    // Other parameters' display strings may depend on this parameter's value,
+    // and this may also be a program change parameter
+    clear_parameter_conversion_cache();
+
+    return result;
 }
 
 tresult PLUGIN_API Vst3PluginProxyImpl::setComponentHandler(
@@ -1145,11 +1389,14 @@ Vst3PluginProxyImpl::setProgramData(Steinberg::Vst::ProgramListID listId,
                                     int32 programIndex,
                                     Steinberg::IBStream* data) {
     if (data) {
-        return bridge_.send_message(
+        const tresult result = bridge_.send_message(
             YaProgramListData::SetProgramData{.instance_id = instance_id(),
                                               .list_id = listId,
                                               .program_index = programIndex,
                                               .data = data});
+        clear_parameter_conversion_cache();
+
+        return result;
     } else {
         bridge_.logger_.log(
             "WARNING: Null pointer passed to "
@@ -1186,8 +1433,11 @@ tresult PLUGIN_API
 Vst3PluginProxyImpl::setUnitData(Steinberg::Vst::UnitID unitId,
                                  Steinberg::IBStream* data) {
     if (data) {
-        return bridge_.send_message(YaUnitData::SetUnitData{
+        const tresult result = bridge_.send_message(YaUnitData::SetUnitData{
             .instance_id = instance_id(), .unit_id = unitId, .data = data});
+        clear_parameter_conversion_cache();
+
+        return result;
     } else {
         bridge_.logger_.log(
             "WARNING: Null pointer passed to 'IUnitData::setUnitData()'");
@@ -1341,11 +1591,14 @@ Vst3PluginProxyImpl::setUnitProgramData(int32 listOrUnitId,
                                         int32 programIndex,
                                         Steinberg::IBStream* data) {
     if (data) {
-        return bridge_.send_message(
+        const tresult result = bridge_.send_message(
             YaUnitInfo::SetUnitProgramData{.instance_id = instance_id(),
                                            .list_or_unit_id = listOrUnitId,
                                            .program_index = programIndex,
                                            .data = data});
+        clear_parameter_conversion_cache();
+
+        return result;
     } else {
         bridge_.logger_.log(
             "WARNING: Null pointer passed to "
@@ -16,8 +16,10 @@
 
 #pragma once
 
+#include <chrono>
 #include <map>
 
+#include "../../lru-cache.h"
 #include "../vst3.h"
 #include "plug-view-proxy.h"
 
@@ -73,9 +75,21 @@ class Vst3PluginProxyImpl : public Vst3PluginProxy {
      *
      * @see clear_bus_cache_
      * @see function_result_cache_
+     * @see parameter_conversion_cache_
      */
     void clear_caches() noexcept;
 
+    /**
+     * Clear the memoized parameter value and string conversions. Aside from
+     * `clear_caches()`, we'll also do this whenever the plugin's state changes
+     * or when a parameter gets changed through `setParamNormalized()` or
+     * `IComponentHandler::performEdit()`, since a parameter's display string
+     * may depend on the values of other parameters.
+     *
+     * @see parameter_conversion_cache_
+     */
+    void clear_parameter_conversion_cache() noexcept;
+
     // From `IAudioPresentationLatency`
     tresult PLUGIN_API
     setAudioPresentationLatencySamples(Steinberg::Vst::BusDirection dir,
@@ -414,6 +428,20 @@ class Vst3PluginProxyImpl : public Vst3PluginProxy {
      */
     void clear_bus_cache() noexcept;
 
+    /**
+     * Fetch the parameter count and the information for every parameter in a
+     * single request if that information is not yet cached. Hosts query this
+     * for every single parameter when loading a plugin, and doing that with
+     * one message per parameter can add seconds to the loading time for
+     * plugins with thousands of parameters. The cache gets cleared again when
+     * the plugin calls `IComponentHandler::restartComponent()`, for instance
+     * with `kParamTitlesChanged`, so the next query will fetch everything
+     * again.
+     *
+     * @see function_result_cache_
+     */
+    void prefetch_parameter_info();
+
     Vst3PluginBridge& bridge_;
 
     /**
@@ -472,6 +500,13 @@ class Vst3PluginProxyImpl : public Vst3PluginProxy {
      */
     std::optional<AudioShmBuffer> process_buffers_;
 
+    /**
+     * Timing information for audio processing, used to detect late processing
+     * cycles. This is a null pointer when the `disable_xrun_warnings` option is
+     * enabled, unless `YABRIDGE_DEBUG_LEVEL` contains `+timing`.
+     */
+    std::shared_ptr<ProcessTimings> process_timings_;
+
     // Caches
 
     /**
@@ -533,7 +568,8 @@ class Vst3PluginProxyImpl : public Vst3PluginProxy {
          */
         std::optional<int32> parameter_count;
         /**
-         * Memoizes `IEditController::getParameterInfo()`.
+         * Memoizes `IEditController::getParameterInfo()`. This is populated
+         * for all parameters at once in `prefetch_parameter_info()`.
          */
         std::unordered_map<int32, Steinberg::Vst::ParameterInfo> parameter_info;
     };
@@ -554,4 +590,103 @@ class Vst3PluginProxyImpl : public Vst3PluginProxy {
      */
     FunctionResultCache function_result_cache_;
     std::mutex function_result_cache_mutex_;
+    /**
+     * Incremented whenever `function_result_cache_` gets cleared. This lets
+     * `prefetch_parameter_info()` and the individual parameter queries discard
+     * a response that was requested before the cache was cleared. Guarded by
+     * `function_result_cache_mutex_`.
+     */
+    uint64_t function_result_cache_generation_ = 0;
+
+    /**
+     * Hashes a parameter ID together with a value or a string, used as the key
+     * for the caches in `ParameterConversionCache`.
+     */
+    struct ParameterKeyHash {
+        template <typename T>
+        size_t operator()(
+            const std::pair<Steinberg::Vst::ParamID, T>& key) const noexcept {
+            const size_t id_hash =
+                std::hash<Steinberg::Vst::ParamID>{}(key.first);
+
+            return id_hash ^ (std::hash<T>{}(key.second) + 0x9e3779b9 +
+                              (id_hash << 6) + (id_hash >> 2));
+        }
+    };
+
+    /**
+     * The maximum number of entries in each of the caches in
+     * `ParameterConversionCache`.
+     */
+    static constexpr size_t parameter_conversion_cache_size = 512;
+
+    /**
+     * A cached `IEditController::getParamStringByValue()` response. Parameters
+     * can also change through automation during audio processing without us
+     * being able to clear the cache, so these entries expire after
+     * `parameter_string_cache_duration`.
+     */
+    struct CachedParamStringByValue {
+        GetParamStringByValueResponse response;
+        std::chrono::steady_clock::time_point fetched_at;
+    };
+
+    /**
+     * Memoizes the conversions between normalized parameter values, plain
+     * values, and strings. Hosts call these functions over and over again with
+     * the same arguments while drawing automation lanes and showing tooltips,
+     * and every one of those calls would otherwise need a round trip to the
+     * Wine plugin host.
+     *
+     * @see parameter_conversion_cache_
+     */
+    struct ParameterConversionCache {
+        /**
+         * Memoizes `IEditController::getParamStringByValue()`.
+         */
+        LruCache<std::pair<Steinberg::Vst::ParamID, Steinberg::Vst::ParamValue>,
+                 CachedParamStringByValue,
+                 ParameterKeyHash>
+            param_string_by_value{parameter_conversion_cache_size};
+        /**
+         * Memoizes `IEditController::getParamValueByString()`.
+         */
+        LruCache<std::pair<Steinberg::Vst::ParamID, std::u16string>,
+                 GetParamValueByStringResponse,
+                 ParameterKeyHash>
+            param_value_by_string{parameter_conversion_cache_size};
+        /**
+         * Memoizes `IEditController::normalizedParamToPlain()`.
+         */
+        LruCache<std::pair<Steinberg::Vst::ParamID, Steinberg::Vst::ParamValue>,
+                 Steinberg::Vst::ParamValue,
+                 ParameterKeyHash>
+            normalized_param_to_plain{parameter_conversion_cache_size};
+        /**
+         * Memoizes `IEditController::plainParamToNormalized()`.
+         */
+        LruCache<std::pair<Steinberg::Vst::ParamID, Steinberg::Vst::ParamValue>,
+                 Steinberg::Vst::ParamValue,
+                 ParameterKeyHash>
+            plain_param_to_normalized{parameter_conversion_cache_size};
+    };
+
+    /**
+     * A bounded cache for conversions between parameter values and strings.
+     * This is cleared in `clear_caches()` when the plugin calls
+     * `IComponentHandler::restartComponent()`, when the plugin's state
+     * changes, and whenever a parameter changes on the main thread.
+     *
+     * @see clear_parameter_conversion_cache
+     */
+    ParameterConversionCache parameter_conversion_cache_;
+    std::mutex parameter_conversion_cache_mutex_;
+    /**
+     * Incremented by `clear_parameter_conversion_cache()`. The conversion
+     * functions can't hold on to `parameter_conversion_cache_mutex_` while
+     * waiting for the plugin's response, so they use this to avoid caching a
+     * response that was requested before the cache was cleared. Guarded by
+     * `parameter_conversion_cache_mutex_`.
+     */
+    uint64_t parameter_conversion_cache_generation_ = 0;
 };
@@ -84,6 +84,9 @@ Vst3PluginBridge::Vst3PluginBridge(const ghc::filesystem::path& plugin_path)
                     const auto& [proxy_object, _] =
                         get_proxy(request.owner_instance_id);
 
+                    // Other parameters may be displayed differently now
+                    proxy_object.clear_parameter_conversion_cache();
+
                     return proxy_object.component_handler_->performEdit(
                         request.id, request.value_normalized);
                 },
@@ -115,6 +115,28 @@ class Vst3PluginBridge : PluginBridge<Vst3Sockets<std::jthread>> {
      */
     void unregister_plugin_proxy(Vst3PluginProxyImpl& proxy_object);
 
+    /**
+     * Let the `IAudioProcessor` and `IComponent` messages for a plugin instance
+     * be passed through the control block of the instance's shared memory audio
+     * buffers. This is a shorthand for
+     * `sockets_.set_audio_processor_shm_buffer()` for use in
+     * `Vst3PluginProxyImpl::setActive()`.
+     */
+    void set_audio_processor_shm_buffer(size_t instance_id,
+                                        AudioShmBuffer* shm) {
+        sockets_.set_audio_processor_shm_buffer(instance_id, shm);
+    }
+
+    /**
+     * Create an object for keeping track of how long audio processing takes
+     * for a plugin instance. See `PluginBridge::create_process_timings()`.
+     */
+    std::shared_ptr<ProcessTimings> create_process_timings(size_t instance_id) {
+        return PluginBridge::create_process_timings(
+            info_.windows_plugin_path_.filename().string() + " #" +
+            std::to_string(instance_id));
+    }
+
     /**
      * Send a control message to the Wine plugin host and return the response.
      * This is a shorthand for `sockets_.host_plugin_control_.send_message()`
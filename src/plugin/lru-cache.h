@@ -0,0 +1,111 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * A simple bounded least recently used cache. When inserting a new entry into a
+ * full cache, the entry that was looked up or inserted the longest time ago
+ * gets evicted. This is used to memoize function calls that the host makes
+ * over and over again with the same arguments, like converting parameter
+ * values to strings while drawing automation lanes.
+ *
+ * This is not thread safe, so the caller should use a mutex.
+ *
+ * @tparam Key The key type. This needs to be hashable with `Hash` and equality
+ *   comparable.
+ * @tparam Value The cached value type. This needs to be copyable.
+ * @tparam Hash The hash function to use for `Key`.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+   public:
+    /**
+     * Create an empty cache that can hold up to `capacity` entries.
+     */
+    explicit LruCache(size_t capacity) noexcept : capacity_(capacity) {}
+
+    /**
+     * Look up the value for a key, and mark that entry as the most recently
+     * used one.
+     *
+     * @return The cached value, or a `std::nullopt` if the key is not in the
+     *   cache.
+     */
+    std::optional<Value> get(const Key& key) {
+        const auto it = index_.find(key);
+        if (it == index_.end()) {
+            return std::nullopt;
+        }
+
+        entries_.splice(entries_.begin(), entries_, it->second);
+
+        return it->second->second;
+    }
+
+    /**
+     * Insert or update an entry, evicting the least recently used entry if the
+     * cache is full.
+     */
+    void put(Key key, Value value) {
+        if (const auto it = index_.find(key); it != index_.end()) {
+            it->second->second = std::move(value);
+            entries_.splice(entries_.begin(), entries_, it->second);
+
+            return;
+        }
+
+        if (entries_.size() >= capacity_ && !entries_.empty()) {
+            index_.erase(entries_.back().first);
+            entries_.pop_back();
+        }
+
+        entries_.emplace_front(std::move(key), std::move(value));
+        index_.emplace(entries_.front().first, entries_.begin());
+    }
+
+    /**
+     * Remove all entries from the cache.
+     */
+    void clear() noexcept {
+        index_.clear();
+        entries_.clear();
+    }
+
+    size_t size() const noexcept { return entries_.size(); }
+
+   private:
+    size_t capacity_;
+
+    /**
+     * The entries, ordered from most recently to least recently used.
+     */
+    std::list<std::pair<Key, Value>> entries_;
+    /**
+     * Points to the entries in `entries_` by key. `std::list` iterators stay
+     * valid when other elements are inserted or removed.
+     */
+    std::unordered_map<Key, typename std::list<std::pair<Key, Value>>::iterator,
+                       Hash>
+        index_;
+};
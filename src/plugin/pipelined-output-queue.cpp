@@ -0,0 +1,48 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "pipelined-output-queue.h"
+
+void PipelinedOutputQueue::reset(uint32_t num_channels, uint32_t latency) {
+    latency_ = latency;
+    storage_.assign(num_channels, std::vector<double>(latency, 0.0));
+
+    // The first `latency` samples the host will receive are silent, and the
+    // queue is thus already full
+    read_position_ = 0;
+    write_position_ = 0;
+    size_ = latency;
+}
+
+void PipelinedOutputQueue::commit_write(uint32_t num_samples) noexcept {
+    assert(size_ + num_samples <= latency_);
+    if (latency_ == 0) [[unlikely]] {
+        return;
+    }
+
+    write_position_ = (write_position_ + num_samples) % latency_;
+    size_ += num_samples;
+}
+
+void PipelinedOutputQueue::commit_read(uint32_t num_samples) noexcept {
+    assert(num_samples <= size_);
+    if (latency_ == 0) [[unlikely]] {
+        return;
+    }
+
+    read_position_ = (read_position_ + num_samples) % latency_;
+    size_ -= num_samples;
+}
@@ -0,0 +1,148 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "../common/audio-kernels.h"
+
+/**
+ * Delays a plugin's output audio by a fixed number of samples. This is used for
+ * the pipelined processing mode, where the Wine plugin host processes the
+ * current block of audio while the host is doing other work, and we'll only
+ * collect the results during the next processing cycle. The plugin's outputs
+ * are written to this queue once they arrive, and the host's output buffers
+ * are then filled from the front of the queue. As long as the host never
+ * processes more than `latency` samples at a time, this adds exactly `latency`
+ * samples of latency regardless of how the host splits up its blocks.
+ *
+ * The queue's storage is large enough to store either single or double
+ * precision samples. Samples are always stored in the same format the host
+ * uses, and this format should not change without calling `reset()`.
+ */
+class PipelinedOutputQueue {
+   public:
+    /**
+     * Clear the queue, and resize it to have room for `num_channels` output
+     * channels. The queue will start out with `latency` samples of silence.
+     * This allocates, so it should not be called from the audio thread.
+     */
+    void reset(uint32_t num_channels, uint32_t latency);
+
+    /**
+     * The queue's latency in samples, as set with `reset()`.
+     */
+    inline uint32_t latency() const noexcept { return latency_; }
+
+    /**
+     * Whether a block of `num_samples` samples can be processed through this
+     * queue. This is false when the queue has no latency because the block size
+     * is unknown, or when the host processes more samples at once than the
+     * block size it told us about. In those cases the block should be processed
+     * without pipelining, since it would otherwise overflow the queue.
+     */
+    inline bool can_process(uint32_t num_samples) const noexcept {
+        return latency_ > 0 && num_samples <= latency_;
+    }
+
+    /**
+     * Append `num_samples` samples to an output channel. After doing this for
+     * every channel, `commit_write()` should be called to advance the write
+     * position. The queue should not already be full, and `num_samples` should
+     * have been checked with `can_process()`.
+     */
+    template <typename T>
+    void write(uint32_t channel, const T* samples, uint32_t num_samples) {
+        T* storage = channel_storage<T>(channel);
+        const uint32_t first_part =
+            std::min(num_samples, latency_ - write_position_);
+        std::copy_n(samples, first_part, storage + write_position_);
+        std::copy_n(samples + first_part, num_samples - first_part, storage);
+    }
+
+    /**
+     * The same as `write()`, but appends silence instead.
+     */
+    template <typename T>
+    void write_silence(uint32_t channel, uint32_t num_samples) {
+        T* storage = channel_storage<T>(channel);
+        const uint32_t first_part =
+            std::min(num_samples, latency_ - write_position_);
+        std::fill_n(storage + write_position_, first_part, 0);
+        std::fill_n(storage, num_samples - first_part, 0);
+    }
+
+    /**
+     * Advance the write position after calling `write()` or `write_silence()`
+     * for every channel.
+     */
+    void commit_write(uint32_t num_samples) noexcept;
+
+    /**
+     * Copy the first `num_samples` samples from an output channel to
+     * `destination`. If `replacing` is false, then the samples are added to
+     * the values in `destination` instead, for VST2's `process()` function.
+     * After doing this for every channel, `commit_read()` should be called to
+     * remove those samples from the queue.
+     */
+    template <bool replacing, typename T>
+    void read(uint32_t channel, T* destination, uint32_t num_samples) {
+        const T* storage = channel_storage<T>(channel);
+        const uint32_t first_part =
+            std::min(num_samples, latency_ - read_position_);
+        if constexpr (replacing) {
+            std::copy_n(storage + read_position_, first_part, destination);
+            std::copy_n(storage, num_samples - first_part,
+                        destination + first_part);
+        } else {
+            accumulate_samples(storage + read_position_, first_part,
+                               destination);
+            accumulate_samples(storage, num_samples - first_part,
+                               destination + first_part);
+        }
+    }
+
+    /**
+     * Advance the read position after calling `read()` for every channel.
+     */
+    void commit_read(uint32_t num_samples) noexcept;
+
+   private:
+    template <typename T>
+    T* channel_storage(uint32_t channel) noexcept {
+        assert(channel < storage_.size());
+        return reinterpret_cast<T*>(storage_[channel].data());
+    }
+
+    /**
+     * The ring buffers for each output channel. These are stored as doubles
+     * so they can hold `latency_` samples of either format.
+     */
+    std::vector<std::vector<double>> storage_;
+
+    uint32_t latency_ = 0;
+    uint32_t read_position_ = 0;
+    uint32_t write_position_ = 0;
+    /**
+     * The number of samples currently in the queue. This is used to check that
+     * the host never processes more than `latency_` samples at once.
+     */
+    uint32_t size_ = 0;
+};
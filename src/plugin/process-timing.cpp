@@ -0,0 +1,294 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "process-timing.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <iomanip>
+#include <sstream>
+
+#include "../common/communication/common.h"
+
+using namespace std::literals::chrono_literals;
+
+/**
+ * How often `ProcessTimingReporter` prints its summaries.
+ */
+constexpr std::chrono::seconds report_interval = 10s;
+
+/**
+ * How often `ProcessTimingReporter` prints the late processing cycles.
+ */
+constexpr std::chrono::seconds late_cycle_report_interval = 1s;
+
+/**
+ * The number of late processing cycles that can be queued up for an instance
+ * in between two reports. Any cycles after that will only be counted.
+ */
+constexpr size_t late_cycle_queue_size = 64;
+
+/**
+ * The maximum number of late processing cycles we'll print per instance per
+ * `late_cycle_report_interval`.
+ */
+constexpr size_t max_reported_late_cycles = 4;
+
+ProcessTimings::ProcessTimings(std::string name, bool record_histograms)
+    : name(std::move(name)),
+      record_histograms(record_histograms),
+      late_cycles(late_cycle_queue_size) {}
+
+ScopedProcessTiming::ScopedProcessTiming(ProcessTimings* timings,
+                                         uint32_t sample_frames) noexcept
+    : timings_(timings), sample_frames_(sample_frames) {
+    if (timings_) {
+        start_ = std::chrono::steady_clock::now();
+        round_trip_start_ = start_;
+        round_trip_end_ = start_;
+    }
+}
+
+ScopedProcessTiming::~ScopedProcessTiming() noexcept {
+    if (!timings_) {
+        return;
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+    const auto total = end - start_;
+    const auto round_trip = round_trip_end_ - round_trip_start_;
+
+    if (timings_->record_histograms) [[unlikely]] {
+        timings_->round_trip.record(round_trip);
+        timings_->native.record(total - round_trip);
+
+        if (plugin_time_ns_) {
+            const std::chrono::nanoseconds plugin_time(*plugin_time_ns_);
+
+            // The plugin's processing time is measured on a different
+            // thread, so we'll clamp this to avoid negative durations
+            timings_->plugin.record(plugin_time);
+            timings_->bridging.record(
+                std::max<std::chrono::steady_clock::duration>(
+                    round_trip - plugin_time,
+                    std::chrono::steady_clock::duration::zero()));
+        }
+    }
+
+    // The sample rate is only known after the host has configured the plugin,
+    // and offline rendering doesn't have any deadlines to miss
+    const double sample_rate =
+        timings_->sample_rate.load(std::memory_order_relaxed);
+    if (offline_ || sample_rate <= 0.0 || sample_frames_ == 0) {
+        return;
+    }
+
+    const std::chrono::nanoseconds deadline(static_cast<int64_t>(
+        (static_cast<double>(sample_frames_) * 1e9) / sample_rate));
+    if (total > deadline) [[unlikely]] {
+        const LateProcessCycle cycle{
+            .sample_frames = sample_frames_,
+            .deadline = deadline,
+            .total = total,
+            .preparation = round_trip_start_ - start_,
+            .round_trip = round_trip,
+            .plugin = plugin_time_ns_
+                          ? std::optional(
+                                std::chrono::nanoseconds(*plugin_time_ns_))
+                          : std::nullopt,
+            .write_back = end - round_trip_end_};
+        if (!timings_->late_cycles.try_push(cycle)) {
+            timings_->dropped_late_cycles.fetch_add(1,
+                                                    std::memory_order_relaxed);
+        }
+    }
+}
+
+ProcessTimingReporter::ProcessTimingReporter(Logger& logger)
+    : logger_(logger), reporter_handler_([&](std::stop_token st) {
+          pthread_setname_np(pthread_self(), "timing");
+
+          std::mutex mutex;
+          std::condition_variable_any cv;
+          std::unique_lock lock(mutex);
+          auto next_report = std::chrono::steady_clock::now() + report_interval;
+          while (!cv.wait_for(lock, st, late_cycle_report_interval,
+                              []() { return false; })) {
+              if (st.stop_requested()) {
+                  break;
+              }
+
+              report_late_cycles();
+
+              if (logger_.process_timing_ &&
+                  std::chrono::steady_clock::now() >= next_report) {
+                  report();
+                  next_report += report_interval;
+              }
+          }
+      }) {}
+
+std::shared_ptr<ProcessTimings> ProcessTimingReporter::add_instance(
+    std::string name) {
+    auto timings = std::make_shared<ProcessTimings>(std::move(name),
+                                                    logger_.process_timing_);
+
+    std::lock_guard lock(instances_mutex_);
+    instances_.push_back(timings);
+
+    return timings;
+}
+
+void ProcessTimingReporter::report_late_cycles() {
+    const auto format_milliseconds = [](std::chrono::nanoseconds duration) {
+        std::ostringstream formatted;
+        formatted << std::fixed << std::setprecision(2)
+                  << (static_cast<double>(duration.count()) / 1000000.0)
+                  << " ms";
+
+        return formatted.str();
+    };
+
+    std::lock_guard lock(instances_mutex_);
+    for (const auto& weak_timings : instances_) {
+        const std::shared_ptr<ProcessTimings> timings = weak_timings.lock();
+        if (!timings) {
+            continue;
+        }
+
+        size_t num_reported = 0;
+        uint64_t num_skipped = timings->dropped_late_cycles.exchange(
+            0, std::memory_order_relaxed);
+        LateProcessCycle cycle;
+        while (timings->late_cycles.try_pop(cycle)) {
+            if (num_reported >= max_reported_late_cycles) {
+                num_skipped++;
+                continue;
+            }
+
+            // If the plugin's own processing function already exceeded the
+            // deadline then there's nothing yabridge could have done about
+            // it, otherwise the bridging overhead pushed the cycle over the
+            // edge
+            std::string message =
+                "[xrun] " + timings->name + ": processing " +
+                std::to_string(cycle.sample_frames) + " samples took " +
+                format_milliseconds(cycle.total) + " with a deadline of " +
+                format_milliseconds(cycle.deadline) + " (preparing " +
+                format_milliseconds(cycle.preparation);
+            if (cycle.plugin) {
+                message +=
+                    ", bridging " +
+                    format_milliseconds(std::max(
+                        cycle.round_trip - *cycle.plugin,
+                        std::chrono::nanoseconds::zero())) +
+                    ", plugin " + format_milliseconds(*cycle.plugin) +
+                    ", write-back " + format_milliseconds(cycle.write_back) +
+                    "), " +
+                    (*cycle.plugin >= cycle.deadline
+                         ? "the plugin itself was too slow"
+                         : "caused by bridging overhead");
+            } else {
+                message += ", round trip " +
+                           format_milliseconds(cycle.round_trip) +
+                           ", write-back " +
+                           format_milliseconds(cycle.write_back) + ")";
+            }
+
+            logger_.log(message);
+            num_reported++;
+        }
+
+        if (num_skipped > 0) {
+            logger_.log("[xrun] " + timings->name + ": " +
+                        std::to_string(num_skipped) +
+                        " more late processing cycles were not shown");
+        }
+    }
+}
+
+void ProcessTimingReporter::report() {
+    const auto format_microseconds = [](std::chrono::nanoseconds duration) {
+        std::ostringstream formatted;
+        formatted << std::fixed << std::setprecision(1)
+                  << (static_cast<double>(duration.count()) / 1000.0);
+
+        return formatted.str();
+    };
+    const auto format_summary = [&](const LatencyHistogram::Summary& summary) {
+        return format_microseconds(summary.p50) + "/" +
+               format_microseconds(summary.p90) + "/" +
+               format_microseconds(summary.p99) + "/" +
+               format_microseconds(summary.max) + " us";
+    };
+
+    std::lock_guard lock(instances_mutex_);
+    std::erase_if(instances_, [](const auto& timings) {
+        return timings.expired();
+    });
+
+    for (const auto& weak_timings : instances_) {
+        const std::shared_ptr<ProcessTimings> timings = weak_timings.lock();
+        if (!timings) {
+            continue;
+        }
+
+        const LatencyHistogram::Summary round_trip =
+            timings->round_trip.summarize_and_reset();
+        const LatencyHistogram::Summary native =
+            timings->native.summarize_and_reset();
+        const LatencyHistogram::Summary plugin =
+            timings->plugin.summarize_and_reset();
+        const LatencyHistogram::Summary bridging =
+            timings->bridging.summarize_and_reset();
+        if (round_trip.count == 0) {
+            continue;
+        }
+
+        std::string message = "[timing] " + timings->name + ": " +
+                              std::to_string(round_trip.count) +
+                              " cycles, p50/p90/p99/max round trip " +
+                              format_summary(round_trip) + ", native " +
+                              format_summary(native);
+        if (plugin.count > 0) {
+            message += ", plugin " + format_summary(plugin) + ", bridging " +
+                       format_summary(bridging);
+        }
+
+        logger_.log(message);
+    }
+
+    // The secondary socket pool is shared by every socket handler in this
+    // process, so these are running totals rather than per instance numbers
+    const uint64_t reused_connections =
+        adhoc_socket_pool_stats.reused_connections.load(
+            std::memory_order_relaxed);
+    const uint64_t new_connections =
+        adhoc_socket_pool_stats.new_connections.load(std::memory_order_relaxed);
+    const uint64_t discarded_connections =
+        adhoc_socket_pool_stats.discarded_connections.load(
+            std::memory_order_relaxed);
+    if (reused_connections + new_connections !=
+        last_reported_secondary_requests_) {
+        last_reported_secondary_requests_ =
+            reused_connections + new_connections;
+
+        logger_.log("[timing] secondary sockets: " +
+                    std::to_string(reused_connections) + " reused, " +
+                    std::to_string(new_connections) + " new connections (" +
+                    std::to_string(discarded_connections) + " discarded)");
+    }
+}
@@ -0,0 +1,268 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <rigtorp/MPMCQueue.h>
+
+#include "../common/latency-histogram.h"
+#include "../common/logging/common.h"
+#include "../common/probes.h"
+
+/**
+ * A processing cycle that took longer than the buffer period, as detected by
+ * `ScopedProcessTiming`. The durations break the cycle down into the same parts
+ * as the timing summaries so that the reporter can tell whether the deadline
+ * was missed because of the bridging or because the plugin itself took too
+ * long.
+ */
+struct LateProcessCycle {
+    /**
+     * The number of samples processed during this cycle.
+     */
+    uint32_t sample_frames;
+    /**
+     * The buffer period, or `sample_frames / sample_rate`.
+     */
+    std::chrono::nanoseconds deadline;
+    /**
+     * The time spent in the processing function as a whole.
+     */
+    std::chrono::nanoseconds total;
+    /**
+     * The time spent preparing the request and writing the inputs to the
+     * shared memory buffers before sending the request.
+     */
+    std::chrono::nanoseconds preparation;
+    /**
+     * The time between sending the request and receiving the response.
+     */
+    std::chrono::nanoseconds round_trip;
+    /**
+     * The part of the round trip spent inside of the Windows plugin's
+     * processing function, if the Wine plugin host measured it.
+     */
+    std::optional<std::chrono::nanoseconds> plugin;
+    /**
+     * The time spent writing the response's outputs back to the host's buffers
+     * after receiving the response.
+     */
+    std::chrono::nanoseconds write_back;
+};
+
+/**
+ * Timing statistics for a single plugin instance's audio processing.
+ *
+ * @see ProcessTimingReporter
+ */
+struct ProcessTimings {
+    /**
+     * @param name A name to identify the plugin instance by in the log.
+     * @param record_histograms Whether to record the histograms below. This is
+     *   only needed when `YABRIDGE_DEBUG_LEVEL` contains `+timing`. Late
+     *   processing cycles are always recorded.
+     */
+    ProcessTimings(std::string name, bool record_histograms);
+
+    /**
+     * A name to identify the plugin instance by in the summaries.
+     */
+    const std::string name;
+
+    /**
+     * Whether the histograms below should be populated.
+     */
+    const bool record_histograms;
+
+    /**
+     * The sample rate the host last configured the plugin with, or 0 if it has
+     * not done so yet. This is set from `effSetSampleRate()`,
+     * `IAudioProcessor::setupProcessing()`, or `clap_plugin::activate()` and it
+     * is used to compute the deadline for every processing cycle.
+     */
+    std::atomic<double> sample_rate = 0.0;
+
+    /**
+     * Processing cycles that took longer than their deadline. These are pushed
+     * from the audio thread without allocating or locking, and they are
+     * printed by `ProcessTimingReporter` from its own thread. This queue is
+     * bounded, so when the reporter can't keep up we'll only count the cycles
+     * that did not fit in `dropped_late_cycles`.
+     */
+    rigtorp::MPMCQueue<LateProcessCycle> late_cycles;
+    /**
+     * The number of late cycles that did not fit in `late_cycles` since the
+     * last report.
+     */
+    std::atomic<uint64_t> dropped_late_cycles = 0;
+
+    /**
+     * The time between sending the processing request to the Wine plugin host
+     * and receiving its response. This includes serializing and deserializing
+     * the request and the response, and the time spent in the plugin itself.
+     */
+    LatencyHistogram round_trip;
+    /**
+     * The time spent in the processing function on the native side outside of
+     * that round trip. This is mostly spent copying audio to and from the
+     * shared memory buffers and preparing the request.
+     */
+    LatencyHistogram native;
+    /**
+     * The time spent in the Windows plugin's processing function, as measured
+     * by the Wine plugin host and sent back as part of the response.
+     */
+    LatencyHistogram plugin;
+    /**
+     * The part of the round trip that was not spent inside of the Windows
+     * plugin. This is the overhead from the bridging itself: serialization,
+     * context switches, and copying audio on the Wine side.
+     */
+    LatencyHistogram bridging;
+};
+
+/**
+ * Measures a single processing cycle and records the results in a
+ * `ProcessTimings` object when it goes out of scope. When `timings` is a null
+ * pointer, this doesn't do anything. `start_round_trip()` should be called
+ * right before sending the request to the Wine plugin host, and
+ * `end_round_trip()` should be called right after receiving the response.
+ *
+ * If the cycle took longer than `sample_frames` samples at the instance's
+ * current sample rate, then the cycle's breakdown is pushed to
+ * `ProcessTimings::late_cycles`. This check is always performed since it only
+ * costs a couple of clock reads per cycle.
+ */
+class ScopedProcessTiming {
+   public:
+    ScopedProcessTiming(ProcessTimings* timings,
+                        uint32_t sample_frames) noexcept;
+    ~ScopedProcessTiming() noexcept;
+
+    ScopedProcessTiming(const ScopedProcessTiming&) = delete;
+    ScopedProcessTiming& operator=(const ScopedProcessTiming&) = delete;
+
+    inline void start_round_trip() noexcept {
+        YABRIDGE_PROBE(process_request_send, sample_frames_);
+        if (timings_) {
+            round_trip_start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    inline void end_round_trip() noexcept {
+        YABRIDGE_PROBE(process_response_receive, sample_frames_);
+        if (timings_) {
+            round_trip_end_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    /**
+     * Set the time the Windows plugin spent processing audio, as reported by
+     * the Wine plugin host in its response. This should be called after
+     * `end_round_trip()`. When this is not set, only the round trip and native
+     * timings are recorded.
+     */
+    inline void set_plugin_time(
+        std::optional<uint64_t> plugin_time_ns) noexcept {
+        plugin_time_ns_ = plugin_time_ns;
+    }
+
+    /**
+     * Set whether the plugin was rendering offline during this cycle, as
+     * reported through `AudioShmBuffer::offline_processing()`. There are no
+     * real time deadlines when rendering offline, so we won't check for late
+     * cycles then.
+     */
+    inline void set_offline_processing(bool offline) noexcept {
+        offline_ = offline;
+    }
+
+   private:
+    ProcessTimings* timings_;
+    uint32_t sample_frames_;
+    bool offline_ = false;
+
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::time_point round_trip_start_;
+    std::chrono::steady_clock::time_point round_trip_end_;
+    std::optional<uint64_t> plugin_time_ns_;
+};
+
+/**
+ * Prints every late processing cycle recorded in the `ProcessTimings` for this
+ * bridge's plugin instances to the log, and when `YABRIDGE_DEBUG_LEVEL`
+ * contains `+timing` it also periodically prints a summary of those timings.
+ * Everything is printed from a separate thread so the audio thread never has
+ * to allocate or write to the log.
+ */
+class ProcessTimingReporter {
+   public:
+    /**
+     * Start the reporting thread.
+     */
+    ProcessTimingReporter(Logger& logger);
+
+    /**
+     * Create a new `ProcessTimings` object for a plugin instance. The instance
+     * should keep this object alive for as long as it exists. We only keep a
+     * weak reference to it here, so we'll stop reporting the instance's timings
+     * once it gets dropped.
+     */
+    std::shared_ptr<ProcessTimings> add_instance(std::string name);
+
+   private:
+    /**
+     * Print the late processing cycles recorded for all instances since the
+     * last call. To avoid flooding the log when the system is overloaded, we'll
+     * only print the first couple of cycles per instance and then mention how
+     * many others there were.
+     */
+    void report_late_cycles();
+
+    /**
+     * Print the summaries for all instances that processed audio since the last
+     * report.
+     */
+    void report();
+
+    Logger& logger_;
+
+    std::mutex instances_mutex_;
+    std::vector<std::weak_ptr<ProcessTimings>> instances_;
+
+    /**
+     * The number of requests sent over secondary sockets at the time of the
+     * last report. We'll only report the `adhoc_socket_pool_stats` when this
+     * changes.
+     */
+    uint64_t last_reported_secondary_requests_ = 0;
+
+    /**
+     * The thread that calls `report_late_cycles()` every second, and `report()`
+     * every ten seconds if `+timing` is enabled. This is defined last so it
+     * gets stopped before the other fields get dropped.
+     */
+    std::jthread reporter_handler_;
+};
@@ -0,0 +1,56 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "stats-server.h"
+
+#include <asio/write.hpp>
+
+StatsServer::StatsServer(
+    std::shared_ptr<BridgeStats> stats,
+    std::vector<std::pair<std::string_view, std::string>> plugin_info)
+    : stats_(std::move(stats)),
+      plugin_info_(std::move(plugin_info)),
+      acceptor_(io_context_,
+                (stats_->base_dir / stats_socket_name).string()) {
+    accept_connections();
+
+    server_thread_ = std::jthread([&]() {
+        pthread_setname_np(pthread_self(), "stats-server");
+
+        io_context_.run();
+    });
+}
+
+StatsServer::~StatsServer() noexcept {
+    io_context_.stop();
+}
+
+void StatsServer::accept_connections() {
+    acceptor_.async_accept([&](const std::error_code& error,
+                               asio::local::stream_protocol::socket socket) {
+        if (error) {
+            return;
+        }
+
+        // The snapshot is tiny, so we'll just write it synchronously. The
+        // connection gets closed when the socket goes out of scope.
+        const std::string snapshot = stats_->to_json(plugin_info_);
+        std::error_code write_error;
+        asio::write(socket, asio::buffer(snapshot), write_error);
+
+        accept_connections();
+    });
+}
@@ -0,0 +1,77 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <asio/io_context.hpp>
+#include <asio/local/stream_protocol.hpp>
+
+#include "../common/communication/stats.h"
+
+/**
+ * Serves the live statistics collected for a bridge in `BridgeStats` over a
+ * Unix domain socket at `<base_dir>/stats.sock`. Every connection receives a
+ * single JSON snapshot, after which the connection is closed. This is used by
+ * `yabridgectl stats` to aggregate the statistics for all running plugin
+ * instances. The socket gets removed together with the rest of the socket base
+ * directory when the bridge shuts down.
+ */
+class StatsServer {
+   public:
+    /**
+     * Start listening on the statistics socket on a new thread.
+     *
+     * @param stats The statistics for the bridge's sockets.
+     * @param plugin_info Additional fields to identify the plugin by in the
+     *   snapshot, see `BridgeStats::to_json()`.
+     *
+     * @throw std::system_error If the socket could not be created.
+     */
+    StatsServer(
+        std::shared_ptr<BridgeStats> stats,
+        std::vector<std::pair<std::string_view, std::string>> plugin_info);
+
+    ~StatsServer() noexcept;
+
+    StatsServer(const StatsServer&) = delete;
+    StatsServer& operator=(const StatsServer&) = delete;
+
+   private:
+    /**
+     * Asynchronously accept a connection, write the snapshot, and then wait
+     * for the next connection.
+     */
+    void accept_connections();
+
+    std::shared_ptr<BridgeStats> stats_;
+    const std::vector<std::pair<std::string_view, std::string>> plugin_info_;
+
+    asio::io_context io_context_;
+    asio::local::stream_protocol::acceptor acceptor_;
+
+    /**
+     * This needs to be the last field so it's started after everything else
+     * has been initialized.
+     */
+    std::jthread server_thread_;
+};
@@ -16,6 +16,7 @@
 
 #include "utils.h"
 
+#include <poll.h>
 #include <unistd.h>
 #include <sstream>
 
@@ -319,6 +320,15 @@ bool equals_case_insensitive(const std::string& a, const std::string& b) {
                       });
 }
 
+bool is_socket_peer_closed(int socket_fd) noexcept {
+    pollfd poll_fd{.fd = socket_fd, .events = POLLRDHUP, .revents = 0};
+    if (poll(&poll_fd, 1, 0) == -1) {
+        return false;
+    }
+
+    return poll_fd.revents & (POLLRDHUP | POLLHUP | POLLERR | POLLNVAL);
+}
+
 std::string join_quoted_strings(std::vector<std::string>& strings) {
     bool is_first = true;
     std::ostringstream joined_strings{};
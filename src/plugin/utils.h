@@ -160,6 +160,16 @@ struct PluginInfo {
  */
 bool equals_case_insensitive(const std::string& a, const std::string& b);
 
+/**
+ * Check whether the other end of a connected Unix domain socket has been
+ * closed, without blocking and without consuming any data. This is used to
+ * detect Wine plugin host crashes while we're waiting on the Wine plugin host
+ * through something other than a socket, like a futex.
+ *
+ * @param socket_fd The socket's file descriptor.
+ */
+bool is_socket_peer_closed(int socket_fd) noexcept;
+
 /**
  * Join a vector of strings with commas while wrapping the strings in quotes.
  * For example, `join_quoted_strings(std::vector<string>{"string", "another
@@ -24,6 +24,8 @@
 // Generated inside of the build directory
 #include <version.h>
 
+#include "../../common/probes.h"
+
 namespace fs = ghc::filesystem;
 
 ClapPluginExtensions::ClapPluginExtensions(const clap_plugin& plugin) noexcept
@@ -685,6 +687,40 @@ void ClapBridge::run() {
                         .result = std::nullopt};
                 }
             },
+            [&](const clap::ext::params::plugin::GetAllInfo& request)
+                -> clap::ext::params::plugin::GetAllInfo::Response {
+                const auto& [instance, _] = get_instance(request.instance_id);
+
+                // Same as the above, these are all simple lookups
+                const clap_plugin_params_t& params =
+                    *instance.extensions.params;
+                const uint32_t num_params = params.count(instance.plugin.get());
+
+                clap::ext::params::plugin::GetAllInfoResponse response{};
+                response.infos.reserve(num_params);
+                response.values.reserve(num_params);
+                for (uint32_t param_index = 0; param_index < num_params;
+                     param_index++) {
+                    clap_param_info_t param_info{};
+                    if (!params.get_info(instance.plugin.get(), param_index,
+                                         &param_info)) {
+                        response.infos.push_back({.result = std::nullopt});
+                        response.values.push_back({.result = std::nullopt});
+                        continue;
+                    }
+
+                    double value;
+                    response.infos.push_back({.result = param_info});
+                    if (params.get_value(instance.plugin.get(), param_info.id,
+                                         &value)) {
+                        response.values.push_back({.result = value});
+                    } else {
+                        response.values.push_back({.result = std::nullopt});
+                    }
+                }
+
+                return response;
+            },
             [&](const clap::ext::params::plugin::ValueToText& request)
                 -> clap::ext::params::plugin::ValueToText::Response {
                 const auto& [instance, _] = get_instance(request.instance_id);
@@ -916,6 +952,12 @@ std::optional<AudioShmBuffer::Config> ClapBridge::setup_shared_audio_buffers(
         .output_offsets = std::move(output_bus_offsets)};
     if (!instance.process_buffers) {
         instance.process_buffers.emplace(buffer_config);
+
+        // Messages sent over this instance's audio socket can be passed
+        // through the shared memory object's control block from now on. This
+        // needs to happen before the native plugin does the same thing.
+        sockets_.set_audio_thread_shm_buffer(instance_id,
+                                             &*instance.process_buffers);
     } else {
         instance.process_buffers->resize(buffer_config);
     }
@@ -1040,11 +1082,26 @@ void ClapBridge::register_plugin_instance(
                     const auto& [instance, _] =
                         get_instance(request.instance_id);
 
+                    // While rendering offline both sides will briefly spin
+                    // before blocking while waiting for the next request or
+                    // response
+                    instance.process_buffers->set_offline_processing(
+                        instance.render_mode == CLAP_RENDER_OFFLINE);
+
                     // Most plugins will already enable FTZ, but there are a
                     // handful of plugins that don't that suffer from extreme
                     // DSP load increases when they start producing denormals
                     ScopedFlushToZero ftz_guard;
 
+                    // If the host passed the same buffer for multiple channels,
+                    // then the plugin should also see the same buffer for
+                    // those channels
+                    const ScopedAudioChannelAliases channel_aliases_guard(
+                        request.process.channel_aliases_,
+                        *instance.process_buffers,
+                        instance.process_buffers_input_pointers,
+                        instance.process_buffers_output_pointers);
+
                     // The actual audio is stored in the shared memory
                     // buffers, so the reconstruction function will need to
                     // know where it should point the `AudioBusBuffers` to
@@ -1057,6 +1114,12 @@ void ClapBridge::register_plugin_instance(
                     auto& reconstructed = request.process.reconstruct(
                         instance.process_buffers_input_pointers,
                         instance.process_buffers_output_pointers);
+                    const std::chrono::steady_clock::time_point process_start =
+                        request.measure_plugin_time
+                            ? std::chrono::steady_clock::now()
+                            : std::chrono::steady_clock::time_point{};
+                    YABRIDGE_PROBE(plugin_process_start,
+                                   reconstructed.frames_count);
                     if (instance.render_mode == CLAP_RENDER_OFFLINE) {
                         result =
                             main_context_
@@ -1070,10 +1133,31 @@ void ClapBridge::register_plugin_instance(
                         result = instance.plugin->process(instance.plugin.get(),
                                                           &reconstructed);
                     }
+                    YABRIDGE_PROBE(plugin_process_end,
+                                   reconstructed.frames_count);
+
+                    // When process timing is enabled on the native plugin side,
+                    // we'll report how much of the round trip was spent inside
+                    // of the plugin
+                    std::optional<uint64_t> plugin_time_ns;
+                    if (request.measure_plugin_time) {
+                        plugin_time_ns = static_cast<uint64_t>(
+                            std::chrono::duration_cast<
+                                std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now() -
+                                process_start)
+                                .count());
+                    }
+
+                    // The native plugin can skip copying outputs that are
+                    // silent
+                    request.process.update_silent_outputs(
+                        *instance.process_buffers);
 
                     return clap::plugin::ProcessResponse{
                         .result = result,
-                        .output_data = request.process.create_response()};
+                        .output_data = request.process.create_response(),
+                        .plugin_time_ns = plugin_time_ns};
                 },
                 [&](clap::ext::params::plugin::Flush& request)
                     -> clap::ext::params::plugin::Flush::Response {
@@ -95,6 +95,7 @@ void HostBridge::shutdown_if_dangling() {
         //        Check this commit for another now-unnecessary change we
         //        reverted here.
         // close_sockets();
+        Logger::flush_all();
         TerminateProcess(GetCurrentProcess(), 0);
     }
 }
@@ -23,6 +23,7 @@
 #include <version.h>
 
 #include "../../common/communication/vst2.h"
+#include "../../common/probes.h"
 
 /**
  * A function pointer to what should be the entry point of a VST plugin.
@@ -228,6 +229,19 @@ Vst2Bridge::Vst2Bridge(MainContext& main_context,
     // Allow this plugin to configure the main context's tick rate
     main_context.update_timer_interval(config_.event_loop_interval());
 
+    // The native plugin will use this table to answer `getParameter()` calls
+    // without having to go through us. Since `plugin_->numParams` can change
+    // later, parameters past the end of this table will just never be cached.
+    if (config_.vst2_parameter_cache) {
+        const ParameterShmTable::Config parameter_table_config{
+            .name = sockets_.base_dir_.filename().string() + "-parameters",
+            .num_parameters =
+                static_cast<uint32_t>(std::max(plugin_->numParams, 0))};
+        parameter_table_.emplace(parameter_table_config);
+
+        sockets_.host_plugin_control_.send(parameter_table_config);
+    }
+
     parameters_handler_ = Win32Thread([&]() {
         set_realtime_priority(true);
         pthread_setname_np(pthread_self(), "parameters");
@@ -243,11 +257,35 @@ Vst2Bridge::Vst2Bridge(MainContext& main_context,
                     plugin_->setParameter(plugin_, request.index,
                                           *request.value);
 
-                    ParameterResult response{std::nullopt};
-                    sockets_.host_plugin_parameters_.send(response, buffer);
+                    // With the parameter cache enabled the native plugin
+                    // doesn't wait for a response. Instead we'll store the
+                    // value the plugin actually ended up using (which may have
+                    // been quantized), and we'll let the audio thread know that
+                    // this change has been applied.
+                    if (parameter_table_) {
+                        const uint32_t generation =
+                            parameter_table_->generation();
+                        parameter_table_->store(
+                            request.index,
+                            plugin_->getParameter(plugin_, request.index),
+                            generation);
+                        parameter_table_->confirm_set();
+                    } else {
+                        ParameterResult response{std::nullopt};
+                        sockets_.host_plugin_parameters_.send(response, buffer);
+                    }
                 } else {
                     // `getParameter`
+                    // NOTE: The generation needs to be fetched before asking
+                    //       the plugin for the value so a value from before an
+                    //       invalidation can never end up in the table
+                    const uint32_t generation =
+                        parameter_table_ ? parameter_table_->generation() : 0;
                     float value = plugin_->getParameter(plugin_, request.index);
+                    if (parameter_table_) {
+                        parameter_table_->store(request.index, value,
+                                                generation);
+                    }
 
                     ParameterResult response{value};
                     sockets_.host_plugin_parameters_.send(response, buffer);
@@ -267,116 +305,193 @@ Vst2Bridge::Vst2Bridge(MainContext& main_context,
         sockets_.host_plugin_process_replacing_.receive_multi<
             Vst2ProcessRequest>([&](Vst2ProcessRequest& process_request,
                                     SerializationBufferBase& buffer) {
-            // Since the value cannot change during this processing cycle,
-            // we'll send the current transport information as part of the
-            // request so we prefetch it to avoid unnecessary callbacks from
-            // the audio thread
-            std::optional<decltype(time_info_cache_)::Guard>
-                time_info_cache_guard =
-                    process_request.current_time_info
-                        ? std::optional(time_info_cache_.set(
-                              *process_request.current_time_info))
-                        : std::nullopt;
-
-            // We'll also prefetch the process level, since some plugins
-            // will ask for this during every processing cycle
-            decltype(process_level_cache_)::Guard process_level_cache_guard =
-                process_level_cache_.set(process_request.current_process_level);
-
-            // As suggested by Jack Winter, we'll synchronize this thread's
-            // audio processing priority with that of the host's audio
-            // thread every once in a while
-            if (process_request.new_realtime_priority) {
-                set_realtime_priority(true,
-                                      *process_request.new_realtime_priority);
-            }
+            const Vst2ProcessResponse response = process_audio(process_request);
 
-            // Let the plugin process the MIDI events that were received
-            // since the last buffer, and then clean up those events. This
-            // approach should not be needed but Kontakt only stores
-            // pointers to rather than copies of the events.
-            std::lock_guard lock(next_buffer_midi_events_mutex_);
-
-            // As an optimization we no don't pass the input audio along
-            // with `Vst2ProcessRequest`, and instead we'll write it to a
-            // shared memory object on the plugin side. We can then write
-            // the output audio to the same shared memory object. Since the
-            // host should only be calling one of `process()`,
-            // processReplacing()` or `processDoubleReplacing()`, we can all
-            // handle them all at once. We pick which one to call depending
-            // on the type of data we got sent and the plugin's reported
-            // support for these functions.
-            auto do_process = [&]<typename T>(T) {
-                // These were set up after the host called
-                // `effMainsChanged()` with the correct size, so this
-                // reinterpret cast is safe even if the host suddenly starts
-                // sending 32-bit single precision audio after it set up
-                // audio processing for double precision (not that the
-                // Windows VST2 plugin would be able to handle that,
-                // presumably)
-                T** input_channel_pointers = reinterpret_cast<T**>(
-                    process_buffers_input_pointers_.data());
-                T** output_channel_pointers = reinterpret_cast<T**>(
-                    process_buffers_output_pointers_.data());
-
-                if constexpr (std::is_same_v<T, float>) {
-                    // Any plugin made in the last fifteen years or so
-                    // should support `processReplacing`. In the off chance
-                    // it does not we can just emulate this behavior
-                    // ourselves.
-                    if (plugin_->processReplacing) {
-                        plugin_->processReplacing(
-                            plugin_, input_channel_pointers,
-                            output_channel_pointers,
-                            process_request.sample_frames);
-                    } else {
-                        // If we zero out this buffer then the behavior is
-                        // the same as `processReplacing`
-                        for (int channel = 0; channel < plugin_->numOutputs;
-                             channel++) {
-                            std::fill(output_channel_pointers[channel],
-                                      output_channel_pointers[channel] +
-                                          process_request.sample_frames,
-                                      static_cast<T>(0.0));
-                        }
-
-                        plugin_->process(plugin_, input_channel_pointers,
-                                         output_channel_pointers,
-                                         process_request.sample_frames);
-                    }
-                } else if (std::is_same_v<T, double>) {
-                    plugin_->processDoubleReplacing(
-                        plugin_, input_channel_pointers,
-                        output_channel_pointers, process_request.sample_frames);
-                } else {
-                    static_assert(
-                        std::is_same_v<T, float> || std::is_same_v<T, double>,
-                        "Audio processing only works with single and "
-                        "double precision floating point numbers");
-                }
-            };
-
-            assert(process_buffers_);
-            if (process_request.double_precision) {
-                // XXX: Clangd doesn't let you specify template parameters
-                //      for templated lambdas. This argument should get
-                //      optimized out
-                do_process(double());
+            // The output audio has already been written to the shared memory
+            // buffers, so the response only contains the optional timing
+            // information. Like the request this is passed through the shared
+            // memory object's control block.
+            sockets_.host_plugin_process_replacing_.send(response, buffer);
+        });
+    });
+}
+
+Vst2Bridge::~Vst2Bridge() noexcept {
+    // The futex based audio thread, if it is running, would otherwise keep
+    // waiting for new requests indefinitely
+    if (process_buffers_) {
+        process_buffers_->stop_listening();
+        sockets_.host_plugin_process_replacing_.set_shm_buffer(nullptr);
+    }
+}
+
+Vst2ProcessResponse Vst2Bridge::process_audio(
+    Vst2ProcessRequest& process_request) {
+    // Since the value cannot change during this processing cycle, we'll send
+    // the current transport information as part of the request so we prefetch
+    // it to avoid unnecessary callbacks from the audio thread
+    std::optional<decltype(time_info_cache_)::Guard> time_info_cache_guard =
+        process_request.current_time_info
+            ? std::optional(
+                  time_info_cache_.set(*process_request.current_time_info))
+            : std::nullopt;
+
+    // We'll also prefetch the process level, since some plugins will ask for
+    // this during every processing cycle
+    decltype(process_level_cache_)::Guard process_level_cache_guard =
+        process_level_cache_.set(process_request.current_process_level);
+
+    // While rendering offline both sides will briefly spin before blocking
+    // while waiting for the next request or response
+    if (process_buffers_) {
+        process_buffers_->set_offline_processing(
+            process_request.current_process_level == kVstProcessLevelOffline);
+    }
+
+    // As suggested by Jack Winter, we'll synchronize this thread's audio
+    // processing priority with that of the host's audio thread every once in a
+    // while
+    if (process_request.new_realtime_priority) {
+        set_realtime_priority(true, *process_request.new_realtime_priority);
+    }
+
+    // Parameter changes are posted asynchronously when the parameter cache is
+    // enabled, so we'll need to make sure that all changes the host made
+    // before this processing call have been applied
+    if (parameter_table_) {
+        parameter_table_->wait_for_pending_sets();
+    }
+
+    // Let the plugin process the MIDI events that were received since the last
+    // buffer, and then clean up those events. This approach should not be
+    // needed but Kontakt only stores pointers to rather than copies of the
+    // events.
+    std::lock_guard lock(next_buffer_midi_events_mutex_);
+
+    // The native plugin sends the MIDI events from `effProcessEvents()` along
+    // with the processing request. These are handled the same way as in
+    // `Vst2Bridge::run()`, except that we first move all of them into
+    // `next_audio_buffer_midi_events_` so none of the events the plugin
+    // receives get moved around afterwards.
+    if (!process_request.midi_events.empty()) {
+        // See the docstring on `should_clear_midi_events` for why we only
+        // deallocate old MIDI events here instead of a at the end of every
+        // processing cycle
+        if (should_clear_midi_events_) {
+            next_audio_buffer_midi_events_.clear();
+            should_clear_midi_events_ = false;
+        }
+
+        const size_t first_new_events = next_audio_buffer_midi_events_.size();
+        for (auto& events : process_request.midi_events) {
+            next_audio_buffer_midi_events_.push_back(std::move(events));
+        }
+
+        for (size_t i = first_new_events;
+             i < next_audio_buffer_midi_events_.size(); i++) {
+            plugin_->dispatcher(
+                plugin_, effProcessEvents, 0, 0,
+                &next_audio_buffer_midi_events_[i].as_c_events(), 0.0);
+        }
+    }
+
+    Vst2ProcessResponse response{};
+
+    // As an optimization we no don't pass the input audio along with
+    // `Vst2ProcessRequest`, and instead we'll write it to a shared memory
+    // object on the plugin side. We can then write the output audio to the same
+    // shared memory object. Since the host should only be calling one of
+    // `process()`, processReplacing()` or `processDoubleReplacing()`, we can
+    // all handle them all at once. We pick which one to call depending on the
+    // type of data we got sent and the plugin's reported support for these
+    // functions.
+    auto do_process = [&]<typename T>(T) {
+        // These were set up after the host called `effMainsChanged()` with the
+        // correct size, so this reinterpret cast is safe even if the host
+        // suddenly starts sending 32-bit single precision audio after it set up
+        // audio processing for double precision (not that the Windows VST2
+        // plugin would be able to handle that, presumably)
+        T** input_channel_pointers =
+            reinterpret_cast<T**>(process_buffers_input_pointers_.data());
+        T** output_channel_pointers =
+            reinterpret_cast<T**>(process_buffers_output_pointers_.data());
+
+        // When process timing is enabled on the native plugin side, we'll
+        // measure how much time is spent inside of the plugin so the native
+        // plugin can tell that apart from the bridging overhead
+        const std::chrono::steady_clock::time_point process_start =
+            process_request.measure_plugin_time
+                ? std::chrono::steady_clock::now()
+                : std::chrono::steady_clock::time_point{};
+        YABRIDGE_PROBE(plugin_process_start, process_request.sample_frames);
+
+        if constexpr (std::is_same_v<T, float>) {
+            // Any plugin made in the last fifteen years or so should support
+            // `processReplacing`. In the off chance it does not we can just
+            // emulate this behavior ourselves.
+            if (plugin_->processReplacing) {
+                plugin_->processReplacing(plugin_, input_channel_pointers,
+                                          output_channel_pointers,
+                                          process_request.sample_frames);
             } else {
-                do_process(float());
+                // If we zero out this buffer then the behavior is the same as
+                // `processReplacing`
+                for (int channel = 0; channel < plugin_->numOutputs;
+                     channel++) {
+                    std::fill(output_channel_pointers[channel],
+                              output_channel_pointers[channel] +
+                                  process_request.sample_frames,
+                              static_cast<T>(0.0));
+                }
+
+                plugin_->process(plugin_, input_channel_pointers,
+                                 output_channel_pointers,
+                                 process_request.sample_frames);
             }
+        } else if (std::is_same_v<T, double>) {
+            plugin_->processDoubleReplacing(plugin_, input_channel_pointers,
+                                            output_channel_pointers,
+                                            process_request.sample_frames);
+        } else {
+            static_assert(
+                std::is_same_v<T, float> || std::is_same_v<T, double>,
+                "Audio processing only works with single and double precision "
+                "floating point numbers");
+        }
+        YABRIDGE_PROBE(plugin_process_end, process_request.sample_frames);
 
-            // We modified the buffers within the `process_response` object,
-            // so we can just send that object back. Like on the plugin side
-            // we cannot reuse the request object because a plugin may have
-            // a different number of input and output channels
-            sockets_.host_plugin_process_replacing_.send(Ack{}, buffer);
+        if (process_request.measure_plugin_time) {
+            response.plugin_time_ns = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - process_start)
+                    .count());
+        }
 
-            // See the docstrong on `should_clear_midi_events` for why we
-            // don't just clear `next_buffer_midi_events` here
-            should_clear_midi_events_ = true;
-        });
-    });
+        // The native plugin can skip copying outputs that are silent
+        process_buffers_->update_silent_outputs<T>(
+            0, plugin_->numOutputs, process_request.sample_frames);
+    };
+
+    // If the host passed the same buffer for multiple channels, then the plugin
+    // should also see the same buffer for those channels
+    assert(process_buffers_);
+    const ScopedAudioChannelAliases channel_aliases_guard(
+        process_request.channel_aliases, *process_buffers_,
+        process_buffers_input_pointers_, process_buffers_output_pointers_);
+
+    if (process_request.double_precision) {
+        // XXX: Clangd doesn't let you specify template parameters for templated
+        //      lambdas. This argument should get optimized out
+        do_process(double());
+    } else {
+        do_process(float());
+    }
+
+    // See the docstrong on `should_clear_midi_events` for why we don't just
+    // clear `next_buffer_midi_events` here
+    should_clear_midi_events_ = true;
+
+    return response;
 }
 
 #pragma GCC diagnostic pop
@@ -638,13 +753,16 @@ class HostCallbackDataConverter : public DefaultDataConverter {
 
     Vst2EventResult send_event(asio::local::stream_protocol::socket& socket,
                                const Vst2Event& event,
-                               SerializationBufferBase& buffer) const override {
+                               SerializationBufferBase& buffer,
+                               MessageSizes& sizes) const override {
         if (mutually_recursive_callbacks.contains(event.opcode)) {
             return mutual_recursion_.fork([&]() {
-                return DefaultDataConverter::send_event(socket, event, buffer);
+                return DefaultDataConverter::send_event(socket, event, buffer,
+                                                        sizes);
             });
         } else {
-            return DefaultDataConverter::send_event(socket, event, buffer);
+            return DefaultDataConverter::send_event(socket, event, buffer,
+                                                    sizes);
         }
     }
 
@@ -702,6 +820,20 @@ intptr_t Vst2Bridge::host_callback(AEffect* effect,
                 editor_->resize(index, value);
             }
         } break;
+        // The native plugin answers `getParameter()` calls using the values in
+        // `parameter_table_`, so we need to keep that up to date with any
+        // changes the plugin makes on its own
+        case audioMasterAutomate: {
+            if (parameter_table_) {
+                parameter_table_->store(index, option);
+            }
+        } break;
+        case audioMasterIOChanged:
+        case audioMasterUpdateDisplay: {
+            if (parameter_table_) {
+                parameter_table_->invalidate();
+            }
+        } break;
     }
 
     HostCallbackDataConverter converter(effect, last_time_info_,
@@ -784,6 +916,21 @@ intptr_t Vst2Bridge::dispatch_wrapper(AEffect* plugin,
                                       option);
             break;
         }
+        // These can change any number of parameters at once without the plugin
+        // calling `audioMasterAutomate()` for them, so any cached parameter
+        // values will have to be thrown out
+        case effOpen:
+        case effSetProgram:
+        case effEndSetProgram:
+        case effSetChunk: {
+            const intptr_t return_value =
+                plugin->dispatcher(plugin, opcode, index, value, data, option);
+            if (parameter_table_) {
+                parameter_table_->invalidate();
+            }
+
+            return return_value;
+        } break;
         default: {
             return plugin->dispatcher(plugin, opcode, index, value, data,
                                       option);
@@ -832,7 +979,21 @@ AudioShmBuffer::Config Vst2Bridge::setup_shared_audio_buffers() {
         .output_offsets = {std::move(output_channel_offsets)}};
     if (!process_buffers_) {
         process_buffers_.emplace(buffer_config);
+
+        // Processing requests can be passed through the shared memory object's
+        // control block from now on. This needs to happen before the native
+        // plugin attaches its side of the buffers to the socket.
+        sockets_.host_plugin_process_replacing_.set_shm_buffer(
+            &*process_buffers_);
     } else {
+        // The futex based audio thread may still be waiting on the old mapping,
+        // so it needs to be stopped before we can resize the buffers. Moving
+        // the thread out and letting it go out of scope will join it.
+        if (config_.futex_audio_signalling) {
+            process_buffers_->stop_listening();
+            Win32Thread old_handler = std::move(process_futex_handler_);
+        }
+
         process_buffers_->resize(buffer_config);
     }
 
@@ -860,6 +1021,39 @@ AudioShmBuffer::Config Vst2Bridge::setup_shared_audio_buffers() {
         }
     }
 
+    // With `futex_audio_signalling` enabled the native plugin will write its
+    // requests to the control block in `process_buffers_` instead of sending
+    // them over the socket, so we'll need another thread to handle those
+    if (config_.futex_audio_signalling) {
+        // The native plugin may send its first request as soon as it has
+        // received our response to this function call, which can happen before
+        // the new thread gets to run. That's why the last request ID needs to
+        // be read here and not on the new thread, as that thread would
+        // otherwise skip over the first request and wait forever.
+        const uint32_t last_request_id = process_buffers_->last_request_id();
+        process_buffers_->start_listening();
+        process_futex_handler_ = Win32Thread([this, last_request_id]() {
+            set_realtime_priority(true);
+            pthread_setname_np(pthread_self(), "audio-futex");
+
+            ScopedFlushToZero ftz_guard;
+
+            // The response is written back to the control block before waking
+            // up the native plugin. It's tiny, so it will always fit.
+            SerializationBuffer<256> buffer{};
+            Vst2ProcessRequest process_request{};
+            uint32_t request_id = last_request_id;
+            while (process_buffers_->wait_for_request(request_id)) {
+                read_shm_object(*process_buffers_, process_request);
+                const Vst2ProcessResponse response =
+                    process_audio(process_request);
+
+                write_shm_object(*process_buffers_, response, buffer);
+                process_buffers_->signal_response(request_id);
+            }
+        });
+    }
+
     return buffer_config;
 }
 
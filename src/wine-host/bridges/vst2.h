@@ -24,6 +24,7 @@
 #include "../../common/communication/vst2.h"
 #include "../../common/configuration.h"
 #include "../../common/mutual-recursion.h"
+#include "../../common/parameter-shm.h"
 #include "../editor.h"
 #include "common.h"
 
@@ -59,6 +60,11 @@ class Vst2Bridge : public HostBridge {
                std::string endpoint_base_dir,
                pid_t parent_pid);
 
+    /**
+     * Stops the futex based audio thread if it is running.
+     */
+    ~Vst2Bridge() noexcept override;
+
     bool inhibits_event_loop() noexcept override;
 
     /**
@@ -96,6 +102,22 @@ class Vst2Bridge : public HostBridge {
      */
     AudioShmBuffer::Config setup_shared_audio_buffers();
 
+    /**
+     * Process a single block of audio using the plugin's process function. The
+     * audio is read from and written to `process_buffers_`. This is called
+     * from either the socket based audio thread, or from the futex based audio
+     * thread when the `futex_audio_signalling` option is enabled.
+     *
+     * Any MIDI events contained in the request are first passed to the plugin
+     * using `effProcessEvents()`. These are moved out of the request since
+     * some plugins need them to stay alive until the next processing cycle.
+     *
+     * @return The response that should be sent back to the native plugin.
+     *   This contains the time spent in the plugin's processing function when
+     *   `Vst2ProcessRequest::measure_plugin_time` was set.
+     */
+    Vst2ProcessResponse process_audio(Vst2ProcessRequest& process_request);
+
     /**
      * A logger instance we'll use log cached `audioMasterGetTime()` calls, so
      * they can be hidden on verbosity levels below 2.
@@ -139,6 +161,17 @@ class Vst2Bridge : public HostBridge {
      */
     std::vector<void*> process_buffers_output_pointers_;
 
+    /**
+     * A shared memory table containing the last known values for all of the
+     * plugin's parameters. We'll create this right after the plugin has been
+     * initialized, and the native plugin will then use it to answer the host's
+     * `getParameter()` calls without having to ask us. We'll update the values
+     * whenever we handle `getParameter()` or `setParameter()`, and when the
+     * plugin calls `audioMasterAutomate()`. This will be a nullopt unless the
+     * `vst2_parameter_cache` option is enabled.
+     */
+    std::optional<ParameterShmTable> parameter_table_;
+
     /**
      * The maximum number of samples the host will pass to the plugin during
      * `processReplacing()`/`processDoubleReplacing()`/`process()`. This is
@@ -210,6 +243,15 @@ class Vst2Bridge : public HostBridge {
      * fallback) and `processDoubleReplacing`.
      */
     Win32Thread process_replacing_handler_;
+    /**
+     * When the `futex_audio_signalling` option is enabled, this thread will
+     * handle the processing requests written to the control block in
+     * `process_buffers_`. Requests that don't fit in the control block will
+     * still be handled by `process_replacing_handler_`. This thread is
+     * restarted every time the buffers get reconfigured during
+     * `effMainsChanged()`.
+     */
+    Win32Thread process_futex_handler_;
 
     /**
      * All sockets used for communicating with this specific plugin.
@@ -236,7 +278,8 @@ class Vst2Bridge : public HostBridge {
      *
      * Technically a host can send more than one of these at a time, but in
      * practice every host will bundle all events in a single
-     * `effProcessEvents()` call.
+     * `effProcessEvents()` call. These events are normally sent as part of the
+     * audio processing request, see `Vst2ProcessRequest::midi_events`.
      */
     llvm::SmallVector<DynamicVstEvents, 1> next_audio_buffer_midi_events_;
     /**
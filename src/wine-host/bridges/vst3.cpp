@@ -27,6 +27,8 @@
 // Generated inside of the build directory
 #include <version.h>
 
+#include "../../common/probes.h"
+
 // NOLINTNEXTLINE(bugprone-suspicious-include)
 #include <public.sdk/source/vst/hosting/module_win32.cpp>
 
@@ -418,6 +420,26 @@ void Vst3Bridge::run() {
                 return YaEditController::GetParameterInfoResponse{
                     .result = result, .info = std::move(info)};
             },
+            [&](const YaEditController::GetAllParameterInfo& request)
+                -> YaEditController::GetAllParameterInfo::Response {
+                const auto& [instance, _] = get_instance(request.instance_id);
+
+                const int32 num_parameters =
+                    instance.interfaces.edit_controller->getParameterCount();
+
+                YaEditController::GetAllParameterInfoResponse response{};
+                response.parameters.resize(
+                    static_cast<size_t>(std::max(num_parameters, 0)));
+                for (int32 param_index = 0; param_index < num_parameters;
+                     param_index++) {
+                    auto& [result, info] =
+                        response.parameters[static_cast<size_t>(param_index)];
+                    result = instance.interfaces.edit_controller
+                                 ->getParameterInfo(param_index, info);
+                }
+
+                return response;
+            },
             [&](const YaEditController::GetParamStringByValue& request)
                 -> YaEditController::GetParamStringByValue::Response {
                 Steinberg::Vst::String128 string{0};
@@ -1463,6 +1485,12 @@ std::optional<AudioShmBuffer::Config> Vst3Bridge::setup_shared_audio_buffers(
         .output_offsets = std::move(output_bus_offsets_vector)};
     if (!instance.process_buffers) {
         instance.process_buffers.emplace(buffer_config);
+
+        // Messages sent over this instance's audio socket can be passed
+        // through the shared memory object's control block from now on. This
+        // needs to happen before the native plugin does the same thing.
+        sockets_.set_audio_processor_shm_buffer(instance_id,
+                                                &*instance.process_buffers);
     } else {
         instance.process_buffers->resize(buffer_config);
     }
@@ -1649,12 +1677,32 @@ size_t Vst3Bridge::register_object_instance(
 
                         const auto& [instance, _] =
                             get_instance(request.instance_id);
+                        const bool is_offline =
+                            instance.process_setup &&
+                            instance.process_setup->processMode ==
+                                Steinberg::Vst::kOffline;
+
+                        // While rendering offline both sides will briefly spin
+                        // before blocking while waiting for the next request
+                        // or response
+                        instance.process_buffers->set_offline_processing(
+                            is_offline);
+
                         // Most plugins will already enable FTZ, but there are a
                         // handful of plugins that don't that suffer from
                         // extreme DSP load increases when they start producing
                         // denormals
                         ScopedFlushToZero ftz_guard;
 
+                        // If the host passed the same buffer for multiple
+                        // channels, then the plugin should also see the same
+                        // buffer for those channels
+                        const ScopedAudioChannelAliases channel_aliases_guard(
+                            request.data.channel_aliases_,
+                            *instance.process_buffers,
+                            instance.process_buffers_input_pointers,
+                            instance.process_buffers_output_pointers);
+
                         // The actual audio is stored in the shared memory
                         // buffers, so the reconstruction function will need to
                         // know where it should point the `AudioBusBuffers` to
@@ -1666,9 +1714,14 @@ size_t Vst3Bridge::register_object_instance(
                         auto& reconstructed = request.data.reconstruct(
                             instance.process_buffers_input_pointers,
                             instance.process_buffers_output_pointers);
-                        if (instance.process_setup &&
-                            instance.process_setup->processMode ==
-                                Steinberg::Vst::kOffline) {
+                        const std::chrono::steady_clock::time_point
+                            process_start =
+                                request.measure_plugin_time
+                                    ? std::chrono::steady_clock::now()
+                                    : std::chrono::steady_clock::time_point{};
+                        YABRIDGE_PROBE(plugin_process_start,
+                                       reconstructed.numSamples);
+                        if (is_offline) {
                             result = main_context_
                                          .run_in_context([&instance = instance,
                                                           &reconstructed]() {
@@ -1682,10 +1735,31 @@ size_t Vst3Bridge::register_object_instance(
                                 instance.interfaces.audio_processor->process(
                                     reconstructed);
                         }
+                        YABRIDGE_PROBE(plugin_process_end,
+                                       reconstructed.numSamples);
+
+                        // When process timing is enabled on the native plugin
+                        // side, we'll report how much of the round trip was
+                        // spent inside of the plugin
+                        std::optional<uint64_t> plugin_time_ns;
+                        if (request.measure_plugin_time) {
+                            plugin_time_ns = static_cast<uint64_t>(
+                                std::chrono::duration_cast<
+                                    std::chrono::nanoseconds>(
+                                    std::chrono::steady_clock::now() -
+                                    process_start)
+                                    .count());
+                        }
+
+                        // The native plugin can skip copying outputs that are
+                        // silent
+                        request.data.update_silent_outputs(
+                            *instance.process_buffers);
 
                         return YaAudioProcessor::ProcessResponse{
                             .result = result,
-                            .output_data = request.data.create_response()};
+                            .output_data = request.data.create_response(),
+                            .plugin_time_ns = plugin_time_ns};
                     },
                     [&](const YaAudioProcessor::GetTailSamples& request)
                         -> YaAudioProcessor::GetTailSamples::Response {
@@ -120,7 +120,9 @@ int YABRIDGE_EXPORT
         }
 
         // This shouldn't be needed, but sometimes with Wine background threads
-        // will be kept alive while this process exits
+        // will be kept alive while this process exits. This skips all
+        // destructors, so any buffered log messages need to be written first.
+        Logger::flush_all();
         TerminateProcess(GetCurrentProcess(), 0);
     } else {
         const std::string plugin_type_str(argv[1]);
@@ -185,6 +187,7 @@ int YABRIDGE_EXPORT
 
             // See below, just returning from `main()` isn't enough to terminate
             // the process
+            Logger::flush_all();
             TerminateProcess(GetCurrentProcess(), 0);
 
             return 1;
@@ -209,6 +212,7 @@ int YABRIDGE_EXPORT
             //        'fixes' the issue.
             //
             //        https://github.com/robbert-vdh/yabridge/issues/69
+            Logger::flush_all();
             TerminateProcess(GetCurrentProcess(), 0);
         });
 
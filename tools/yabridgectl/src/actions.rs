@@ -34,6 +34,7 @@ use crate::util::{verify_external_dependencies, verify_path_setup, verify_wine_s
 use crate::vst3_moduleinfo::ModuleInfo;
 
 pub mod blacklist;
+pub mod stats;
 
 /// Add a direcotry to the plugin locations. Duplicates get ignord because we're using ordered sets.
 pub fn add_directory(config: &mut Config, path: PathBuf) -> Result<()> {
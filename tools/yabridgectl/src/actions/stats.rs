@@ -0,0 +1,239 @@
+// yabridge: a Wine plugin bridge
+// Copyright (C) 2020-2022 Robbert van der Helm
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+//! Handler for the `yabridgectl stats` subcommand. This collects the live statistics served by every
+//! running yabridge plugin instance that was started with `YABRIDGE_STATS` set. See
+//! `src/common/communication/stats.h` for the other side of this.
+
+use anyhow::{Context, Result};
+use colored::Colorize;
+use serde_derive::Deserialize;
+use std::collections::BTreeMap;
+use std::env;
+use std::fs;
+use std::io::Read;
+use std::os::unix::net::UnixStream;
+use std::path::{Path, PathBuf};
+use std::time::Duration;
+
+/// The name of the statistics socket inside of a bridge's socket directory.
+const STATS_SOCKET_NAME: &str = "stats.sock";
+
+/// A single plugin instance's statistics snapshot.
+#[derive(Deserialize, Debug)]
+struct BridgeStats {
+    pid: u32,
+    plugin: PluginInfo,
+    round_trips: RoundTrips,
+    shared_memory: Vec<SharedMemoryObject>,
+    sockets: Vec<SocketStats>,
+}
+
+#[derive(Deserialize, Debug, Default)]
+#[serde(default)]
+struct PluginInfo {
+    #[serde(rename = "type")]
+    plugin_type: String,
+    native_path: String,
+    windows_path: String,
+}
+
+#[derive(Deserialize, Debug)]
+struct RoundTrips {
+    audio_thread: RoundTripSummary,
+    main_thread: RoundTripSummary,
+}
+
+#[derive(Deserialize, Debug)]
+struct RoundTripSummary {
+    count: u64,
+    p50_us: f64,
+    p99_us: f64,
+    max_us: f64,
+}
+
+#[derive(Deserialize, Debug)]
+struct SharedMemoryObject {
+    bytes: u64,
+}
+
+#[derive(Deserialize, Debug)]
+struct SocketStats {
+    secondary_sockets: u64,
+    requests: Vec<RequestCounters>,
+}
+
+#[derive(Deserialize, Debug, Default, Clone)]
+struct RequestCounters {
+    #[serde(rename = "type")]
+    request_type: String,
+    sent: u64,
+    handled: u64,
+    bytes_sent: u64,
+    bytes_received: u64,
+}
+
+/// Print the statistics for every running yabridge plugin instance, followed by the totals per
+/// request type.
+pub fn show_stats() -> Result<()> {
+    let instances: Vec<BridgeStats> = find_stats_sockets()?
+        .into_iter()
+        // Sockets from plugins that have crashed may still be lying around, so we'll silently skip
+        // anything that doesn't respond
+        .filter_map(|socket_path| read_stats(&socket_path).ok())
+        .collect();
+    if instances.is_empty() {
+        println!(
+            "No running plugin instances found. Statistics are only available for plugins \
+             started with the {} environment variable set.",
+            "YABRIDGE_STATS=1".bright_white()
+        );
+
+        return Ok(());
+    }
+
+    let mut totals: BTreeMap<String, RequestCounters> = BTreeMap::new();
+    for instance in &instances {
+        let plugin_name = if instance.plugin.windows_path.is_empty() {
+            &instance.plugin.native_path
+        } else {
+            &instance.plugin.windows_path
+        };
+        println!(
+            "{} ({}, pid {})",
+            plugin_name.bright_white(),
+            instance.plugin.plugin_type,
+            instance.pid
+        );
+
+        print_round_trips("audio thread", &instance.round_trips.audio_thread);
+        print_round_trips("main thread", &instance.round_trips.main_thread);
+
+        let shm_bytes: u64 = instance.shared_memory.iter().map(|shm| shm.bytes).sum();
+        println!(
+            "  shared memory: {} in {} objects",
+            format_bytes(shm_bytes),
+            instance.shared_memory.len()
+        );
+        let secondary_sockets: u64 = instance
+            .sockets
+            .iter()
+            .map(|socket| socket.secondary_sockets)
+            .sum();
+        println!("  secondary sockets: {}", secondary_sockets);
+
+        let (mut messages, mut bytes) = (0, 0);
+        for counters in instance.sockets.iter().flat_map(|socket| &socket.requests) {
+            messages += counters.sent + counters.handled;
+            bytes += counters.bytes_sent + counters.bytes_received;
+            add_counters(
+                totals.entry(counters.request_type.clone()).or_default(),
+                counters,
+            );
+        }
+        println!("  messages: {} ({} moved)\n", messages, format_bytes(bytes));
+    }
+
+    // The request types are sorted by the total number of messages so the busiest ones are listed
+    // first
+    let mut totals: Vec<RequestCounters> = totals.into_values().collect();
+    totals.sort_by_key(|counters| std::cmp::Reverse(counters.sent + counters.handled));
+
+    println!(
+        "{}",
+        format!("Totals for {} plugin instances:", instances.len()).bright_white()
+    );
+    for counters in totals {
+        println!(
+            "  {}: {} sent, {} handled ({} out, {} in)",
+            counters.request_type,
+            counters.sent,
+            counters.handled,
+            format_bytes(counters.bytes_sent),
+            format_bytes(counters.bytes_received)
+        );
+    }
+
+    Ok(())
+}
+
+/// Find the statistics sockets for all running plugin instances. This uses the same temporary
+/// directory as `get_temporary_directory()` in `src/common/utils.cpp`.
+fn find_stats_sockets() -> Result<Vec<PathBuf>> {
+    let temp_dir = env::var_os("YABRIDGE_TEMP_DIR")
+        .or_else(|| env::var_os("XDG_RUNTIME_DIR"))
+        .map(PathBuf::from)
+        .unwrap_or_else(env::temp_dir);
+
+    let mut sockets: Vec<PathBuf> = fs::read_dir(&temp_dir)
+        .with_context(|| format!("Could not read '{}'", temp_dir.display()))?
+        .filter_map(|entry| entry.ok())
+        .filter(|entry| entry.file_name().to_string_lossy().starts_with("yabridge-"))
+        .map(|entry| entry.path().join(STATS_SOCKET_NAME))
+        .filter(|socket_path| socket_path.exists())
+        .collect();
+    sockets.sort();
+
+    Ok(sockets)
+}
+
+/// Connect to a plugin instance's statistics socket and parse the snapshot it sends back.
+fn read_stats(socket_path: &Path) -> Result<BridgeStats> {
+    let mut stream = UnixStream::connect(socket_path)?;
+    stream.set_read_timeout(Some(Duration::from_secs(1)))?;
+
+    let mut snapshot = String::new();
+    stream.read_to_string(&mut snapshot)?;
+
+    serde_jsonrc::from_str(&snapshot).with_context(|| {
+        format!(
+            "Could not parse the statistics from '{}'",
+            socket_path.display()
+        )
+    })
+}
+
+fn print_round_trips(name: &str, summary: &RoundTripSummary) {
+    if summary.count == 0 {
+        return;
+    }
+
+    println!(
+        "  {}: {} round trips, p50 {:.1} us, p99 {:.1} us, max {:.1} us",
+        name, summary.count, summary.p50_us, summary.p99_us, summary.max_us
+    );
+}
+
+fn add_counters(total: &mut RequestCounters, counters: &RequestCounters) {
+    if total.request_type.is_empty() {
+        total.request_type = counters.request_type.clone();
+    }
+
+    total.sent += counters.sent;
+    total.handled += counters.handled;
+    total.bytes_sent += counters.bytes_sent;
+    total.bytes_received += counters.bytes_received;
+}
+
+fn format_bytes(bytes: u64) -> String {
+    if bytes >= 1 << 20 {
+        format!("{:.1} MiB", bytes as f64 / (1 << 20) as f64)
+    } else if bytes >= 1 << 10 {
+        format!("{:.1} KiB", bytes as f64 / (1 << 10) as f64)
+    } else {
+        format!("{} B", bytes)
+    }
+}
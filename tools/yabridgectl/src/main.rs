@@ -91,6 +91,16 @@ fn main() -> Result<()> {
                 .about("Show the installation status for all plugins")
                 .display_order(4),
         )
+        .subcommand(
+            Command::new("stats")
+                .about("Show live statistics for running plugins")
+                .long_about(
+                    "Show live statistics for running plugins\n\nThis shows message counts, \
+                     round trip times, and shared memory usage for all running plugin instances \
+                     that were started with the 'YABRIDGE_STATS' environment variable set.",
+                )
+                .display_order(5),
+        )
         .subcommand(
             Command::new("sync")
                 .about("Set up or update yabridge for all plugins")
@@ -260,6 +270,7 @@ fn main() -> Result<()> {
         }
         Some(("list", _)) => actions::list_directories(&config),
         Some(("status", _)) => actions::show_status(&config),
+        Some(("stats", _)) => actions::stats::show_stats(),
         Some(("sync", options)) => actions::do_sync(
             &mut config,
             &actions::SyncOptions {